@@ -0,0 +1,24 @@
+#ifndef buffers_h
+#define buffers_h
+
+#include <cstddef>
+#include <vector>
+
+// most buffers a source file keeps per thread
+static const size_t kThreadBuffers = 5;
+
+// Per thread scratch buffer of the pointer overloads, grown as needed, so
+// that repeated calls do not allocate. Owner is a type declared by each
+// source file, which gets buffers of its own: growing one of them never
+// moves a buffer that a caller in another file still holds.
+// index < kThreadBuffers.
+template <typename Owner, typename T = double>
+T *thread_buffer(size_t index, size_t size) {
+  static thread_local std::vector<T> buffers[kThreadBuffers];
+  if (buffers[index].size() < size) {
+    buffers[index].resize(size);
+  }
+  return buffers[index].data();
+}
+
+#endif /* buffers_h */
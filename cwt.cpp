@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "buffers.h"
+#include "cwt.h"
+#include "fft.h"
+#include "threadpool.h"
+
+typedef std::complex<double> Complex;
+
+static const double kPi = 3.14159265358979323846;
+
+enum class CwtWavelet { Morlet, MexicanHat, ComplexGaussian };
+
+// owner of the per thread buffers of this file: 0 for the product spectrum
+// of a task, 1 for its inverse transform, 2 for the padded signal and 3 for
+// its spectrum, which belong to the calling thread
+struct CwtBuffers;
+
+//-------------------------------------------------------------
+/**
+ * Parses the name of a continuous wavelet.
+ *
+ * @param name "morl", "mexh" or "cgau1" to "cgau8".
+ * @param order Set to the derivative order of cgau, 0 otherwise.
+ * @return The wavelet.
+ */
+static CwtWavelet cwt_wavelet(const std::string &name, size_t &order) {
+  order = 0;
+  if (name == "morl") {
+    return CwtWavelet::Morlet;
+  }
+  if (name == "mexh") {
+    return CwtWavelet::MexicanHat;
+  }
+  if (name.size() == 5 && name.compare(0, 4, "cgau") == 0 &&
+      name[4] >= '1' && name[4] <= '8') {
+    order = name[4] - '0';
+    return CwtWavelet::ComplexGaussian;
+  }
+  throw std::runtime_error("Unknown wavelet name!");
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the constant that gives cgau of an order unit energy. The energy
+ * of w^p exp(-(w + 1)^2 / 4) over 2 pi is half of
+ * sqrt(2 pi) E[(Z - 1)^(2p)] for a standard normal Z, and the odd moments of
+ * Z vanish.
+ *
+ * @param order The derivative order.
+ * @return The normalization constant.
+ */
+static double cgau_norm(size_t order) {
+  double moment = 0.0;
+  double binomial = 1.0;
+  double doubleFactorial = 1.0;
+  for (size_t k = 0; k <= 2 * order; ++k) {
+    if (k > 0) {
+      binomial = binomial * (2 * order - k + 1) / k;
+    }
+    if (k % 2 == 0) {
+      if (k > 0) {
+        doubleFactorial *= k - 1;
+      }
+      moment += binomial * doubleFactorial;
+    }
+  }
+  return std::sqrt(2.0 / (std::sqrt(2.0 * kPi) * moment));
+}
+
+//-------------------------------------------------------------
+/**
+ * Evaluates the Fourier transform of a wavelet, without the factor i^order
+ * of cgau, so that the result is real.
+ *
+ * @param type The wavelet.
+ * @param order The derivative order of cgau.
+ * @param norm The normalization constant of cgau.
+ * @param w The angular frequency.
+ * @return The spectrum at w.
+ */
+static double wavelet_spectrum(CwtWavelet type, size_t order, double norm,
+                               double w) {
+  switch (type) {
+  case CwtWavelet::Morlet:
+    return std::sqrt(2.0 * kPi) / 2.0 *
+           (std::exp(-(w - 5.0) * (w - 5.0) / 2.0) +
+            std::exp(-(w + 5.0) * (w + 5.0) / 2.0));
+  case CwtWavelet::MexicanHat:
+    return 2.0 / (std::sqrt(3.0) * std::pow(kPi, 0.25)) *
+           std::sqrt(2.0 * kPi) * w * w * std::exp(-w * w / 2.0);
+  default:
+    return norm * std::sqrt(kPi) * std::pow(w, double(order)) *
+           std::exp(-(w + 1.0) * (w + 1.0) / 4.0);
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Returns the angular frequencies outside of which the spectrum of a wavelet
+ * is below 1e-17 of its peak, the bands the plan keeps.
+ *
+ * @param type The wavelet.
+ * @param low Set to the lower end.
+ * @param high Set to the upper end.
+ */
+static void wavelet_band(CwtWavelet type, double &low, double &high) {
+  switch (type) {
+  case CwtWavelet::Morlet:
+    low = -14.0;
+    high = 14.0;
+    break;
+  case CwtWavelet::MexicanHat:
+    low = -10.0;
+    high = 10.0;
+    break;
+  default:
+    low = -20.0;
+    high = 18.0;
+    break;
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Returns the time beyond which a wavelet is below 1e-17 of its peak, in
+ * units of its scale.
+ *
+ * @param type The wavelet.
+ * @return The radius of its support.
+ */
+static double wavelet_radius(CwtWavelet type) {
+  switch (type) {
+  case CwtWavelet::Morlet:
+    return 9.0;
+  case CwtWavelet::MexicanHat:
+    return 10.0;
+  default:
+    return 8.0;
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the length of the transforms of a plan: the signal padded by the
+ * support of the widest dilated wavelet, beyond which the circular
+ * correlation would wrap around onto the other end of the signal.
+ *
+ * @param signalSize The number of samples of the signals.
+ * @param scales The scales; those that are not positive and finite are left
+ * for the plan to reject.
+ * @param wavelet_name The wavelet name.
+ * @return The transform length.
+ */
+static size_t cwt_fft_size(size_t signalSize,
+                           const std::vector<double> &scales,
+                           const std::string &wavelet_name) {
+  size_t order;
+  const double radius = wavelet_radius(cwt_wavelet(wavelet_name, order));
+  double widest = 0.0;
+  for (double scale : scales) {
+    if (scale > 0.0 && std::isfinite(scale)) {
+      widest = std::max(widest, scale);
+    }
+  }
+  return next_fast_fft_size(signalSize + size_t(std::ceil(radius * widest)));
+}
+
+//-------------------------------------------------------------
+/**
+ * Plans the transform of signals of one length at the given scales.
+ *
+ * @param signalSize The number of samples of the signals.
+ * @param scales The scales, all positive and finite.
+ * @param wavelet_name "morl", "mexh" or "cgau1" to "cgau8".
+ */
+CwtPlan::CwtPlan(size_t signalSize, const std::vector<double> &scales,
+                 const std::string &wavelet_name)
+    : signalSize_(signalSize), scales_(scales),
+      fft_(cwt_fft_size(signalSize, scales, wavelet_name)) {
+  if (signalSize == 0) {
+    throw std::runtime_error("Signal is empty!");
+  }
+  const CwtWavelet type = cwt_wavelet(wavelet_name, order_);
+  real_ = type != CwtWavelet::ComplexGaussian;
+  const double norm = order_ > 0 ? cgau_norm(order_) : 0.0;
+  double low, high;
+  wavelet_band(type, low, high);
+
+  // signed bins -(M - 1) / 2 .. M / 2 at 2 pi k / M
+  const std::ptrdiff_t M = fft_.size();
+  const double step = 2.0 * kPi / M;
+  bandOffsets_.push_back(0);
+  for (double scale : scales_) {
+    if (!(scale > 0.0) || !std::isfinite(scale)) {
+      throw std::runtime_error("Scales must be positive and finite!");
+    }
+    const double first = std::max(std::ceil(low / (scale * step)),
+                                  -double((M - 1) / 2));
+    const double last = std::min(std::floor(high / (scale * step)),
+                                 double(M / 2));
+    const std::ptrdiff_t firstBin = std::ptrdiff_t(first);
+    const std::ptrdiff_t lastBin = std::ptrdiff_t(last);
+    firstBins_.push_back(firstBin);
+    const double root = std::sqrt(scale);
+    for (std::ptrdiff_t k = firstBin; k <= lastBin; ++k) {
+      spectra_.push_back(
+          root * wavelet_spectrum(type, order_, norm, scale * step * k));
+    }
+    bandOffsets_.push_back(spectra_.size());
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Transforms one signal.
+ *
+ * @param signal The signal, signal_size() samples.
+ * @param coeffs The coefficients, scales().size() rows of signal_size().
+ */
+void CwtPlan::execute(const double *signal, Complex *coeffs) const {
+  run(signal, coeffs, nullptr);
+}
+
+//-------------------------------------------------------------
+/**
+ * Transforms one signal on a thread pool.
+ *
+ * @param signal The signal, signal_size() samples.
+ * @param coeffs The coefficients, scales().size() rows of signal_size().
+ * @param pool The threads to run on.
+ */
+void CwtPlan::execute(const double *signal, Complex *coeffs,
+                      ThreadPool &pool) const {
+  run(signal, coeffs, &pool);
+}
+
+//-------------------------------------------------------------
+/**
+ * Transforms the padded signal once and then every scale, or pair of scales
+ * of a real wavelet, as one task: the band of the product spectrum is
+ * written into a zeroed buffer, transformed back and the first signal_size()
+ * values kept. A pair puts the second scale in the imaginary part, which
+ * the inverse transform keeps apart since both products are Hermitian.
+ *
+ * @param signal The signal.
+ * @param coeffs The coefficients.
+ * @param pool The threads to run on, or nullptr.
+ */
+void CwtPlan::run(const double *signal, Complex *coeffs,
+                  ThreadPool *pool) const {
+  const size_t M = fft_.size();
+  Complex *padded = thread_buffer<CwtBuffers, Complex>(2, M);
+  Complex *spectrum = thread_buffer<CwtBuffers, Complex>(3, M);
+  for (size_t i = 0; i < M; ++i) {
+    padded[i] = i < signalSize_ ? signal[i] : 0.0;
+  }
+  fft_.forward(padded, spectrum);
+
+  const size_t perTask = real_ ? 2 : 1;
+  std::vector<size_t> tasks((scales_.size() + perTask - 1) / perTask);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    tasks[i] = i;
+  }
+  auto task = [&](size_t t) {
+    Complex *product = thread_buffer<CwtBuffers, Complex>(0, M);
+    Complex *time = thread_buffer<CwtBuffers, Complex>(1, M);
+    std::fill(product, product + M, Complex(0.0, 0.0));
+    const size_t first = t * perTask;
+    const size_t last = std::min(first + perTask, scales_.size());
+    for (size_t s = first; s < last; ++s) {
+      // the second scale of a pair goes to the imaginary part
+      const Complex unit = s == first ? Complex(1.0, 0.0) : Complex(0.0, 1.0);
+      const double *band = spectra_.data() + bandOffsets_[s];
+      const size_t count = bandOffsets_[s + 1] - bandOffsets_[s];
+      for (size_t j = 0; j < count; ++j) {
+        const std::ptrdiff_t k = firstBins_[s] + std::ptrdiff_t(j);
+        const size_t bin = k < 0 ? k + M : k;
+        product[bin] += spectrum[bin] * (unit * band[j]);
+      }
+    }
+    fft_.inverse(product, time);
+
+    for (size_t s = first; s < last; ++s) {
+      Complex *row = coeffs + s * signalSize_;
+      if (real_) {
+        for (size_t i = 0; i < signalSize_; ++i) {
+          row[i] = s == first ? time[i].real() : time[i].imag();
+        }
+        continue;
+      }
+      // the conjugated factor i^order
+      for (size_t i = 0; i < signalSize_; ++i) {
+        const Complex x = time[i];
+        switch (order_ % 4) {
+        case 0:
+          row[i] = x;
+          break;
+        case 1:
+          row[i] = Complex(x.imag(), -x.real());
+          break;
+        case 2:
+          row[i] = -x;
+          break;
+        default:
+          row[i] = Complex(-x.imag(), x.real());
+          break;
+        }
+      }
+    }
+  };
+  if (pool == nullptr) {
+    for (size_t t : tasks) {
+      task(t);
+    }
+  } else {
+    pool->run(tasks, task);
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the continuous wavelet transform of a signal.
+ *
+ * @param signal The signal.
+ * @param scales The scales, all positive and finite.
+ * @param wavelet_name "morl", "mexh" or "cgau1" to "cgau8".
+ * @return scales.size() rows of signal.size() coefficients.
+ */
+std::vector<Complex> cwt(const std::vector<double> &signal,
+                         const std::vector<double> &scales,
+                         const std::string wavelet_name) {
+  CwtPlan plan(signal.size(), scales, wavelet_name);
+  std::vector<Complex> coeffs(scales.size() * signal.size());
+  plan.execute(signal.data(), coeffs.data());
+  return coeffs;
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the continuous wavelet transform of a signal on a thread pool.
+ *
+ * @param signal The signal.
+ * @param scales The scales, all positive and finite.
+ * @param wavelet_name "morl", "mexh" or "cgau1" to "cgau8".
+ * @param pool The threads to run on.
+ * @return scales.size() rows of signal.size() coefficients.
+ */
+std::vector<Complex> cwt(const std::vector<double> &signal,
+                         const std::vector<double> &scales,
+                         const std::string wavelet_name, ThreadPool &pool) {
+  CwtPlan plan(signal.size(), scales, wavelet_name);
+  std::vector<Complex> coeffs(scales.size() * signal.size());
+  plan.execute(signal.data(), coeffs.data(), pool);
+  return coeffs;
+}
@@ -0,0 +1,77 @@
+#ifndef cwt_h
+#define cwt_h
+
+#include <complex>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "fft.h"
+
+class ThreadPool;
+
+// Continuous wavelet transform through the FFT,
+// coeffs(s, b) = sum_m x[m] psi*((m - b) / s) / sqrt(s), for the wavelets
+// "morl" (exp(-t^2 / 2) cos(5t)), "mexh" (the unit energy Mexican hat) and
+// "cgau1" to "cgau8" (the unit energy p-th derivatives of
+// exp(-it) exp(-t^2)), as in MATLAB. The signal is zero padded by the
+// support of the wavelet at the largest scale, 9, 10 and 8 times the scale
+// for morl, mexh and cgau, so that the correlation does not wrap around,
+// and transformed once; each scale is then the inverse transform of its
+// product with the analytic spectrum of the dilated wavelet. The plan
+// computes the spectra once, keeping only the band of each where it is not
+// negligible, and execute() does not modify the plan, so that one plan can
+// serve several threads. Scales below about 4 undersample the wavelets.
+class CwtPlan {
+public:
+  CwtPlan(size_t signalSize, const std::vector<double> &scales,
+          const std::string &wavelet_name);
+
+  size_t signal_size() const { return signalSize_; }
+
+  const std::vector<double> &scales() const { return scales_; }
+
+  size_t fft_size() const { return fft_.size(); }
+
+  // Writes scales().size() rows of signal_size() coefficients, one row per
+  // scale. The coefficients of the real wavelets morl and mexh are real, and
+  // two of their scales share each inverse transform, one in the real and
+  // one in the imaginary part. Buffers are per thread and reused between
+  // calls.
+  void execute(const double *signal, std::complex<double> *coeffs) const;
+
+  // Same with the scales spread over a thread pool. Must not be called from
+  // a task of the same pool.
+  void execute(const double *signal, std::complex<double> *coeffs,
+               ThreadPool &pool) const;
+
+private:
+  void run(const double *signal, std::complex<double> *coeffs,
+           ThreadPool *pool) const;
+
+  size_t signalSize_;
+  std::vector<double> scales_;
+  FftPlan fft_;
+  bool real_;
+  // derivative order of cgau, whose spectrum carries a factor i^order
+  size_t order_;
+  // per scale, the first signed frequency bin of its band and where the band
+  // starts in spectra_, which holds the conjugated dilated spectra times
+  // sqrt(scale); bandOffsets_ has one more entry for the end
+  std::vector<std::ptrdiff_t> firstBins_;
+  std::vector<size_t> bandOffsets_;
+  std::vector<double> spectra_;
+};
+
+// Scalogram of a signal at the given scales, scales.size() rows of
+// signal.size() coefficients, through a one shot CwtPlan.
+std::vector<std::complex<double>> cwt(const std::vector<double> &signal,
+                                      const std::vector<double> &scales,
+                                      const std::string wavelet_name);
+
+std::vector<std::complex<double>> cwt(const std::vector<double> &signal,
+                                      const std::vector<double> &scales,
+                                      const std::string wavelet_name,
+                                      ThreadPool &pool);
+
+#endif /* cwt_h */
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "buffers.h"
+#include "denoise.h"
+#include "dwt.h"
+#include "kernels.h"
+#include "noise.h"
+#include "threshold.h"
+#include "wavelets.h"
+
+enum class ThresholdRule { Universal, Sure, Minimax };
+
+// owner of the per thread buffers of this file: 0 for the details of all
+// levels, 1 for the two inner approximations, 2 for the work space of the
+// thresholds
+struct DenoiseBuffers;
+
+//-------------------------------------------------------------
+/**
+ * Parses the name of a threshold rule.
+ *
+ * @param rule "universal", "sure" or "minimax".
+ * @return The rule.
+ */
+static ThresholdRule threshold_rule(const std::string &rule) {
+  if (rule == "universal") {
+    return ThresholdRule::Universal;
+  }
+  if (rule == "sure") {
+    return ThresholdRule::Sure;
+  }
+  if (rule == "minimax") {
+    return ThresholdRule::Minimax;
+  }
+  throw std::runtime_error("Threshold rule error!");
+}
+
+//-------------------------------------------------------------
+/**
+ * Finds the threshold of least Stein unbiased risk for details of unit
+ * noise, the rigrsure of MATLAB. With the squared magnitudes sorted, the
+ * risk of thresholding at the k-th one is
+ * (n - 2k + sum of the first k + (n - k) x_k^2) / n for k = 1 .. n.
+ *
+ * @param cD The details.
+ * @param size The number of details.
+ * @param sigma The noise of the level, positive.
+ * @param work Room for size values.
+ * @return The threshold, in units of sigma.
+ */
+static double sure_threshold(const double *cD, size_t size, double sigma,
+                             double *work) {
+  for (size_t i = 0; i < size; ++i) {
+    const double x = cD[i] / sigma;
+    work[i] = x * x;
+  }
+  std::sort(work, work + size);
+  const double n = double(size);
+  double best = 0.0;
+  double bestRisk = 0.0;
+  double sum = 0.0;
+  for (size_t k = 0; k < size; ++k) {
+    sum += work[k];
+    const double risk =
+        (n - 2.0 * double(k + 1) + sum + double(size - k - 1) * work[k]) / n;
+    if (k == 0 || risk < bestRisk) {
+      bestRisk = risk;
+      best = work[k];
+    }
+  }
+  return std::sqrt(best);
+}
+
+//-------------------------------------------------------------
+/**
+ * Thresholds the details of one level in place.
+ *
+ * @param cD The details.
+ * @param size The number of details.
+ * @param rule The threshold rule.
+ * @param shrinkage The shrinkage, other than firm.
+ * @param kernels The kernels for the shrinkage.
+ * @param work Room for size values.
+ */
+static void threshold_level(double *cD, size_t size, ThresholdRule rule,
+                            ThresholdKind shrinkage,
+                            const KernelTable &kernels, double *work) {
+  const double sigma = noise_sigma(cD, size, "select");
+  if (!(sigma > 0.0)) {
+    // no noise to remove
+    return;
+  }
+  double threshold;
+  switch (rule) {
+  case ThresholdRule::Universal:
+    threshold = std::sqrt(2.0 * std::log(double(size)));
+    break;
+  case ThresholdRule::Sure:
+    threshold = sure_threshold(cD, size, sigma, work);
+    break;
+  default:
+    threshold = size > 32 ? 0.3936 + 0.1829 * std::log2(double(size)) : 0.0;
+    break;
+  }
+  kernels.threshold(cD, size, shrinkage, threshold * sigma, 0.0);
+}
+
+//-------------------------------------------------------------
+/**
+ * Denoises a signal.
+ *
+ * @param signal The noisy signal.
+ * @param level The decomposition level.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param rule The threshold rule, "universal", "sure" or "minimax".
+ * @param shrinkage The shrinkage, "soft", "hard" or "garrote".
+ * @return The denoised signal.
+ */
+std::vector<double> wdenoise(const std::vector<double> &signal, size_t level,
+                             const std::string wavelet_name,
+                             const std::string rule,
+                             const std::string shrinkage) {
+  std::vector<double> output(signal.size());
+  wdenoise(signal.data(), signal.size(), level, wavelet(wavelet_name), rule,
+           shrinkage, output.data());
+  return output;
+}
+
+//-------------------------------------------------------------
+/**
+ * Denoises a signal into a caller provided buffer. The details of level j
+ * are written after those of level j - 1 and thresholded before level j + 1
+ * runs; the approximations alternate between two halves of a buffer, the
+ * last one of the decomposition being the first one of the reconstruction.
+ *
+ * @param signal The noisy signal.
+ * @param signalSize The number of samples of the signal.
+ * @param level The decomposition level.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param rule The threshold rule, "universal", "sure" or "minimax".
+ * @param shrinkage The shrinkage, "soft", "hard" or "garrote".
+ * @param output The denoised signal, signalSize samples.
+ */
+void wdenoise(const double *signal, size_t signalSize, size_t level,
+              const Wavelet &w, const std::string &rule,
+              const std::string &shrinkage, double *output) {
+  const ThresholdRule thresholdRule = threshold_rule(rule);
+  const ThresholdKind shrinkageType = threshold_kind(shrinkage);
+  if (shrinkageType == ThresholdKind::Firm) {
+    // one threshold per level, where firm needs two
+    throw std::runtime_error("Shrinkage error!");
+  }
+  if (level == 0) {
+    if (output != signal) {
+      std::copy(signal, signal + signalSize, output);
+    }
+    return;
+  }
+
+  // lengths of the signal and of cA_1 .. cA_level, which are those of the
+  // details too; throws when the signal is too short for the level
+  std::vector<size_t> lengths(level + 1, signalSize);
+  size_t detailsSize = 0;
+  for (size_t i = 1; i <= level; ++i) {
+    lengths[i] = dwt_output_size(lengths[i - 1], w);
+    detailsSize += lengths[i];
+  }
+  double *details = thread_buffer<DenoiseBuffers>(0, detailsSize);
+  double *approximations = thread_buffer<DenoiseBuffers>(1, 2 * lengths[1]);
+  double *work = thread_buffer<DenoiseBuffers>(2, lengths[1]);
+  const KernelTable &kernels = active_kernels();
+
+  const double *input = signal;
+  double *cD = details;
+  for (size_t i = 1; i <= level; ++i) {
+    double *cA = approximations + (i % 2) * lengths[1];
+    kernels.dwt_analysis(input, lengths[i - 1], w.Lo_D, w.Ho_D, w.filterSize,
+                         cA, cD, 0, lengths[i]);
+    threshold_level(cD, lengths[i], thresholdRule, shrinkageType, kernels,
+                    work);
+    input = cA;
+    cD += lengths[i];
+  }
+
+  for (size_t i = level; i > 0; --i) {
+    cD -= lengths[i];
+    const double *cA = approximations + (i % 2) * lengths[1];
+    double *rebuilt =
+        i > 1 ? approximations + ((i - 1) % 2) * lengths[1] : output;
+    kernels.idwt_synthesis(cA, cD, w.Lo_R, w.Ho_R, w.filterSize, rebuilt, 0,
+                           lengths[i - 1]);
+  }
+}
@@ -0,0 +1,32 @@
+#ifndef denoise_h
+#define denoise_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "wavelets.h"
+
+// Wavelet denoising in one pass, the wden of MATLAB with level dependent
+// noise: a "sym" decomposition down to level whose details are thresholded as
+// each level is produced, while it is still in cache, followed by the
+// reconstruction. The noise of level j is sigma_j = median(|cD_j|) / 0.6745,
+// the "select" noise_sigma() of noise.h, and its threshold sigma_j times
+// that of the rule for the n_j coefficients of the level: "universal"
+// sqrt(2 log n_j), "sure" the threshold of least Stein unbiased risk, or
+// "minimax" 0.3936 + 0.1829 log2(n_j) (0 up to 32 coefficients). The
+// shrinkage is "soft", "hard" or "garrote", see threshold.h, and the
+// approximation is kept as is.
+std::vector<double> wdenoise(const std::vector<double> &signal, size_t level,
+                             const std::string wavelet_name,
+                             const std::string rule = "universal",
+                             const std::string shrinkage = "soft");
+
+// Same into a caller provided buffer of signalSize samples, which may be the
+// signal itself. The details, the inner approximations and the work space of
+// the thresholds go to per thread buffers that are reused between calls.
+void wdenoise(const double *signal, size_t signalSize, size_t level,
+              const Wavelet &w, const std::string &rule,
+              const std::string &shrinkage, double *output);
+
+#endif /* denoise_h */
@@ -1,36 +1,51 @@
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <math.h>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "buffers.h"
+#include "dwt.h"
+#include "fft.h"
+#include "kernels.h"
+#include "lifting.h"
+#include "threadpool.h"
+#include "wavelets.h"
+
 /**
- * Extends the input vector by adding reflection or constant values at the
- * beginning and end.
+ * Extends the input vector by mirroring values at the beginning and end.
  *
  * @param input The input vector to be extended.
  * @param extendLen The length by which the vector should be extended.
- * @param mode The extension mode, which can be "reflection" or "constant".
+ * @param mode The extension mode, which can be "sym".
  * @return The extended vector.
  */
-std::vector<double> wextend(const std::vector<double> &input,
-                            const int extendLen, const std::string &mode) {
-
-  int extendSize = input.size() + extendLen * 2;
-  std::vector<double> extendedinput(extendSize);
-  int inputSize = input.size();
-
+template <typename T>
+std::vector<T> wextend(const std::vector<T> &input, const int extendLen,
+                       const std::string &mode) {
   if (input.empty() || extendLen == 0) {
     return input;
   }
-  if (input.size() < extendLen) {
+  // a negative extendLen counts as too long, as it did when converted to
+  // size_t for the comparison
+  if (extendLen < 0 || input.size() < static_cast<size_t>(extendLen)) {
     throw std::runtime_error("input size is less than extendLen!");
   }
 
+  int extendSize = input.size() + extendLen * 2;
+  std::vector<T> extendedinput(extendSize);
+  int inputSize = input.size();
+
   if (mode == "sym") {
     // 对称延拓extendLen个点
     for (int i = 0; i < extendLen; ++i) {
@@ -58,6 +73,7 @@ std::vector<double> wextend(const std::vector<double> &input,
  * @param mode The convolution mode, which can be "full", "same" or "valid".
  * @return The convolution result.
  */
+template <>
 std::vector<double> wconv1(const std::vector<double> &input,
                            const std::vector<double> &wfilters,
                            const std::string &mode) {
@@ -67,20 +83,15 @@ std::vector<double> wconv1(const std::vector<double> &input,
   }
 
   if (mode == "full") {
-    int outputSize = input.size() + wfilters.size() - 1;
-    std::vector<double> output(outputSize, 0.0);
-    // zero padding for input and filters
-    std::vector<double> paddedInput(outputSize, 0.0);
-    std::vector<double> paddedFilters(outputSize, 0.0);
-    // zero padding for input and filters
-    std::copy(input.begin(), input.end(), paddedInput.begin());
-    std::copy(wfilters.begin(), wfilters.end(), paddedFilters.begin());
-    for (int i = 0; i < outputSize; ++i) {
-      output[i] = 0.0;
-      for (int j = 0; j <= i; ++j) {
-        const int filterIndex = i - j;
-        output[i] += paddedInput[j] * paddedFilters[filterIndex];
-      }
+    std::vector<double> output(input.size() + wfilters.size() - 1);
+    // long filters go through the FFT, short ones are direct sums
+    if (std::min(input.size(), wfilters.size()) >=
+        active_kernels().fft_conv_threshold) {
+      fft_conv_full(input.data(), input.size(), wfilters.data(),
+                    wfilters.size(), output.data());
+    } else {
+      conv_full(input.data(), input.size(), wfilters.data(), wfilters.size(),
+                output.data());
     }
     return output;
   } else if (mode == "same") {
@@ -90,14 +101,9 @@ std::vector<double> wconv1(const std::vector<double> &input,
     if (input.size() < wfilters.size()) {
       return std::vector<double>();
     }
-    int outputSize = input.size() - wfilters.size() + 1;
-    std::vector<double> output(outputSize, 0.0);
-    for (int i = 0; i < outputSize; ++i) {
-      for (size_t j = 0; j < wfilters.size(); ++j) {
-        const int filterIndex = wfilters.size() - j - 1;
-        output[i] += input[i + j] * wfilters[filterIndex];
-      }
-    }
+    std::vector<double> output(input.size() - wfilters.size() + 1);
+    conv_valid(input.data(), input.size(), wfilters.data(), wfilters.size(),
+               output.data());
     return output;
   } else {
     throw std::runtime_error("Invalid padding mode!");
@@ -105,6 +111,24 @@ std::vector<double> wconv1(const std::vector<double> &input,
   return std::vector<double>();
 }
 
+/**
+ * Performs a 1-D convolution of the input vector with the given filter in
+ * double precision, since the convolution kernels and the FFT work in double.
+ *
+ * @param input The input vector.
+ * @param filter The filter.
+ * @param mode The convolution mode, which can be "full", "same" or "valid".
+ * @return The convolution result, rounded to the sample type.
+ */
+template <typename T>
+std::vector<T> wconv1(const std::vector<T> &input,
+                      const std::vector<T> &wfilters, const std::string &mode) {
+  const std::vector<double> output =
+      wconv1(std::vector<double>(input.begin(), input.end()),
+             std::vector<double>(wfilters.begin(), wfilters.end()), mode);
+  return std::vector<T>(output.begin(), output.end());
+}
+
 /**
  * Downsamples the input vector by keeping every other element starting from the
  * first.
@@ -114,12 +138,16 @@ std::vector<double> wconv1(const std::vector<double> &input,
  * @param last The last element to keep.
  * @return The downsampled vector.
  */
-std::vector<double> downsample(const std::vector<double> coeffs,
-                               const size_t first, const size_t last) {
+template <typename T>
+std::vector<T> downsample(const std::vector<T> &coeffs, const size_t first,
+                          const size_t last) {
   if (last < 2 * first) {
     throw std::runtime_error("last must larger than first!");
   }
-  std::vector<double> downsampled;
+  std::vector<T> downsampled;
+  if (first - 1 < coeffs.size()) {
+    downsampled.reserve((coeffs.size() - first) / 2 + 1);
+  }
 
   for (size_t i = first - 1; i < coeffs.size(); i += 2) {
     downsampled.push_back(coeffs[i]);
@@ -128,62 +156,450 @@ std::vector<double> downsample(const std::vector<double> coeffs,
   return downsampled;
 }
 
+// owner of the per thread buffers of this file: 0 for the inner cA of a
+// decomposition, 1 for the lifting workspace, 2 for widened integer samples,
+// 3 and 4 for the transposed samples and coefficients of planar batches
+struct DwtBuffers;
+
+//-------------------------------------------------------------
+/**
+ * Factorizes the filters of an orthogonal wavelet into lifting steps, once
+ * per wavelet.
+ *
+ * @param w The wavelet.
+ * @return The lifting scheme of the wavelet.
+ */
+static const LiftingScheme &lifting_scheme(const Wavelet &w) {
+  if (!w.orthogonal) {
+    throw std::runtime_error("Lifting needs an orthogonal wavelet!");
+  }
+  static std::vector<std::once_flag> flags(wavelet_count());
+  static std::vector<std::unique_ptr<LiftingScheme>> schemes(wavelet_count());
+  std::call_once(flags[w.id], [&w] {
+    schemes[w.id].reset(new LiftingScheme(
+        std::vector<double>(w.Lo_D, w.Lo_D + w.filterSize),
+        std::vector<double>(w.Ho_D, w.Ho_D + w.filterSize)));
+  });
+  return *schemes[w.id];
+}
+
+//-------------------------------------------------------------
+/**
+ * Looks up the lifting scheme when the lifting strategy is asked for. The
+ * lifting steps only run in double.
+ *
+ * @param w The wavelet.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ * @return The lifting scheme of w, or null for the filter bank.
+ */
+template <typename T>
+static const LiftingScheme *lifting_for(const Wavelet &w,
+                                        DwtStrategy strategy) {
+  if (strategy != DwtStrategy::Lifting) {
+    return nullptr;
+  }
+  if (!std::is_same<T, double>::value) {
+    throw std::runtime_error("Lifting needs double precision!");
+  }
+  return &lifting_scheme(w);
+}
+
+//-------------------------------------------------------------
+/**
+ * Returns the samples in the precision the transforms compute in. Float and
+ * double samples are used as they are, integer samples are converted into a
+ * per thread buffer.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal.
+ * @return The samples as dwt_value_t<T>.
+ */
+template <typename T>
+static const dwt_value_t<T> *widen(const T *signal, size_t signalSize) {
+  if constexpr (std::is_same<T, dwt_value_t<T>>::value) {
+    return signal;
+  } else {
+    dwt_value_t<T> *samples =
+        thread_buffer<DwtBuffers, dwt_value_t<T>>(2, signalSize);
+    std::copy(signal, signal + signalSize, samples);
+    return samples;
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the coefficients [first, last) of one level of a "sym" dwt with
+ * the filter bank kernel. Only the coefficients kept by the downsampling are
+ * computed, reading the extension through virtual boundary indexing.
+ *
+ * @param w The wavelet.
+ * @param kernels The kernels for the filter bank.
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal.
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ * @param first The first coefficient to compute.
+ * @param last One past the last coefficient to compute.
+ */
+static void analysis_range(const Wavelet &w, const KernelTable &kernels,
+                           const double *signal, size_t signalSize, double *cA,
+                           double *cD, size_t first, size_t last) {
+  kernels.dwt_analysis(signal, signalSize, w.Lo_D, w.Ho_D, w.filterSize, cA,
+                       cD, first, last);
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the coefficients [first, last) of one level of a "sym" dwt in
+ * float.
+ */
+static void analysis_range(const Wavelet &w, const KernelTable &kernels,
+                           const float *signal, size_t signalSize, float *cA,
+                           float *cD, size_t first, size_t last) {
+  kernels.dwt_analysis_f32(signal, signalSize, w.Lo_D_f32, w.Ho_D_f32,
+                           w.filterSize, cA, cD, first, last);
+}
+
+// Levels with at least two chunks of coefficients are split over the thread
+// pool, a chunk at a time.
+static const size_t kParallelChunk = 1 << 15;
+
+//-------------------------------------------------------------
+/**
+ * Computes one level of a "sym" dwt with the filter bank kernel, splitting
+ * long levels into chunks of coefficients that run on the thread pool. Each
+ * chunk reads its samples plus a halo of filterSize - 2 on the left straight
+ * from the shared input, and the kernels compute every coefficient the same
+ * way whatever range it is part of, so the result is bit-identical to the
+ * serial one.
+ *
+ * @param w The wavelet.
+ * @param kernels The kernels for the filter bank.
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal.
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ * @param outputSize The length of cA, and of cD.
+ * @param pool The threads to run on, or null to run serially.
+ */
+template <typename T>
+static void filter_bank_level(const Wavelet &w, const KernelTable &kernels,
+                              const T *signal, size_t signalSize, T *cA,
+                              T *cD, size_t outputSize, ThreadPool *pool) {
+  if (pool == nullptr || pool->size() < 2 ||
+      outputSize < 2 * kParallelChunk) {
+    analysis_range(w, kernels, signal, signalSize, cA, cD, 0, outputSize);
+    return;
+  }
+  std::vector<size_t> chunks((outputSize + kParallelChunk - 1) /
+                             kParallelChunk);
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    chunks[i] = i;
+  }
+  pool->run(chunks, [&](size_t i) {
+    const size_t first = i * kParallelChunk;
+    const size_t last = std::min(first + kParallelChunk, outputSize);
+    analysis_range(w, kernels, signal, signalSize, cA, cD, first, last);
+  });
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes one level of a "sym" dwt, with the lifting steps if there are any
+ * and else with the filter bank kernel.
+ *
+ * @param w The wavelet.
+ * @param kernels The kernels for the filter bank.
+ * @param lifting The lifting scheme of w, or null for the filter bank.
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal.
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ * @param outputSize The length of cA, and of cD.
+ * @param workspace The lifting workspace.
+ * @param pool The threads for the filter bank, or null to run serially.
+ */
+static void analysis_level(const Wavelet &w, const KernelTable &kernels,
+                           const LiftingScheme *lifting, const double *signal,
+                           size_t signalSize, double *cA, double *cD,
+                           size_t outputSize, double *workspace,
+                           ThreadPool *pool = nullptr) {
+  if (lifting != nullptr) {
+    // the lifting steps run over the whole level and stay serial
+    lifting->analysis(signal, signalSize, cA, cD, outputSize, workspace);
+    return;
+  }
+  filter_bank_level(w, kernels, signal, signalSize, cA, cD, outputSize, pool);
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes one level of a "sym" dwt in float, always with the filter bank.
+ */
+static void analysis_level(const Wavelet &w, const KernelTable &kernels,
+                           const LiftingScheme *, const float *signal,
+                           size_t signalSize, float *cA, float *cD,
+                           size_t outputSize, float *,
+                           ThreadPool *pool = nullptr) {
+  filter_bank_level(w, kernels, signal, signalSize, cA, cD, outputSize, pool);
+}
+
+//-------------------------------------------------------------
 /**
  * Performs a 1-D discrete wavelet transform of the input vector.
  *
  * @param signal The input vector.
- * @param wavelet_name The wavelet name, which can be "db5".
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
  * @param mode The extension mode, which can be "sym".
+ * @param strategy Whether to run the filter bank or its lifting steps.
  * @return The wavelet coefficients.
  */
-std::pair<std::vector<double>, std::vector<double>>
-dwt(const std::vector<double> &signal, const std::string wavelet_name,
-    const std::string mode) {
-
-  std::vector<double> Lo_D;
-  std::vector<double> Ho_D;
-
-  if (wavelet_name == "db5") {
-    // aquire db5 wavelet by matlab wfilters func
-    Lo_D = {0.00333572528500155, -0.0125807519990155, -0.00624149021301171,
-            0.0775714938400652,  -0.0322448695850295, -0.242294887066190,
-            0.138428145901103,   0.724308528438574,   0.603829269797473,
-            0.160102397974125};
-
-    Ho_D = {-0.160102397974125,  0.603829269797473,    -0.724308528438574,
-            0.138428145901103,   0.242294887066190,    -0.0322448695850295,
-            -0.0775714938400652, -0.00624149021301171, 0.0125807519990155,
-            0.00333572528500155};
-  } else {
-    throw std::runtime_error("Wavelet name must be db5!");
+template <typename T>
+std::pair<std::vector<dwt_value_t<T>>, std::vector<dwt_value_t<T>>>
+dwt(const std::vector<T> &signal, const std::string wavelet_name,
+    const std::string mode, DwtStrategy strategy) {
+  return dwt(signal, wavelet(wavelet_name), mode, strategy);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a 1-D discrete wavelet transform of the input vector.
+ *
+ * @param signal The input vector.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ * @return The wavelet coefficients.
+ */
+template <typename T>
+std::pair<std::vector<dwt_value_t<T>>, std::vector<dwt_value_t<T>>>
+dwt(const std::vector<T> &signal, const Wavelet &w, const std::string mode,
+    DwtStrategy strategy) {
+  std::vector<dwt_value_t<T>> cA(dwt_output_size(signal.size(), w));
+  std::vector<dwt_value_t<T>> cD(cA.size());
+  dwt(signal.data(), signal.size(), w, mode, cA.data(), cD.data(), strategy);
+  return std::make_pair(std::move(cA), std::move(cD));
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a 1-D discrete wavelet transform into caller provided buffers.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ * @param cA The approximation coefficients, dwt_output_size() of them.
+ * @param cD The detail coefficients, dwt_output_size() of them.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ */
+template <typename T>
+void dwt(const T *signal, size_t signalSize, const Wavelet &w,
+         const std::string &mode, dwt_value_t<T> *cA, dwt_value_t<T> *cD,
+         DwtStrategy strategy) {
+  using Value = dwt_value_t<T>;
+  if (mode != "sym") {
+    throw std::runtime_error("Mode error!");
+  }
+  size_t outputSize = dwt_output_size(signalSize, w);
+
+  const LiftingScheme *lifting = lifting_for<Value>(w, strategy);
+  Value *workspace = lifting != nullptr
+                         ? thread_buffer<DwtBuffers, Value>(
+                               1, lifting->workspace_size())
+                         : nullptr;
+  analysis_level(w, active_kernels(), lifting, widen(signal, signalSize),
+                 signalSize, cA, cD, outputSize, workspace);
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the number of coefficients a single level dwt() gives in cA and
+ * in cD.
+ *
+ * @param signalSize The number of samples of the signal.
+ * @param w The wavelet.
+ * @return The length of cA, and of cD.
+ */
+size_t dwt_output_size(size_t signalSize, const Wavelet &w) {
+  if (signalSize == 0) {
+    throw std::runtime_error("input or wfilters is empty!");
   }
 
   // define the extend length
-  int extendLen = Lo_D.size() - 1;
+  size_t extendLen = w.filterSize - 1;
+
+  // the extension is only virtual, but reflecting extendLen samples still
+  // needs that many samples in the signal
+  if (signalSize < extendLen) {
+    throw std::runtime_error("input size is less than extendLen!");
+  }
+
+  // same length as downsampling the "valid" convolution of the extended
+  // signal, starting from its second element
+  return (signalSize + extendLen) / 2;
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the number of coefficients of a multilevel decomposition,
+ * cA_level and cD_level .. cD_1 together.
+ *
+ * @param signalSize The number of samples of the signal.
+ * @param level The decomposition level.
+ * @param w The wavelet.
+ * @return The length of the coefficient vector.
+ */
+size_t wavedec_output_size(size_t signalSize, size_t level, const Wavelet &w) {
+  size_t outputSize = 0;
+  size_t inputSize = signalSize;
+  for (size_t i = 0; i < level; ++i) {
+    inputSize = dwt_output_size(inputSize, w);
+    outputSize += inputSize;
+  }
+  return outputSize + inputSize;
+}
 
-  std::vector<double> cA(signal.size() + extendLen * 2);
-  std::vector<double> cD(signal.size() + extendLen * 2);
+//-------------------------------------------------------------
+/**
+ * Runs the levels of a "sym" decomposition, writing cD_1 .. cD_level and the
+ * final cA straight to their places in the coefficients. The inner cA
+ * alternate between the two halves of scratch, which holds the lengths of
+ * cA_1 and cA_2.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal, checked by
+ * wavedec_output_size().
+ * @param level The decomposition level.
+ * @param outputSize The number of coefficients, from wavedec_output_size().
+ * @param w The wavelet.
+ * @param kernels The kernels for the filter bank.
+ * @param lifting The lifting scheme of w, or null for the filter bank.
+ * @param coeffs The coefficients.
+ * @param scratch The buffer for the inner cA.
+ * @param workspace The lifting workspace.
+ * @param pool The threads for the long levels, or null to run serially.
+ */
+template <typename T>
+static void decompose(const T *signal, size_t signalSize, size_t level,
+                      size_t outputSize, const Wavelet &w,
+                      const KernelTable &kernels, const LiftingScheme *lifting,
+                      T *coeffs, T *scratch, T *workspace,
+                      ThreadPool *pool = nullptr) {
+  if (level == 0) {
+    std::copy(signal, signal + signalSize, coeffs);
+    return;
+  }
 
-  // extend the input signal
-  std::vector<double> extendedInput = wextend(signal, extendLen, mode);
+  const size_t extendLen = w.filterSize - 1;
+  const size_t firstSize = (signalSize + extendLen) / 2;
+  const T *input = signal;
+  size_t inputSize = signalSize;
+  // cD_1 goes last, the final cA first
+  size_t offset = outputSize;
+  for (size_t i = 0; i < level; ++i) {
+    const size_t levelSize = (inputSize + extendLen) / 2;
+    offset -= levelSize;
+    // the last cA is written to its final place, the others feed the next
+    // level from the scratch buffer
+    T *cA = i + 1 == level ? coeffs : scratch + (i % 2) * firstSize;
+    T *cD = coeffs + offset;
+    analysis_level(w, kernels, lifting, input, inputSize, cA, cD, levelSize,
+                   workspace, pool);
+    input = cA;
+    inputSize = levelSize;
+  }
+}
 
-  // low pass filter to get the low frequency part
-  cA = wconv1(extendedInput, Lo_D, "valid");
+//-------------------------------------------------------------
+/**
+ * Computes how many values decompose() needs in its scratch buffer.
+ *
+ * @param signalSize The number of samples of the signal.
+ * @param level The decomposition level.
+ * @param w The wavelet.
+ * @return The size of the scratch buffer.
+ */
+static size_t decompose_scratch_size(size_t signalSize, size_t level,
+                                     const Wavelet &w) {
+  const size_t extendLen = w.filterSize - 1;
+  const size_t firstSize = (signalSize + extendLen) / 2;
+  if (level < 2) {
+    return 0;
+  }
+  return level == 2 ? firstSize : firstSize + (firstSize + extendLen) / 2;
+}
 
-  // high pass filter to get the high frequency part
-  cD = wconv1(extendedInput, Ho_D, "valid");
+//-------------------------------------------------------------
+/**
+ * Runs a multilevel decomposition into a caller provided buffer, the shared
+ * part of the wavelet_decomposition() overloads.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal.
+ * @param level The decomposition level.
+ * @param w The wavelet.
+ * @param coeffs The coefficients, as many as wavedec_output_size() gives.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ * @param pool The threads for the long levels, or null to run serially.
+ */
+template <typename T>
+static void decompose_signal(const T *signal, size_t signalSize, size_t level,
+                             const Wavelet &w, dwt_value_t<T> *coeffs,
+                             DwtStrategy strategy, ThreadPool *pool) {
+  using Value = dwt_value_t<T>;
+  const size_t outputSize = wavedec_output_size(signalSize, level, w);
+  const LiftingScheme *lifting =
+      level > 0 ? lifting_for<Value>(w, strategy) : nullptr;
+  Value *workspace = lifting != nullptr
+                         ? thread_buffer<DwtBuffers, Value>(
+                               1, lifting->workspace_size())
+                         : nullptr;
+  decompose(widen(signal, signalSize), signalSize, level, outputSize, w,
+            active_kernels(), lifting, coeffs,
+            thread_buffer<DwtBuffers, Value>(
+                0, decompose_scratch_size(signalSize, level, w)),
+            workspace, pool);
+}
 
-  // downsample the coefficients
-  std::vector<double> downsampled_cA(cA.size() / 2);
-  std::vector<double> downsampled_cD(cD.size() / 2);
+//-------------------------------------------------------------
+/**
+ * Runs a multilevel decomposition of a vector, the shared part of the
+ * vector wavelet_decomposition() overloads.
+ *
+ * @param signal The input vector.
+ * @param level The decomposition level.
+ * @param wavelet_type The wavelet name, see wavelet() for the registry.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ * @param pool The threads for the long levels, or null to run serially.
+ * @return The wavelet coefficients and the lengths of cD_1 .. cD_level.
+ */
+template <typename T>
+static std::pair<std::vector<dwt_value_t<T>>, std::vector<double>>
+decompose_vector(const std::vector<T> &signal, size_t level,
+                 const std::string &wavelet_type, DwtStrategy strategy,
+                 ThreadPool *pool) {
+  // resolved once for all levels
+  const Wavelet &w = wavelet(wavelet_type);
 
-  int first = 2;
-  int last = signal.size() + extendLen;
+  // the final layout cA_level, cD_level .. cD_1 is known up front, and each
+  // level writes its cD straight into its slot
+  std::vector<dwt_value_t<T>> coeffs(
+      wavedec_output_size(signal.size(), level, w));
 
-  downsampled_cA = downsample(cA, first, last);
-  downsampled_cD = downsample(cD, first, last);
+  // record the length of cD
+  std::vector<double> list;
+  list.reserve(level);
+  size_t inputSize = signal.size();
+  for (size_t i = 0; i < level; ++i) {
+    inputSize = dwt_output_size(inputSize, w);
+    list.push_back(inputSize);
+  }
 
-  return std::make_pair(downsampled_cA, downsampled_cD);
+  decompose_signal(signal.data(), signal.size(), level, w, coeffs.data(),
+                   strategy, pool);
+
+  return std::make_pair(coeffs, list);
 }
 
 //-------------------------------------------------------------
@@ -192,40 +608,510 @@ dwt(const std::vector<double> &signal, const std::string wavelet_name,
  *
  * @param signal The input vector.
  * @param level The decomposition level.
- * @param wavelet_type The wavelet name, which can be "db5".
+ * @param wavelet_type The wavelet name, see wavelet() for the registry.
+ * @param strategy Whether to run the filter bank or its lifting steps.
  * @return The wavelet coefficients.
  */
+template <typename T>
+std::pair<std::vector<dwt_value_t<T>>, std::vector<double>>
+wavelet_decomposition(const std::vector<T> &signal, const size_t level,
+                      const std::string wavelet_type, DwtStrategy strategy) {
+  return decompose_vector(signal, level, wavelet_type, strategy, nullptr);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a 1-D discrete wavelet transform of the input vector, with the
+ * long levels split over a thread pool.
+ *
+ * @param signal The input vector.
+ * @param level The decomposition level.
+ * @param wavelet_type The wavelet name, see wavelet() for the registry.
+ * @param pool The threads to run on.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ * @return The wavelet coefficients.
+ */
+template <typename T>
+std::pair<std::vector<dwt_value_t<T>>, std::vector<double>>
+wavelet_decomposition(const std::vector<T> &signal, const size_t level,
+                      const std::string wavelet_type, ThreadPool &pool,
+                      DwtStrategy strategy) {
+  return decompose_vector(signal, level, wavelet_type, strategy, &pool);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a multilevel 1-D discrete wavelet transform into a caller provided
+ * buffer.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal.
+ * @param level The decomposition level.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param coeffs The coefficients cA_level, cD_level .. cD_1, as many as
+ * wavedec_output_size() gives.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ */
+template <typename T>
+void wavelet_decomposition(const T *signal, size_t signalSize, size_t level,
+                           const Wavelet &w, dwt_value_t<T> *coeffs,
+                           DwtStrategy strategy) {
+  decompose_signal(signal, signalSize, level, w, coeffs, strategy, nullptr);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a multilevel 1-D discrete wavelet transform into a caller provided
+ * buffer, with the long levels split over a thread pool.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples of the signal.
+ * @param level The decomposition level.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param coeffs The coefficients cA_level, cD_level .. cD_1, as many as
+ * wavedec_output_size() gives.
+ * @param pool The threads to run on.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ */
+template <typename T>
+void wavelet_decomposition(const T *signal, size_t signalSize, size_t level,
+                           const Wavelet &w, dwt_value_t<T> *coeffs,
+                           ThreadPool &pool, DwtStrategy strategy) {
+  decompose_signal(signal, signalSize, level, w, coeffs, strategy, &pool);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs single level 1-D discrete wavelet transforms of a batch of
+ * channels.
+ *
+ * @param signals The channels, signals.size() / channels samples each.
+ * @param channels The number of channels.
+ * @param layout How the channels are stored.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param mode The extension mode, which can be "sym".
+ * @return The wavelet coefficients of all channels, in the same layout.
+ */
 std::pair<std::vector<double>, std::vector<double>>
-wavelet_decomposition(const std::vector<double> &signal, const size_t level,
-                      const std::string wavelet_type) {
-  std::vector<double> coeffs(signal.size());
-  coeffs = signal;
-  std::vector<double> all_cD;
-  std::vector<double> cA, cD;
-  std::vector<double> list;
+dwt_batch(const std::vector<double> &signals, size_t channels,
+          ChannelLayout layout, const std::string wavelet_name,
+          const std::string mode) {
+  if (channels == 0 || signals.size() % channels != 0) {
+    throw std::runtime_error("Batch size is not a multiple of the channels!");
+  }
+  const Wavelet &w = wavelet(wavelet_name);
+  const size_t signalSize = signals.size() / channels;
+  std::vector<double> cA(dwt_output_size(signalSize, w) * channels);
+  std::vector<double> cD(cA.size());
+  dwt_batch(signals.data(), channels, signalSize, layout, w, mode, cA.data(),
+            cD.data());
+  return std::make_pair(std::move(cA), std::move(cD));
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs single level 1-D discrete wavelet transforms of a batch of
+ * channels into caller provided buffers. Interleaved channels go straight to
+ * the kernel, which runs one channel per vector lane; planar ones are
+ * transposed in groups of kBatchGroup channels first.
+ *
+ * @param signals The channels.
+ * @param channels The number of channels.
+ * @param signalSize The number of samples of each channel.
+ * @param layout How the channels are stored.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ * @param cA The approximation coefficients, dwt_output_size() per channel.
+ * @param cD The detail coefficients, dwt_output_size() per channel.
+ */
+void dwt_batch(const double *signals, size_t channels, size_t signalSize,
+               ChannelLayout layout, const Wavelet &w, const std::string &mode,
+               double *cA, double *cD) {
+  static const size_t kBatchGroup = 16;
+  if (mode != "sym") {
+    throw std::runtime_error("Mode error!");
+  }
+  if (channels == 0) {
+    throw std::runtime_error("Batch size is not a multiple of the channels!");
+  }
+  const size_t outputSize = dwt_output_size(signalSize, w);
+  const KernelTable &kernels = active_kernels();
 
-  std::pair<std::vector<double>, std::vector<double>> wavedec_set;
+  if (layout == ChannelLayout::Interleaved) {
+    kernels.dwt_analysis_interleaved(signals, signalSize, channels, channels,
+                                     w.Lo_D, w.Ho_D, w.filterSize, cA, cD, 0,
+                                     outputSize);
+    return;
+  }
 
-  for (size_t i = 0; i < level; ++i) {
-    std::pair<std::vector<double>, std::vector<double>> result =
-        dwt(coeffs, wavelet_type, "sym");
-    cA = result.first;
-    cD = result.second;
+  double *samples =
+      thread_buffer<DwtBuffers, double>(3, signalSize * kBatchGroup);
+  double *coeffs =
+      thread_buffer<DwtBuffers, double>(4, 2 * outputSize * kBatchGroup);
+  for (size_t c0 = 0; c0 < channels; c0 += kBatchGroup) {
+    const size_t group = std::min(kBatchGroup, channels - c0);
+    for (size_t c = 0; c < group; ++c) {
+      const double *x = signals + (c0 + c) * signalSize;
+      for (size_t i = 0; i < signalSize; ++i) {
+        samples[i * group + c] = x[i];
+      }
+    }
+    double *groupA = coeffs;
+    double *groupD = coeffs + outputSize * group;
+    kernels.dwt_analysis_interleaved(samples, signalSize, group, group,
+                                     w.Lo_D, w.Ho_D, w.filterSize, groupA,
+                                     groupD, 0, outputSize);
+    for (size_t c = 0; c < group; ++c) {
+      double *a = cA + (c0 + c) * outputSize;
+      double *d = cD + (c0 + c) * outputSize;
+      for (size_t k = 0; k < outputSize; ++k) {
+        a[k] = groupA[k * group + c];
+        d[k] = groupD[k * group + c];
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs multilevel 1-D discrete wavelet transforms of a batch of signals
+ * on the default thread pool.
+ *
+ * @param signals The signals, packed back to back.
+ * @param offsets The start of every signal in signals, followed by
+ * signals.size().
+ * @param level The decomposition level.
+ * @param wavelet_type The wavelet name, see wavelet() for the registry.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ * @return The coefficients of all signals and the start of every signal's
+ * coefficients, followed by their total count.
+ */
+std::pair<std::vector<double>, std::vector<size_t>>
+wavelet_decomposition_batch(const std::vector<double> &signals,
+                            const std::vector<size_t> &offsets, size_t level,
+                            const std::string wavelet_type,
+                            DwtStrategy strategy) {
+  return wavelet_decomposition_batch(signals, offsets, level, wavelet_type,
+                                     default_thread_pool(), strategy);
+}
 
-    // record the length of cD
-    list.push_back(cD.size());
+//-------------------------------------------------------------
+/**
+ * Performs multilevel 1-D discrete wavelet transforms of a batch of signals
+ * on a thread pool. The output is sized once up front and every signal
+ * decomposes straight into its slice, with intermediate results in the per
+ * thread buffers, so the tasks do not allocate. They are handed to the pool
+ * longest first, which together with work stealing keeps the threads evenly
+ * loaded when the lengths differ.
+ *
+ * @param signals The signals, packed back to back.
+ * @param offsets The start of every signal in signals, followed by
+ * signals.size().
+ * @param level The decomposition level.
+ * @param wavelet_type The wavelet name, see wavelet() for the registry.
+ * @param pool The threads to run on.
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ * @return The coefficients of all signals and the start of every signal's
+ * coefficients, followed by their total count.
+ */
+std::pair<std::vector<double>, std::vector<size_t>>
+wavelet_decomposition_batch(const std::vector<double> &signals,
+                            const std::vector<size_t> &offsets, size_t level,
+                            const std::string wavelet_type, ThreadPool &pool,
+                            DwtStrategy strategy) {
+  if (offsets.empty() || offsets.front() != 0 ||
+      offsets.back() != signals.size() ||
+      !std::is_sorted(offsets.begin(), offsets.end())) {
+    throw std::runtime_error("Batch offsets do not match the signals!");
+  }
+  const Wavelet &w = wavelet(wavelet_type);
+  const size_t count = offsets.size() - 1;
 
-    all_cD.insert(all_cD.begin(), cD.begin(), cD.end());
-    // cA assign to coeffs,as the input of next level
-    coeffs.assign(cA.begin(), cA.end());
+  std::vector<size_t> coeffOffsets(count + 1, 0);
+  for (size_t i = 0; i < count; ++i) {
+    coeffOffsets[i + 1] =
+        coeffOffsets[i] +
+        wavedec_output_size(offsets[i + 1] - offsets[i], level, w);
+  }
+  // resolve the lifting scheme here, so that its errors are not raised
+  // once per task
+  if (count > 0 && level > 0) {
+    lifting_for<double>(w, strategy);
   }
 
-  // merge cA and cD
-  for (const auto value : all_cD) {
-    coeffs.push_back(value);
+  std::vector<size_t> order(count);
+  for (size_t i = 0; i < count; ++i) {
+    order[i] = i;
   }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return offsets[a + 1] - offsets[a] > offsets[b + 1] - offsets[b];
+  });
 
-  return std::make_pair(coeffs, list);
+  std::vector<double> coeffs(coeffOffsets.back());
+  pool.run(order, [&](size_t i) {
+    wavelet_decomposition(signals.data() + offsets[i],
+                          offsets[i + 1] - offsets[i], level, w,
+                          coeffs.data() + coeffOffsets[i], strategy);
+  });
+  return std::make_pair(std::move(coeffs), std::move(coeffOffsets));
 }
 
 //-------------------------------------------------------------
+/**
+ * Computes the length of the signal reconstructed by idwt(), the longer of
+ * the two signal lengths whose dwt() gives coeffsSize coefficients.
+ *
+ * @param coeffsSize The length of cA, and of cD.
+ * @param w The wavelet.
+ * @return The number of samples of the signal.
+ */
+size_t idwt_output_size(size_t coeffsSize, const Wavelet &w) {
+  // output i reads the coefficients i / 2 .. i / 2 + filterSize / 2 - 1
+  const size_t half = w.filterSize / 2;
+  if (coeffsSize < half) {
+    throw std::runtime_error("Coefficients are shorter than the filters!");
+  }
+  return 2 * (coeffsSize - half + 1);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a 1-D inverse discrete wavelet transform.
+ *
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param mode The extension mode, which can be "sym".
+ * @param signalSize The length of the signal, 0 for idwt_output_size().
+ * @return The reconstructed signal.
+ */
+std::vector<double> idwt(const std::vector<double> &cA,
+                         const std::vector<double> &cD,
+                         const std::string wavelet_name,
+                         const std::string mode, size_t signalSize) {
+  return idwt(cA, cD, wavelet(wavelet_name), mode, signalSize);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a 1-D inverse discrete wavelet transform.
+ *
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ * @param signalSize The length of the signal, 0 for idwt_output_size().
+ * @return The reconstructed signal.
+ */
+std::vector<double> idwt(const std::vector<double> &cA,
+                         const std::vector<double> &cD, const Wavelet &w,
+                         const std::string mode, size_t signalSize) {
+  if (cA.size() != cD.size()) {
+    throw std::runtime_error("cA and cD must have the same length!");
+  }
+  std::vector<double> signal(
+      signalSize == 0 ? idwt_output_size(cA.size(), w) : signalSize);
+  idwt(cA.data(), cD.data(), cA.size(), w, mode, signal.data(),
+       signal.size());
+  return signal;
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a 1-D inverse discrete wavelet transform into a caller provided
+ * buffer. The upsampled coefficients are never formed: each output sample is
+ * the even or the odd taps of the reconstruction filters against
+ * consecutive coefficients.
+ *
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ * @param coeffsSize The length of cA, and of cD.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ * @param signal The reconstructed signal.
+ * @param signalSize The length of the signal, idwt_output_size() or one less.
+ */
+void idwt(const double *cA, const double *cD, size_t coeffsSize,
+          const Wavelet &w, const std::string &mode, double *signal,
+          size_t signalSize) {
+  if (mode != "sym") {
+    throw std::runtime_error("Mode error!");
+  }
+  const size_t outputSize = idwt_output_size(coeffsSize, w);
+  if (signalSize != outputSize && signalSize + 1 != outputSize) {
+    throw std::runtime_error("Signal size does not match the coefficients!");
+  }
+  active_kernels().idwt_synthesis(cA, cD, w.Lo_R, w.Ho_R, w.filterSize,
+                                  signal, 0, signalSize);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a multilevel 1-D inverse discrete wavelet transform.
+ *
+ * @param coeffs The coefficients cA_level, cD_level .. cD_1.
+ * @param lengths The lengths of cD_1 .. cD_level.
+ * @param wavelet_type The wavelet name, see wavelet() for the registry.
+ * @param signalSize The length of the signal, 0 for idwt_output_size().
+ * @return The reconstructed signal.
+ */
+std::vector<double>
+wavelet_reconstruction(const std::vector<double> &coeffs,
+                       const std::vector<double> &lengths,
+                       const std::string wavelet_type, size_t signalSize) {
+  const Wavelet &w = wavelet(wavelet_type);
+  const size_t level = lengths.size();
+
+  // the final cA has the length of cD_level
+  size_t total = level > 0 ? static_cast<size_t>(lengths.back()) : 0;
+  for (double length : lengths) {
+    total += static_cast<size_t>(length);
+  }
+  if (level > 0 ? total != coeffs.size()
+                : signalSize != 0 && signalSize != coeffs.size()) {
+    throw std::runtime_error("Coefficients do not match the lengths!");
+  }
+  if (level == 0) {
+    return coeffs;
+  }
+
+  // cA_i is rebuilt from cA_(i+1) and cD_(i+1) at the length of cD_i
+  std::vector<double> cA(coeffs.begin(), coeffs.begin() + lengths.back());
+  std::vector<double> signal;
+  size_t offset = cA.size();
+  for (size_t i = level; i > 0; --i) {
+    const size_t coeffsSize = static_cast<size_t>(lengths[i - 1]);
+    const size_t outputSize =
+        i > 1 ? static_cast<size_t>(lengths[i - 2])
+              : (signalSize == 0 ? idwt_output_size(coeffsSize, w)
+                                 : signalSize);
+    if (cA.size() != coeffsSize) {
+      throw std::runtime_error("Coefficients do not match the lengths!");
+    }
+    signal.resize(outputSize);
+    idwt(cA.data(), coeffs.data() + offset, coeffsSize, w, "sym",
+         signal.data(), outputSize);
+    offset += coeffsSize;
+    std::swap(cA, signal);
+  }
+  return cA;
+}
+
+//-------------------------------------------------------------
+/**
+ * Plans a multilevel decomposition of signals with signalSize samples.
+ *
+ * @param signalSize The number of samples of the signals.
+ * @param level The decomposition level.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param mode The extension mode, which can be "sym".
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ */
+DwtPlan::DwtPlan(size_t signalSize, size_t level,
+                 const std::string &wavelet_name, const std::string &mode,
+                 DwtStrategy strategy)
+    : DwtPlan(signalSize, level, wavelet(wavelet_name), mode, strategy) {}
+
+//-------------------------------------------------------------
+/**
+ * Plans a multilevel decomposition of signals with signalSize samples.
+ *
+ * @param signalSize The number of samples of the signals.
+ * @param level The decomposition level.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ * @param strategy Whether to run the filter bank or its lifting steps.
+ */
+DwtPlan::DwtPlan(size_t signalSize, size_t level, const Wavelet &w,
+                 const std::string &mode, DwtStrategy strategy)
+    : wavelet_(&w), kernels_(&active_kernels()), lifting_(nullptr),
+      signalSize_(signalSize), outputSize_(0) {
+  if (mode != "sym") {
+    throw std::runtime_error("Mode error!");
+  }
+  outputSize_ = wavedec_output_size(signalSize, level, w);
+
+  size_t inputSize = signalSize;
+  for (size_t i = 0; i < level; ++i) {
+    inputSize = dwt_output_size(inputSize, w);
+    lengths_.push_back(inputSize);
+  }
+  scratch_.resize(decompose_scratch_size(signalSize, level, w));
+
+  if (strategy == DwtStrategy::Lifting && level > 0) {
+    lifting_ = &lifting_scheme(w);
+    liftingWorkspace_.resize(lifting_->workspace_size());
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Decomposes one signal.
+ *
+ * @param signal The input signal, signal_size() samples.
+ * @param coeffs The coefficients, output_size() of them.
+ */
+void DwtPlan::execute(const double *signal, double *coeffs) {
+  decompose(signal, signalSize_, lengths_.size(), outputSize_, *wavelet_,
+            *kernels_, lifting_, coeffs, scratch_.data(),
+            liftingWorkspace_.data());
+}
+
+//-------------------------------------------------------------
+/**
+ * Decomposes one signal.
+ *
+ * @param signal The input signal, signal_size() samples.
+ * @param coeffs The coefficients, resized to output_size().
+ */
+void DwtPlan::execute(const std::vector<double> &signal,
+                      std::vector<double> &coeffs) {
+  if (signal.size() != signalSize_) {
+    throw std::runtime_error("Signal size does not match the plan!");
+  }
+  coeffs.resize(outputSize_);
+  execute(signal.data(), coeffs.data());
+}
+
+//-------------------------------------------------------------
+// The sample types the transforms are built for: float and double, and 16
+// and 32 bit integers, computed in float and in double.
+
+#define CODEWAVELETS_INSTANTIATE_DWT(T)                                        \
+  template std::vector<T> wextend(const std::vector<T> &, int,                 \
+                                  const std::string &);                        \
+  template std::vector<T> downsample(const std::vector<T> &, const size_t,     \
+                                     const size_t);                            \
+  template std::pair<std::vector<dwt_value_t<T>>,                              \
+                     std::vector<dwt_value_t<T>>>                              \
+  dwt(const std::vector<T> &, const std::string, const std::string,            \
+      DwtStrategy);                                                            \
+  template std::pair<std::vector<dwt_value_t<T>>,                              \
+                     std::vector<dwt_value_t<T>>>                              \
+  dwt(const std::vector<T> &, const Wavelet &, const std::string,              \
+      DwtStrategy);                                                            \
+  template void dwt(const T *, size_t, const Wavelet &, const std::string &,    \
+                    dwt_value_t<T> *, dwt_value_t<T> *, DwtStrategy);          \
+  template std::pair<std::vector<dwt_value_t<T>>, std::vector<double>>         \
+  wavelet_decomposition(const std::vector<T> &, const size_t,                  \
+                        const std::string, DwtStrategy);                       \
+  template std::pair<std::vector<dwt_value_t<T>>, std::vector<double>>         \
+  wavelet_decomposition(const std::vector<T> &, const size_t,                  \
+                        const std::string, ThreadPool &, DwtStrategy);         \
+  template void wavelet_decomposition(const T *, size_t, size_t,               \
+                                      const Wavelet &, dwt_value_t<T> *,       \
+                                      DwtStrategy);                            \
+  template void wavelet_decomposition(const T *, size_t, size_t,               \
+                                      const Wavelet &, dwt_value_t<T> *,       \
+                                      ThreadPool &, DwtStrategy);
+
+CODEWAVELETS_INSTANTIATE_DWT(float)
+CODEWAVELETS_INSTANTIATE_DWT(double)
+CODEWAVELETS_INSTANTIATE_DWT(int16_t)
+CODEWAVELETS_INSTANTIATE_DWT(int32_t)
+
+#undef CODEWAVELETS_INSTANTIATE_DWT
+
+template std::vector<float> wconv1(const std::vector<float> &,
+                                   const std::vector<float> &,
+                                   const std::string &);
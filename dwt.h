@@ -1,25 +1,202 @@
 #ifndef dwt_h
 #define dwt_h
 
+#include <cstdint>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-std::vector<double> wextend(const std::vector<double> &input, int extendLen,
-                            const std::string &mode);
+#include "wavelets.h"
 
-std::vector<double> wconv1(const std::vector<double> &input,
-                           const std::vector<double> &wfilters,
-                           const std::string &mode);
+// How dwt() computes the coefficients: with the analysis filter bank, or with
+// the lifting factorization of the same filters, see lifting.h.
+enum class DwtStrategy { FilterBank, Lifting };
 
-std::vector<double> downsample(const std::vector<double> coeffs,
-                               const size_t first, const size_t last);
+// The precision the transforms compute in for samples of type T: float and
+// double compute in their own, integer samples are widened to float up to 16
+// bits and to double above. The transforms below are built for float,
+// double, int16_t and int32_t samples, wconv1() for float and double.
+template <typename T>
+using dwt_value_t = typename std::conditional<
+    std::is_floating_point<T>::value, T,
+    typename std::conditional<(sizeof(T) <= 2), float, double>::type>::type;
 
-std::pair<std::vector<double>, std::vector<double>>
-dwt(const std::vector<double> &signal, const std::string wavelet_name,
-    const std::string mode);
+template <typename T>
+std::vector<T> wextend(const std::vector<T> &input, int extendLen,
+                       const std::string &mode);
+
+// float convolutions are computed in double and rounded
+template <typename T>
+std::vector<T> wconv1(const std::vector<T> &input,
+                      const std::vector<T> &wfilters, const std::string &mode);
+
+template <typename T>
+std::vector<T> downsample(const std::vector<T> &coeffs, const size_t first,
+                          const size_t last);
+
+// The lifting strategy needs double precision.
+template <typename T>
+std::pair<std::vector<dwt_value_t<T>>, std::vector<dwt_value_t<T>>>
+dwt(const std::vector<T> &signal, const std::string wavelet_name,
+    const std::string mode, DwtStrategy strategy = DwtStrategy::FilterBank);
+
+template <typename T>
+std::pair<std::vector<dwt_value_t<T>>, std::vector<dwt_value_t<T>>>
+dwt(const std::vector<T> &signal, const Wavelet &w, const std::string mode,
+    DwtStrategy strategy = DwtStrategy::FilterBank);
+
+template <typename T>
+std::pair<std::vector<dwt_value_t<T>>, std::vector<double>>
+wavelet_decomposition(const std::vector<T> &signal, const size_t level,
+                      const std::string wavelet_type,
+                      DwtStrategy strategy = DwtStrategy::FilterBank);
+
+class ThreadPool;
+
+// Same as above with the long levels split over a thread pool: chunks of
+// coefficients are computed in parallel, reading their filter-length halos
+// from the shared input, and come out bit-identical to the serial result.
+// The lifting strategy runs serially. Must not be called from a task of the
+// same pool.
+template <typename T>
+std::pair<std::vector<dwt_value_t<T>>, std::vector<double>>
+wavelet_decomposition(const std::vector<T> &signal, const size_t level,
+                      const std::string wavelet_type, ThreadPool &pool,
+                      DwtStrategy strategy = DwtStrategy::FilterBank);
 
+// Sizes of the outputs below, so that callers can allocate them up front.
+// Both throw like dwt() when the signal is too short for the wavelet.
+size_t dwt_output_size(size_t signalSize, const Wavelet &w);
+
+size_t wavedec_output_size(size_t signalSize, size_t level, const Wavelet &w);
+
+// Same as the vector versions, writing into caller provided buffers: cA and
+// cD of dwt_output_size() each, coeffs of wavedec_output_size(). The cD
+// lengths of a decomposition follow from dwt_output_size() level by level.
+// Intermediate results go to per thread buffers that are reused between
+// calls.
+template <typename T>
+void dwt(const T *signal, size_t signalSize, const Wavelet &w,
+         const std::string &mode, dwt_value_t<T> *cA, dwt_value_t<T> *cD,
+         DwtStrategy strategy = DwtStrategy::FilterBank);
+
+template <typename T>
+void wavelet_decomposition(const T *signal, size_t signalSize, size_t level,
+                           const Wavelet &w, dwt_value_t<T> *coeffs,
+                           DwtStrategy strategy = DwtStrategy::FilterBank);
+
+template <typename T>
+void wavelet_decomposition(const T *signal, size_t signalSize, size_t level,
+                           const Wavelet &w, dwt_value_t<T> *coeffs,
+                           ThreadPool &pool,
+                           DwtStrategy strategy = DwtStrategy::FilterBank);
+
+// How the channels of a batch are stored: planar keeps the samples of a
+// channel together, x[c * signalSize + i], interleaved keeps the channels of
+// a sample together, x[i * channels + c]. The coefficients come out in the
+// same layout, with dwt_output_size() in place of signalSize.
+enum class ChannelLayout { Planar, Interleaved };
+
+// Single level dwt() of channels signals of the same length at once, one
+// vector lane per channel.
 std::pair<std::vector<double>, std::vector<double>>
-wavelet_decomposition(const std::vector<double> &signal, const size_t level,
-                      const std::string wavelet_type);
+dwt_batch(const std::vector<double> &signals, size_t channels,
+          ChannelLayout layout, const std::string wavelet_name,
+          const std::string mode);
+
+void dwt_batch(const double *signals, size_t channels, size_t signalSize,
+               ChannelLayout layout, const Wavelet &w, const std::string &mode,
+               double *cA, double *cD);
+
+// Multilevel decompositions of many independent signals of possibly
+// different lengths, packed back to back: signal i is
+// signals[offsets[i] .. offsets[i + 1]). The signals run as tasks on the
+// pool, longest first, and the coefficients of signal i come out at
+// coeffs[coeffOffsets[i] .. coeffOffsets[i + 1]), laid out as by
+// wavelet_decomposition(). Returns the coefficients and coeffOffsets.
+std::pair<std::vector<double>, std::vector<size_t>>
+wavelet_decomposition_batch(const std::vector<double> &signals,
+                            const std::vector<size_t> &offsets, size_t level,
+                            const std::string wavelet_type,
+                            DwtStrategy strategy = DwtStrategy::FilterBank);
+
+std::pair<std::vector<double>, std::vector<size_t>>
+wavelet_decomposition_batch(const std::vector<double> &signals,
+                            const std::vector<size_t> &offsets, size_t level,
+                            const std::string wavelet_type, ThreadPool &pool,
+                            DwtStrategy strategy = DwtStrategy::FilterBank);
+
+// Single level inverse of dwt(). cA and cD have the same length, and the
+// signal has idwt_output_size() samples, or one less when it had an odd
+// length; signalSize = 0 picks the longer one.
+size_t idwt_output_size(size_t coeffsSize, const Wavelet &w);
+
+std::vector<double> idwt(const std::vector<double> &cA,
+                         const std::vector<double> &cD,
+                         const std::string wavelet_name,
+                         const std::string mode, size_t signalSize = 0);
+
+std::vector<double> idwt(const std::vector<double> &cA,
+                         const std::vector<double> &cD, const Wavelet &w,
+                         const std::string mode, size_t signalSize = 0);
+
+void idwt(const double *cA, const double *cD, size_t coeffsSize,
+          const Wavelet &w, const std::string &mode, double *signal,
+          size_t signalSize);
+
+// Inverse of wavelet_decomposition() (waverec), from its coefficients and cD
+// lengths. The inner levels take their lengths from the cD of the level
+// below, the signal length is chosen like in idwt().
+std::vector<double>
+wavelet_reconstruction(const std::vector<double> &coeffs,
+                       const std::vector<double> &lengths,
+                       const std::string wavelet_type, size_t signalSize = 0);
+
+struct KernelTable;
+class LiftingScheme;
+
+// Multilevel decomposition of signals of one length, set up once and executed
+// many times. The plan resolves the wavelet, the kernels and the sizes of all
+// levels up front and owns the scratch buffers, so execute() does not
+// allocate. The coefficients are laid out as by wavelet_decomposition(),
+// cA_level, cD_level, ..., cD_1.
+class DwtPlan {
+public:
+  DwtPlan(size_t signalSize, size_t level, const std::string &wavelet_name,
+          const std::string &mode = "sym",
+          DwtStrategy strategy = DwtStrategy::FilterBank);
+
+  DwtPlan(size_t signalSize, size_t level, const Wavelet &w,
+          const std::string &mode = "sym",
+          DwtStrategy strategy = DwtStrategy::FilterBank);
+
+  size_t signal_size() const { return signalSize_; }
+
+  size_t level() const { return lengths_.size(); }
+
+  // number of coefficients written by execute()
+  size_t output_size() const { return outputSize_; }
+
+  // lengths of cD_1 .. cD_level
+  const std::vector<size_t> &lengths() const { return lengths_; }
+
+  void execute(const double *signal, double *coeffs);
+
+  // Resizes coeffs to output_size(), which only allocates the first time.
+  void execute(const std::vector<double> &signal, std::vector<double> &coeffs);
+
+private:
+  const Wavelet *wavelet_;
+  const KernelTable *kernels_;
+  // null for the filter bank strategy
+  const LiftingScheme *lifting_;
+  size_t signalSize_;
+  size_t outputSize_;
+  std::vector<size_t> lengths_;
+  // cA of the inner levels
+  std::vector<double> scratch_;
+  std::vector<double> liftingWorkspace_;
+};
 
 #endif /* dwt_h */
\ No newline at end of file
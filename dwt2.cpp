@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "buffers.h"
+#include "dwt.h"
+#include "dwt2.h"
+#include "kernels.h"
+#include "wavelets.h"
+
+// Bytes of the filter window a column strip reads for one output row. The
+// window moves down by two rows per output row, so sized to stay in the L2
+// cache most of each row is read from memory once. Narrower strips measured
+// slower on 4K frames, as more rows are streamed at once.
+static const size_t kStripBytes = 256 * 1024;
+
+// owner of the per thread buffers of this file: 0 for the row pass, 1 for
+// the inner LL of a decomposition
+struct Dwt2Buffers;
+
+//-------------------------------------------------------------
+/**
+ * Computes how many columns a strip of the column pass holds, a multiple of
+ * the widest vector.
+ *
+ * @param filterSize The filter length.
+ * @return The strip width.
+ */
+static size_t column_strip(size_t filterSize) {
+  const size_t strip = kStripBytes / (filterSize * sizeof(double)) / 16 * 16;
+  return std::max(strip, size_t(16));
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the subband sizes of a single level 2-D dwt.
+ *
+ * @param rows The number of rows of the image.
+ * @param cols The number of columns of the image.
+ * @param w The wavelet.
+ * @return The rows and columns of each subband.
+ */
+std::pair<size_t, size_t> dwt2_output_size(size_t rows, size_t cols,
+                                           const Wavelet &w) {
+  return std::make_pair(dwt_output_size(rows, w), dwt_output_size(cols, w));
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a single level 2-D discrete wavelet transform of an image.
+ *
+ * @param image The image, row major.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param mode The extension mode, which can be "sym".
+ * @return The four subbands.
+ */
+Subbands2 dwt2(const std::vector<double> &image, size_t rows, size_t cols,
+               const std::string wavelet_name, const std::string mode) {
+  if (image.size() != rows * cols) {
+    throw std::runtime_error("Image size does not match rows and cols!");
+  }
+  const Wavelet &w = wavelet(wavelet_name);
+  Subbands2 subbands;
+  std::tie(subbands.rows, subbands.cols) = dwt2_output_size(rows, cols, w);
+  const size_t size = subbands.rows * subbands.cols;
+  subbands.LL.resize(size);
+  subbands.LH.resize(size);
+  subbands.HL.resize(size);
+  subbands.HH.resize(size);
+  dwt2(image.data(), rows, cols, w, mode, subbands.LL.data(),
+       subbands.LH.data(), subbands.HL.data(), subbands.HH.data());
+  return subbands;
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a single level 2-D discrete wavelet transform into caller provided
+ * buffers. The row pass filters each row into a low and a high half; the
+ * column pass then runs the interleaved kernel down strips of columns of
+ * both halves, so that the filter windows of a strip stay in the L2 cache
+ * from one output row to the next.
+ *
+ * @param image The image, row major.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ * @param LL The approximation, dwt2_output_size() values.
+ * @param LH The horizontal details.
+ * @param HL The vertical details.
+ * @param HH The diagonal details.
+ */
+void dwt2(const double *image, size_t rows, size_t cols, const Wavelet &w,
+          const std::string &mode, double *LL, double *LH, double *HL,
+          double *HH) {
+  if (mode != "sym") {
+    throw std::runtime_error("Mode error!");
+  }
+  const size_t outRows = dwt_output_size(rows, w);
+  const size_t outCols = dwt_output_size(cols, w);
+  const KernelTable &kernels = active_kernels();
+
+  double *low = thread_buffer<Dwt2Buffers>(0, 2 * rows * outCols);
+  double *high = low + rows * outCols;
+  for (size_t r = 0; r < rows; ++r) {
+    kernels.dwt_analysis(image + r * cols, cols, w.Lo_D, w.Ho_D, w.filterSize,
+                         low + r * outCols, high + r * outCols, 0, outCols);
+  }
+
+  const size_t strip = column_strip(w.filterSize);
+  for (size_t c0 = 0; c0 < outCols; c0 += strip) {
+    const size_t width = std::min(strip, outCols - c0);
+    kernels.dwt_analysis_interleaved(low + c0, rows, width, outCols, w.Lo_D,
+                                     w.Ho_D, w.filterSize, LL + c0, LH + c0,
+                                     0, outRows);
+    kernels.dwt_analysis_interleaved(high + c0, rows, width, outCols, w.Lo_D,
+                                     w.Ho_D, w.filterSize, HL + c0, HH + c0,
+                                     0, outRows);
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the number of coefficients of a multilevel 2-D decomposition.
+ *
+ * @param rows The number of rows of the image.
+ * @param cols The number of columns of the image.
+ * @param level The decomposition level.
+ * @param w The wavelet.
+ * @return The length of the coefficient vector.
+ */
+size_t wavedec2_output_size(size_t rows, size_t cols, size_t level,
+                            const Wavelet &w) {
+  size_t outputSize = 0;
+  for (size_t i = 0; i < level; ++i) {
+    rows = dwt_output_size(rows, w);
+    cols = dwt_output_size(cols, w);
+    outputSize += 3 * rows * cols;
+  }
+  return outputSize + rows * cols;
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a multilevel 2-D discrete wavelet transform of an image.
+ *
+ * @param image The image, row major.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @param level The decomposition level.
+ * @param wavelet_type The wavelet name, see wavelet() for the registry.
+ * @return The coefficients and the subband sizes of every level.
+ */
+std::pair<std::vector<double>, std::vector<size_t>>
+wavedec2(const std::vector<double> &image, size_t rows, size_t cols,
+         size_t level, const std::string wavelet_type) {
+  if (image.size() != rows * cols) {
+    throw std::runtime_error("Image size does not match rows and cols!");
+  }
+  const Wavelet &w = wavelet(wavelet_type);
+  std::vector<double> coeffs(wavedec2_output_size(rows, cols, level, w));
+
+  std::vector<size_t> sizes;
+  sizes.reserve(2 * level);
+  size_t r = rows;
+  size_t c = cols;
+  for (size_t i = 0; i < level; ++i) {
+    r = dwt_output_size(r, w);
+    c = dwt_output_size(c, w);
+    sizes.push_back(r);
+    sizes.push_back(c);
+  }
+
+  wavedec2(image.data(), rows, cols, level, w, coeffs.data());
+  return std::make_pair(std::move(coeffs), std::move(sizes));
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a multilevel 2-D discrete wavelet transform into a caller provided
+ * buffer. The details of each level go straight to their place, the inner LL
+ * alternate between the two halves of a per thread buffer and the last one
+ * goes to the front.
+ *
+ * @param image The image, row major.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @param level The decomposition level.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param coeffs The coefficients, wavedec2_output_size() of them.
+ */
+void wavedec2(const double *image, size_t rows, size_t cols, size_t level,
+              const Wavelet &w, double *coeffs) {
+  size_t offset = wavedec2_output_size(rows, cols, level, w);
+  if (level == 0) {
+    std::copy(image, image + rows * cols, coeffs);
+    return;
+  }
+
+  const size_t firstSize = dwt_output_size(rows, w) * dwt_output_size(cols, w);
+  double *scratch =
+      thread_buffer<Dwt2Buffers>(1, level > 1 ? 2 * firstSize : 0);
+  const double *input = image;
+  for (size_t i = 0; i < level; ++i) {
+    const size_t outRows = dwt_output_size(rows, w);
+    const size_t outCols = dwt_output_size(cols, w);
+    const size_t size = outRows * outCols;
+    offset -= 3 * size;
+    double *LL = i + 1 == level ? coeffs : scratch + (i % 2) * firstSize;
+    dwt2(input, rows, cols, w, "sym", LL, coeffs + offset,
+         coeffs + offset + size, coeffs + offset + 2 * size);
+    input = LL;
+    rows = outRows;
+    cols = outCols;
+  }
+}
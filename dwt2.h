@@ -0,0 +1,58 @@
+#ifndef dwt2_h
+#define dwt2_h
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wavelets.h"
+
+// Subbands of a single level 2-D dwt, each rows x cols in row major order.
+// The first letter is the filter along the rows of the image, the second the
+// one along its columns: LL is the approximation, LH the horizontal, HL the
+// vertical and HH the diagonal details.
+struct Subbands2 {
+  size_t rows;
+  size_t cols;
+  std::vector<double> LL;
+  std::vector<double> LH;
+  std::vector<double> HL;
+  std::vector<double> HH;
+};
+
+// Rows and columns of each subband of dwt2() on a rows x cols image.
+std::pair<size_t, size_t> dwt2_output_size(size_t rows, size_t cols,
+                                           const Wavelet &w);
+
+// Single level 2-D "sym" dwt of a row major image: dwt() along every row,
+// then along every column of both results. The columns are transformed in
+// strips whose filter windows fit the L2 cache, one column per vector lane,
+// so the image is never transposed.
+Subbands2 dwt2(const std::vector<double> &image, size_t rows, size_t cols,
+               const std::string wavelet_name, const std::string mode);
+
+// Same, writing each subband to a caller provided buffer of
+// dwt2_output_size(). The row pass goes to a per thread buffer that is reused
+// between calls.
+void dwt2(const double *image, size_t rows, size_t cols, const Wavelet &w,
+          const std::string &mode, double *LL, double *LH, double *HL,
+          double *HH);
+
+// Number of coefficients of wavedec2().
+size_t wavedec2_output_size(size_t rows, size_t cols, size_t level,
+                            const Wavelet &w);
+
+// Multilevel 2-D dwt, repeating dwt2() on LL. The coefficients are laid out
+// as LL_level, LH_level, HL_level, HH_level, ..., LH_1, HL_1, HH_1, and the
+// sizes of the subbands of each level are rows_1, cols_1, ..., rows_level,
+// cols_level.
+std::pair<std::vector<double>, std::vector<size_t>>
+wavedec2(const std::vector<double> &image, size_t rows, size_t cols,
+         size_t level, const std::string wavelet_type);
+
+// Same, into a caller provided buffer of wavedec2_output_size().
+void wavedec2(const double *image, size_t rows, size_t cols, size_t level,
+              const Wavelet &w, double *coeffs);
+
+#endif /* dwt2_h */
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffers.h"
+#include "dwt.h"
+#include "dwt2.h"
+#include "dwt3.h"
+#include "kernels.h"
+#include "threadpool.h"
+#include "wavelets.h"
+
+// Bytes of one tile of the slab, the planes of a run of plane positions that
+// the axis 0 pass filters in one go. Sized like the column strips of dwt2()
+// so that the filter windows stay in the L2 cache.
+static const size_t kTileBytes = 256 * 1024;
+
+// Output planes along axis 0 computed per pass over the slab, at least. More
+// planes per pass mean fewer batches on the pool but a larger slab.
+static const size_t kPassPlanes = 8;
+
+// subband of dwt3() that the lowpass along axis 0 of each dwt2() subband
+// LL, LH, HL, HH goes to; the highpass goes four further
+static const size_t kPlaneBand[4] = {0, 2, 1, 3};
+
+// owner of the per thread buffers of this file: 0 for the subbands of one
+// plane, 1 for the axis 0 outputs of one tile
+struct Dwt3Buffers;
+
+//-------------------------------------------------------------
+/**
+ * Computes how many plane positions a tile of the slab holds, a multiple of
+ * the widest vector.
+ *
+ * @param slabPlanes The number of planes in the slab.
+ * @return The tile width.
+ */
+static size_t tile_width(size_t slabPlanes) {
+  const size_t width = kTileBytes / (slabPlanes * sizeof(double)) / 16 * 16;
+  return std::max(width, size_t(16));
+}
+
+//-------------------------------------------------------------
+/**
+ * Maps a plane of the volume extended by the "sym" reflection to the plane
+ * it copies, as the kernels do for samples.
+ *
+ * @param n0 The number of planes.
+ * @param index The extended plane, at most n0 away from the volume.
+ * @return The plane of the volume.
+ */
+static size_t sym_plane(size_t n0, std::ptrdiff_t index) {
+  if (index < 0) {
+    return -index - 1;
+  }
+  if (index >= std::ptrdiff_t(n0)) {
+    return 2 * n0 - index - 1;
+  }
+  return index;
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a single level 3-D dwt into the eight subbands. The output planes
+ * along axis 0 are made in passes of a few: the planes they read, from
+ * 2 k0 + 2 - filterSize on, are transformed with dwt2() in parallel into the
+ * slab, and then the interleaved kernel filters each tile of the slab down
+ * axis 0 in parallel. A pass keeps the last filterSize - 2 planes of the slab
+ * for the next one, so no plane is transformed twice.
+ *
+ * The slab holds each dwt2() subband as tiles of its plane positions, every
+ * tile a contiguous block of the slab planes, so that the kernel reads it as
+ * interleaved channels. It is freed on return, as it spans 2 pass + L - 2
+ * planes of the volume. The kernel only runs on the interior outputs of the
+ * slab and writes them at their index, hence the staging buffer.
+ *
+ * @param volume The volume.
+ * @param n0 The number of planes.
+ * @param n1 The number of rows of a plane.
+ * @param n2 The number of columns of a plane.
+ * @param w The wavelet.
+ * @param subbands The eight subbands, dwt3_output_size() values each.
+ * @param pool The threads to run on.
+ */
+static void transform3(const double *volume, size_t n0, size_t n1, size_t n2,
+                       const Wavelet &w, double *const subbands[8],
+                       ThreadPool &pool) {
+  const size_t L = w.filterSize;
+  const size_t o0 = dwt_output_size(n0, w);
+  const size_t plane = dwt_output_size(n1, w) * dwt_output_size(n2, w);
+  const KernelTable &kernels = active_kernels();
+
+  // enough planes per pass to keep every thread busy with dwt2()
+  const size_t pass = std::max(kPassPlanes, (pool.size() + 1) / 2);
+  const size_t capacity = 2 * pass + L - 2;
+  const size_t width = tile_width(capacity);
+  const size_t tiles = (plane + width - 1) / width;
+  const size_t tileSize = capacity * width;
+  std::vector<double> slabBuffer(4 * tiles * tileSize);
+  double *slab = slabBuffer.data();
+  // first interior output of the slab
+  const size_t lead = L / 2 - 1;
+
+  std::vector<size_t> planeTasks;
+  planeTasks.reserve(capacity);
+  std::vector<size_t> tileTasks(4 * tiles);
+  std::iota(tileTasks.begin(), tileTasks.end(), size_t(0));
+
+  size_t kept = 0;
+  for (size_t k0 = 0; k0 < o0; k0 += pass) {
+    const size_t count = std::min(pass, o0 - k0);
+    const size_t planes = 2 * count + L - 2;
+    const std::ptrdiff_t start = std::ptrdiff_t(2 * k0 + 2) - std::ptrdiff_t(L);
+
+    planeTasks.clear();
+    for (size_t q = kept; q < planes; ++q) {
+      planeTasks.push_back(q);
+    }
+    pool.run(planeTasks, [&](size_t q) {
+      double *bands = thread_buffer<Dwt3Buffers>(0, 4 * plane);
+      const size_t p = sym_plane(n0, start + std::ptrdiff_t(q));
+      dwt2(volume + p * n1 * n2, n1, n2, w, "sym", bands, bands + plane,
+           bands + 2 * plane, bands + 3 * plane);
+      for (size_t s = 0; s < 4; ++s) {
+        for (size_t t = 0; t < tiles; ++t) {
+          const size_t c0 = t * width;
+          const size_t size = std::min(width, plane - c0);
+          const double *from = bands + s * plane + c0;
+          std::copy(from, from + size,
+                    slab + (s * tiles + t) * tileSize + q * width);
+        }
+      }
+    });
+
+    pool.run(tileTasks, [&](size_t task) {
+      const size_t s = task / tiles;
+      const size_t c0 = task % tiles * width;
+      const size_t size = std::min(width, plane - c0);
+      double *tile = slab + task * tileSize;
+      double *stageA = thread_buffer<Dwt3Buffers>(1, 2 * (lead + pass) * width);
+      double *stageD = stageA + (lead + pass) * width;
+      kernels.dwt_analysis_interleaved(tile, planes, size, width, w.Lo_D,
+                                       w.Ho_D, L, stageA, stageD, lead,
+                                       lead + count);
+      double *low = subbands[kPlaneBand[s]] + k0 * plane + c0;
+      double *high = subbands[kPlaneBand[s] + 4] + k0 * plane + c0;
+      for (size_t k = 0; k < count; ++k) {
+        const double *a = stageA + (lead + k) * width;
+        const double *d = stageD + (lead + k) * width;
+        std::copy(a, a + size, low + k * plane);
+        std::copy(d, d + size, high + k * plane);
+      }
+      std::copy(tile + 2 * count * width, tile + planes * width, tile);
+    });
+    kept = L - 2;
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the subband size of a single level 3-D dwt.
+ *
+ * @param n0 The number of planes of the volume.
+ * @param n1 The number of rows of a plane.
+ * @param n2 The number of columns of a plane.
+ * @param w The wavelet.
+ * @return The number of coefficients in each subband.
+ */
+size_t dwt3_output_size(size_t n0, size_t n1, size_t n2, const Wavelet &w) {
+  return dwt_output_size(n0, w) * dwt_output_size(n1, w) *
+         dwt_output_size(n2, w);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a single level 3-D discrete wavelet transform of a volume on the
+ * default thread pool.
+ *
+ * @param volume The volume, n0 x n1 x n2 with the last index fastest.
+ * @param n0 The number of planes.
+ * @param n1 The number of rows of a plane.
+ * @param n2 The number of columns of a plane.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param mode The extension mode, which can be "sym".
+ * @return The eight subbands, aaa to ddd.
+ */
+std::vector<double> dwt3(const std::vector<double> &volume, size_t n0,
+                         size_t n1, size_t n2, const std::string wavelet_name,
+                         const std::string mode) {
+  if (volume.size() != n0 * n1 * n2) {
+    throw std::runtime_error("Volume size does not match n0, n1 and n2!");
+  }
+  const Wavelet &w = wavelet(wavelet_name);
+  std::vector<double> coeffs(8 * dwt3_output_size(n0, n1, n2, w));
+  dwt3(volume.data(), n0, n1, n2, w, mode, coeffs.data(),
+       default_thread_pool());
+  return coeffs;
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a single level 3-D discrete wavelet transform into a caller
+ * provided buffer. Apart from the output, it needs a slab of about
+ * 2 * kPassPlanes + filterSize planes of the volume, or twice the threads of
+ * the pool when that is more, and per thread the subbands of one plane.
+ *
+ * @param volume The volume, n0 x n1 x n2 with the last index fastest.
+ * @param n0 The number of planes.
+ * @param n1 The number of rows of a plane.
+ * @param n2 The number of columns of a plane.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ * @param coeffs The eight subbands, 8 * dwt3_output_size() values.
+ * @param pool The threads to run on.
+ */
+void dwt3(const double *volume, size_t n0, size_t n1, size_t n2,
+          const Wavelet &w, const std::string &mode, double *coeffs,
+          ThreadPool &pool) {
+  if (mode != "sym") {
+    throw std::runtime_error("Mode error!");
+  }
+  const size_t size = dwt3_output_size(n0, n1, n2, w);
+  double *subbands[8];
+  for (size_t s = 0; s < 8; ++s) {
+    subbands[s] = coeffs + s * size;
+  }
+  transform3(volume, n0, n1, n2, w, subbands, pool);
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the number of coefficients of a multilevel 3-D decomposition.
+ *
+ * @param n0 The number of planes of the volume.
+ * @param n1 The number of rows of a plane.
+ * @param n2 The number of columns of a plane.
+ * @param level The decomposition level.
+ * @param w The wavelet.
+ * @return The length of the coefficient vector.
+ */
+size_t wavedec3_output_size(size_t n0, size_t n1, size_t n2, size_t level,
+                            const Wavelet &w) {
+  size_t outputSize = 0;
+  for (size_t i = 0; i < level; ++i) {
+    n0 = dwt_output_size(n0, w);
+    n1 = dwt_output_size(n1, w);
+    n2 = dwt_output_size(n2, w);
+    outputSize += 7 * n0 * n1 * n2;
+  }
+  return outputSize + n0 * n1 * n2;
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a multilevel 3-D discrete wavelet transform of a volume on the
+ * default thread pool.
+ *
+ * @param volume The volume, n0 x n1 x n2 with the last index fastest.
+ * @param n0 The number of planes.
+ * @param n1 The number of rows of a plane.
+ * @param n2 The number of columns of a plane.
+ * @param level The decomposition level.
+ * @param wavelet_type The wavelet name, see wavelet() for the registry.
+ * @return The coefficients and the subband extents of every level.
+ */
+std::pair<std::vector<double>, std::vector<size_t>>
+wavedec3(const std::vector<double> &volume, size_t n0, size_t n1, size_t n2,
+         size_t level, const std::string wavelet_type) {
+  if (volume.size() != n0 * n1 * n2) {
+    throw std::runtime_error("Volume size does not match n0, n1 and n2!");
+  }
+  const Wavelet &w = wavelet(wavelet_type);
+  std::vector<double> coeffs(wavedec3_output_size(n0, n1, n2, level, w));
+
+  std::vector<size_t> sizes;
+  sizes.reserve(3 * level);
+  size_t m0 = n0;
+  size_t m1 = n1;
+  size_t m2 = n2;
+  for (size_t i = 0; i < level; ++i) {
+    m0 = dwt_output_size(m0, w);
+    m1 = dwt_output_size(m1, w);
+    m2 = dwt_output_size(m2, w);
+    sizes.push_back(m0);
+    sizes.push_back(m1);
+    sizes.push_back(m2);
+  }
+
+  wavedec3(volume.data(), n0, n1, n2, level, w, coeffs.data(),
+           default_thread_pool());
+  return std::make_pair(std::move(coeffs), std::move(sizes));
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a multilevel 3-D discrete wavelet transform into a caller provided
+ * buffer. The details of each level go straight to their place and the last
+ * aaa goes to the front. The inner aaa of odd levels go to the start of a
+ * scratch buffer and those of even levels after the aaa of level 1, which
+ * is at least 8 times as large as that of level 2, so the buffer holds the
+ * aaa of levels 1 and 2. It is freed on return.
+ *
+ * @param volume The volume, n0 x n1 x n2 with the last index fastest.
+ * @param n0 The number of planes.
+ * @param n1 The number of rows of a plane.
+ * @param n2 The number of columns of a plane.
+ * @param level The decomposition level.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param coeffs The coefficients, wavedec3_output_size() of them.
+ * @param pool The threads to run on.
+ */
+void wavedec3(const double *volume, size_t n0, size_t n1, size_t n2,
+              size_t level, const Wavelet &w, double *coeffs,
+              ThreadPool &pool) {
+  size_t offset = wavedec3_output_size(n0, n1, n2, level, w);
+  if (level == 0) {
+    std::copy(volume, volume + n0 * n1 * n2, coeffs);
+    return;
+  }
+
+  const size_t firstSize = dwt3_output_size(n0, n1, n2, w);
+  // the aaa of level 2 is only kept when a level 3 reads it
+  const size_t secondSize =
+      level > 2 ? dwt3_output_size(dwt_output_size(n0, w),
+                                   dwt_output_size(n1, w),
+                                   dwt_output_size(n2, w), w)
+                : 0;
+  std::vector<double> scratch(level > 1 ? firstSize + secondSize : 0);
+  const double *input = volume;
+  for (size_t i = 0; i < level; ++i) {
+    const size_t size = dwt3_output_size(n0, n1, n2, w);
+    offset -= 7 * size;
+    double *subbands[8];
+    subbands[0] = i + 1 == level ? coeffs
+                                 : scratch.data() + (i % 2) * firstSize;
+    for (size_t s = 1; s < 8; ++s) {
+      subbands[s] = coeffs + offset + (s - 1) * size;
+    }
+    transform3(input, n0, n1, n2, w, subbands, pool);
+    input = subbands[0];
+    n0 = dwt_output_size(n0, w);
+    n1 = dwt_output_size(n1, w);
+    n2 = dwt_output_size(n2, w);
+  }
+}
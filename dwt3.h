@@ -0,0 +1,59 @@
+#ifndef dwt3_h
+#define dwt3_h
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wavelets.h"
+
+class ThreadPool;
+
+// Volumes are n0 x n1 x n2 arrays with the last index running fastest. The
+// eight subbands of a single level 3-D dwt are named by the filter along
+// axes 0, 1 and 2, a for lowpass and d for highpass, and stored one after
+// the other in the order aaa, aad, ada, add, daa, dad, dda, ddd: subband s
+// holds the highpass of axis i when bit 2 - i of s is set.
+
+// Number of coefficients in each subband of dwt3(), the product of the
+// dwt_output_size() of the three extents.
+size_t dwt3_output_size(size_t n0, size_t n1, size_t n2, const Wavelet &w);
+
+// Single level 3-D "sym" dwt, separable along the three axes. The volume is
+// processed in passes along axis 0: the planes a pass reads are transformed
+// with dwt2() in parallel into one scratch slab, which is then filtered down
+// axis 0 in parallel tiles, one plane position per vector lane. No full
+// volume temporaries are made: besides the output, a call holds the slab,
+// 2 p + filterSize - 2 planes of the volume with p = max(8, (threads + 1) / 2),
+// which is freed on return, and each thread of the pool keeps one plane for
+// its dwt2() subbands between calls.
+std::vector<double> dwt3(const std::vector<double> &volume, size_t n0,
+                         size_t n1, size_t n2, const std::string wavelet_name,
+                         const std::string mode);
+
+// Same, into a caller provided buffer of 8 * dwt3_output_size().
+void dwt3(const double *volume, size_t n0, size_t n1, size_t n2,
+          const Wavelet &w, const std::string &mode, double *coeffs,
+          ThreadPool &pool);
+
+// Number of coefficients of wavedec3().
+size_t wavedec3_output_size(size_t n0, size_t n1, size_t n2, size_t level,
+                            const Wavelet &w);
+
+// Multilevel 3-D dwt, repeating dwt3() on aaa. The coefficients are laid out
+// as aaa_level, the seven other subbands of level, ..., the seven of level 1,
+// and the extents of the subbands of each level are n0_1, n1_1, n2_1, ...,
+// n0_level, n1_level, n2_level. On top of the footprint of dwt3() for the
+// first level, the inner aaa of levels 1 and 2 are kept in a scratch buffer
+// of about 9 / 64 of the volume, freed on return.
+std::pair<std::vector<double>, std::vector<size_t>>
+wavedec3(const std::vector<double> &volume, size_t n0, size_t n1, size_t n2,
+         size_t level, const std::string wavelet_type);
+
+// Same, into a caller provided buffer of wavedec3_output_size().
+void wavedec3(const double *volume, size_t n0, size_t n1, size_t n2,
+              size_t level, const Wavelet &w, double *coeffs,
+              ThreadPool &pool);
+
+#endif /* dwt3_h */
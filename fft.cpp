@@ -0,0 +1,429 @@
+/*
+ * The mixed radix transform below (the radix 2 to 5 butterflies, the generic
+ * butterfly, the factorization and the recursive stages) is adapted from
+ * KISS FFT by Mark Borgerding, https://github.com/mborgerding/kissfft,
+ * under the following license.
+ *
+ * Copyright (c) 2003-2010, Mark Borgerding
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the author nor the names of any contributors may be used to
+ *       endorse or promote products derived from this software without
+ *       specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "fft.h"
+
+typedef std::complex<double> Complex;
+
+static const double kPi = 3.14159265358979323846;
+
+/**
+ * Multiplies two complex numbers without the inf/nan recovery of the
+ * standard operator, which otherwise turns every product into a libgcc call.
+ */
+static inline Complex cmul(const Complex &a, const Complex &b) {
+  return Complex(a.real() * b.real() - a.imag() * b.imag(),
+                 a.real() * b.imag() + a.imag() * b.real());
+}
+
+//-------------------------------------------------------------
+// butterflies, one per radix. F points at the p * m outputs of a stage and
+// tw holds the stage's twiddles, the p - 1 factors of output k contiguous.
+
+static void butterfly2(Complex *F, size_t m, const Complex *tw) {
+  for (size_t k = 0; k < m; ++k) {
+    const Complex t = cmul(F[k + m], tw[k]);
+    F[k + m] = F[k] - t;
+    F[k] += t;
+  }
+}
+
+static void butterfly3(Complex *F, size_t m, const Complex *tw, bool inverse) {
+  // imaginary part of exp(-+2 pi i / 3)
+  const double epi3 = inverse ? std::sqrt(0.75) : -std::sqrt(0.75);
+  for (size_t k = 0; k < m; ++k) {
+    const Complex s1 = cmul(F[k + m], tw[2 * k]);
+    const Complex s2 = cmul(F[k + 2 * m], tw[2 * k + 1]);
+    const Complex s3 = s1 + s2;
+    const Complex s0 = (s1 - s2) * epi3;
+    const Complex mid = F[k] - s3 * 0.5;
+    F[k] += s3;
+    F[k + m] = Complex(mid.real() - s0.imag(), mid.imag() + s0.real());
+    F[k + 2 * m] = Complex(mid.real() + s0.imag(), mid.imag() - s0.real());
+  }
+}
+
+static void butterfly4(Complex *F, size_t m, const Complex *tw, bool inverse) {
+  for (size_t k = 0; k < m; ++k) {
+    const Complex s0 = cmul(F[k + m], tw[3 * k]);
+    const Complex s1 = cmul(F[k + 2 * m], tw[3 * k + 1]);
+    const Complex s2 = cmul(F[k + 3 * m], tw[3 * k + 2]);
+    const Complex s5 = F[k] - s1;
+    const Complex f0 = F[k] + s1;
+    const Complex s3 = s0 + s2;
+    const Complex s4 = s0 - s2;
+    F[k] = f0 + s3;
+    F[k + 2 * m] = f0 - s3;
+    if (inverse) {
+      F[k + m] = Complex(s5.real() - s4.imag(), s5.imag() + s4.real());
+      F[k + 3 * m] = Complex(s5.real() + s4.imag(), s5.imag() - s4.real());
+    } else {
+      F[k + m] = Complex(s5.real() + s4.imag(), s5.imag() - s4.real());
+      F[k + 3 * m] = Complex(s5.real() - s4.imag(), s5.imag() + s4.real());
+    }
+  }
+}
+
+static void butterfly5(Complex *F, size_t m, const Complex *tw, bool inverse) {
+  // exp(-+2 pi i / 5) and exp(-+4 pi i / 5)
+  const double sign = inverse ? 1.0 : -1.0;
+  const Complex ya(std::cos(2.0 * kPi / 5), sign * std::sin(2.0 * kPi / 5));
+  const Complex yb(std::cos(4.0 * kPi / 5), sign * std::sin(4.0 * kPi / 5));
+  for (size_t k = 0; k < m; ++k) {
+    const Complex s0 = F[k];
+    const Complex s1 = cmul(F[k + m], tw[4 * k]);
+    const Complex s2 = cmul(F[k + 2 * m], tw[4 * k + 1]);
+    const Complex s3 = cmul(F[k + 3 * m], tw[4 * k + 2]);
+    const Complex s4 = cmul(F[k + 4 * m], tw[4 * k + 3]);
+    const Complex s7 = s1 + s4;
+    const Complex s10 = s1 - s4;
+    const Complex s8 = s2 + s3;
+    const Complex s9 = s2 - s3;
+
+    F[k] = s0 + s7 + s8;
+
+    const Complex s5(s0.real() + s7.real() * ya.real() + s8.real() * yb.real(),
+                     s0.imag() + s7.imag() * ya.real() + s8.imag() * yb.real());
+    const Complex s6(s10.imag() * ya.imag() + s9.imag() * yb.imag(),
+                     -s10.real() * ya.imag() - s9.real() * yb.imag());
+    F[k + m] = s5 - s6;
+    F[k + 4 * m] = s5 + s6;
+
+    const Complex s11(s0.real() + s7.real() * yb.real() + s8.real() * ya.real(),
+                      s0.imag() + s7.imag() * yb.real() + s8.imag() * ya.real());
+    const Complex s12(-s10.imag() * yb.imag() + s9.imag() * ya.imag(),
+                      s10.real() * yb.imag() - s9.real() * ya.imag());
+    F[k + 2 * m] = s11 + s12;
+    F[k + 3 * m] = s11 - s12;
+  }
+}
+
+// The generic butterfly indexes the full size-N table, since its twiddle
+// index q * k * fstride wraps around N.
+static void butterfly_generic(Complex *F, size_t fstride, size_t p, size_t m,
+                              size_t size, const Complex *twiddles) {
+  Complex stackScratch[16];
+  std::vector<Complex> heapScratch;
+  Complex *scratch = stackScratch;
+  if (p > 16) {
+    heapScratch.resize(p);
+    scratch = heapScratch.data();
+  }
+  for (size_t u = 0; u < m; ++u) {
+    for (size_t q1 = 0; q1 < p; ++q1) {
+      scratch[q1] = F[u + q1 * m];
+    }
+    for (size_t q1 = 0; q1 < p; ++q1) {
+      const size_t k = u + q1 * m;
+      size_t twiddle = 0;
+      Complex acc = scratch[0];
+      for (size_t q = 1; q < p; ++q) {
+        twiddle += fstride * k;
+        if (twiddle >= size) {
+          twiddle -= size;
+        }
+        acc += cmul(scratch[q], twiddles[twiddle]);
+      }
+      F[k] = acc;
+    }
+  }
+}
+
+//-------------------------------------------------------------
+
+/**
+ * Builds an FFT plan: factors the size into radices and precomputes the
+ * twiddle factors of both directions.
+ *
+ * @param size The transform length.
+ */
+FftPlan::FftPlan(size_t size) : size_(size) {
+  if (size == 0) {
+    throw std::runtime_error("FFT size must be positive!");
+  }
+
+  // radix 4 first, then 2, then odd factors
+  size_t n = size;
+  size_t p = 4;
+  while (n > 1) {
+    while (n % p != 0) {
+      if (p == 4) {
+        p = 2;
+      } else if (p == 2) {
+        p = 3;
+      } else {
+        p += 2;
+      }
+      if (p * p > n) {
+        p = n;
+      }
+    }
+    n /= p;
+    factors_.push_back(p);
+    factors_.push_back(n);
+  }
+  if (factors_.empty()) {
+    factors_.push_back(1);
+    factors_.push_back(1);
+  }
+
+  forwardTwiddles_.resize(size);
+  inverseTwiddles_.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    const double phase = -2.0 * kPi * static_cast<double>(i) / size;
+    forwardTwiddles_[i] = Complex(std::cos(phase), std::sin(phase));
+    inverseTwiddles_[i] = std::conj(forwardTwiddles_[i]);
+  }
+
+  // copy each stage's twiddles into a contiguous run, so the butterflies
+  // walk them sequentially instead of with a stride of fstride
+  size_t fstride = 1;
+  for (size_t stage = 0; stage < factors_.size() / 2; ++stage) {
+    const size_t radix = factors_[2 * stage];
+    const size_t m = factors_[2 * stage + 1];
+    stageOffsets_.push_back(forwardStageTwiddles_.size());
+    for (size_t k = 0; k < m; ++k) {
+      for (size_t q = 1; q < radix && radix <= 5; ++q) {
+        forwardStageTwiddles_.push_back(forwardTwiddles_[q * k * fstride]);
+        inverseStageTwiddles_.push_back(inverseTwiddles_[q * k * fstride]);
+      }
+    }
+    fstride *= radix;
+  }
+}
+
+/**
+ * One decimation-in-time stage: transforms the p interleaved sub-sequences
+ * recursively, then combines them with the stage's butterflies.
+ *
+ * @param input The stage input, read with inputStride.
+ * @param output The p * m contiguous stage outputs.
+ * @param inputStride The distance between consecutive stage inputs.
+ * @param stage The index into factors_.
+ * @param inverse Whether to use the inverse transform's twiddles.
+ */
+void FftPlan::transform(const Complex *input, Complex *output,
+                        size_t inputStride, size_t stage,
+                        bool inverse) const {
+  const Complex *twiddles =
+      inverse ? inverseTwiddles_.data() : forwardTwiddles_.data();
+  const Complex *stageTwiddles =
+      (inverse ? inverseStageTwiddles_.data() : forwardStageTwiddles_.data()) +
+      stageOffsets_[stage];
+  const size_t p = factors_[2 * stage];
+  const size_t m = factors_[2 * stage + 1];
+
+  if (m == 1) {
+    for (size_t k = 0; k < p; ++k) {
+      output[k] = input[k * inputStride];
+    }
+  } else {
+    for (size_t k = 0; k < p; ++k) {
+      transform(input + k * inputStride, output + k * m, inputStride * p,
+                stage + 1, inverse);
+    }
+  }
+
+  switch (p) {
+  case 1:
+    break;
+  case 2:
+    butterfly2(output, m, stageTwiddles);
+    break;
+  case 3:
+    butterfly3(output, m, stageTwiddles, inverse);
+    break;
+  case 4:
+    butterfly4(output, m, stageTwiddles, inverse);
+    break;
+  case 5:
+    butterfly5(output, m, stageTwiddles, inverse);
+    break;
+  default:
+    butterfly_generic(output, inputStride, p, m, size_, twiddles);
+    break;
+  }
+}
+
+/**
+ * Computes the forward transform X[k] = sum_n x[n] exp(-2 pi i k n / N).
+ *
+ * @param input The size() input values.
+ * @param output The size() output values, must not alias input.
+ */
+void FftPlan::forward(const Complex *input, Complex *output) const {
+  if (input == output) {
+    throw std::runtime_error("FFT input and output must not alias!");
+  }
+  transform(input, output, 1, 0, false);
+}
+
+/**
+ * Computes the inverse transform, scaled by 1 / N so that it undoes forward.
+ *
+ * @param input The size() input values.
+ * @param output The size() output values, must not alias input.
+ */
+void FftPlan::inverse(const Complex *input, Complex *output) const {
+  if (input == output) {
+    throw std::runtime_error("FFT input and output must not alias!");
+  }
+  transform(input, output, 1, 0, true);
+  const double scale = 1.0 / size_;
+  for (size_t i = 0; i < size_; ++i) {
+    output[i] *= scale;
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Finds the smallest size not below the requested one whose only prime
+ * factors are 2, 3 and 5.
+ *
+ * @param size The minimum size.
+ * @return The FFT friendly size.
+ */
+size_t next_fast_fft_size(size_t size) {
+  if (size <= 1) {
+    return 1;
+  }
+  for (size_t candidate = size;; ++candidate) {
+    size_t n = candidate;
+    for (size_t p : {2, 3, 5}) {
+      while (n % p == 0) {
+        n /= p;
+      }
+    }
+    if (n == 1) {
+      return candidate;
+    }
+  }
+}
+
+/**
+ * Computes the full convolution of input with filter by overlap-add. The
+ * filter spectrum is computed once; the input is cut into blocks and two real
+ * blocks share each complex transform, one in the real and one in the
+ * imaginary part.
+ *
+ * @param input The input signal.
+ * @param inputSize The input length.
+ * @param filter The filter.
+ * @param filterSize The filter length.
+ * @param output The result, inputSize + filterSize - 1 values.
+ */
+void fft_conv_full(const double *input, size_t inputSize, const double *filter,
+                   size_t filterSize, double *output) {
+  if (inputSize == 0 || filterSize == 0) {
+    throw std::runtime_error("input or wfilters is empty!");
+  }
+  const size_t outputSize = inputSize + filterSize - 1;
+
+  // pick the power of two block transform with the lowest cost per output,
+  // no larger than what a single block needs
+  size_t fftSize = 1;
+  while (fftSize < 2 * filterSize) {
+    fftSize *= 2;
+  }
+  double bestCost = 0.0;
+  size_t bestSize = fftSize;
+  for (size_t n = fftSize;; n *= 2) {
+    const double cost = n * std::log2(static_cast<double>(n)) /
+                        static_cast<double>(n - filterSize + 1);
+    if (n == fftSize || cost < bestCost) {
+      bestCost = cost;
+      bestSize = n;
+    }
+    if (n >= outputSize) {
+      break;
+    }
+  }
+  fftSize = bestSize;
+  const size_t blockSize = fftSize - filterSize + 1;
+
+  FftPlan plan(fftSize);
+  std::vector<Complex> time(fftSize);
+  std::vector<Complex> spectrum(fftSize);
+  std::vector<Complex> filterSpectrum(fftSize);
+
+  for (size_t i = 0; i < filterSize; ++i) {
+    time[i] = filter[i];
+  }
+  plan.forward(time.data(), filterSpectrum.data());
+
+  for (size_t i = 0; i < outputSize; ++i) {
+    output[i] = 0.0;
+  }
+
+  for (size_t start = 0; start < inputSize; start += 2 * blockSize) {
+    const size_t realSize =
+        inputSize - start < blockSize ? inputSize - start : blockSize;
+    const size_t imagStart = start + realSize;
+    const size_t imagSize = inputSize - imagStart < blockSize
+                                ? inputSize - imagStart
+                                : blockSize;
+
+    for (size_t i = 0; i < fftSize; ++i) {
+      const double re = i < realSize ? input[start + i] : 0.0;
+      const double im = i < imagSize ? input[imagStart + i] : 0.0;
+      time[i] = Complex(re, im);
+    }
+    plan.forward(time.data(), spectrum.data());
+    for (size_t i = 0; i < fftSize; ++i) {
+      spectrum[i] = cmul(spectrum[i], filterSpectrum[i]);
+    }
+    plan.inverse(spectrum.data(), time.data());
+
+    // since the filter is real, the real and imaginary parts are the
+    // convolutions of the two blocks
+    const size_t realEnd = realSize + filterSize - 1;
+    for (size_t i = 0; i < realEnd; ++i) {
+      output[start + i] += time[i].real();
+    }
+    if (imagSize > 0) {
+      const size_t imagEnd = imagSize + filterSize - 1;
+      for (size_t i = 0; i < imagEnd; ++i) {
+        output[imagStart + i] += time[i].imag();
+      }
+    }
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef fft_h
+#define fft_h
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// Mixed-radix complex FFT of a fixed size. Sizes with factors 2, 3 and 5 are
+// fastest; other prime factors fall back to a generic O(p) butterfly.
+class FftPlan {
+public:
+  explicit FftPlan(size_t size);
+
+  size_t size() const { return size_; }
+
+  void forward(const std::complex<double> *input,
+               std::complex<double> *output) const;
+
+  void inverse(const std::complex<double> *input,
+               std::complex<double> *output) const;
+
+private:
+  void transform(const std::complex<double> *input,
+                 std::complex<double> *output, size_t inputStride,
+                 size_t stage, bool inverse) const;
+
+  size_t size_;
+  // (radix, remaining length) pairs, one per stage
+  std::vector<size_t> factors_;
+  std::vector<std::complex<double>> forwardTwiddles_;
+  std::vector<std::complex<double>> inverseTwiddles_;
+  // per stage copies of the radix 2 to 5 twiddles, see FftPlan()
+  std::vector<size_t> stageOffsets_;
+  std::vector<std::complex<double>> forwardStageTwiddles_;
+  std::vector<std::complex<double>> inverseStageTwiddles_;
+};
+
+size_t next_fast_fft_size(size_t size);
+
+void fft_conv_full(const double *input, size_t inputSize, const double *filter,
+                   size_t filterSize, double *output);
+
+#endif /* fft_h */
@@ -0,0 +1,1942 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+#include "kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CODEWAVELETS_X86 1
+#include <immintrin.h>
+#endif
+
+// Every kernel below accumulates each output in the same order (filter taps
+// from first to last input sample), one accumulator per output, so the SIMD
+// variants only differ from the scalar loops by FMA rounding. The FMA
+// variants also use std::fma in their scalar tails, which makes an output
+// independent of whether it landed in a vector block or in a tail.
+
+//-------------------------------------------------------------
+// shared helpers
+
+/**
+ * Reads the signal as if it had been symmetrically extended, mapping indices
+ * left of the first sample or right of the last one back into the signal.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples in the signal.
+ * @param index The (possibly out of range) sample index.
+ * @return The sample of the symmetrically extended signal.
+ */
+template <typename T>
+static inline T sym_sample(const T *signal, std::ptrdiff_t signalSize,
+                           std::ptrdiff_t index) {
+  if (index < 0) {
+    return signal[-index - 1];
+  }
+  if (index >= signalSize) {
+    return signal[2 * signalSize - index - 1];
+  }
+  return signal[index];
+}
+
+/**
+ * Computes one pair of dwt coefficients whose filter window reaches past the
+ * signal boundary.
+ *
+ * @param fused Whether to accumulate with fused multiply-adds.
+ * @param k The coefficient index.
+ */
+template <typename T>
+static void dwt_boundary(const T *signal, size_t signalSize, const T *Lo_D,
+                         const T *Ho_D, size_t filterSize, T *cA, T *cD,
+                         size_t k, bool fused) {
+  const std::ptrdiff_t n = signalSize;
+  const std::ptrdiff_t L = filterSize;
+  const std::ptrdiff_t start = 2 * static_cast<std::ptrdiff_t>(k) + 2 - L;
+  T a = 0;
+  T d = 0;
+  for (std::ptrdiff_t j = 0; j < L; ++j) {
+    const T x = sym_sample(signal, n, start + j);
+    if (fused) {
+      a = std::fma(x, Lo_D[L - j - 1], a);
+      d = std::fma(x, Ho_D[L - j - 1], d);
+    } else {
+      a += x * Lo_D[L - j - 1];
+      d += x * Ho_D[L - j - 1];
+    }
+  }
+  cA[k] = a;
+  cD[k] = d;
+}
+
+/**
+ * Splits the requested dwt outputs [first, last) into the part whose filter
+ * windows lie inside the signal and the boundary parts on either side, and
+ * computes the boundary parts.
+ *
+ * @param interiorFirst Set to the first interior output.
+ * @param interiorLast Set to one past the last interior output.
+ * @param fused Whether to accumulate with fused multiply-adds.
+ */
+template <typename T>
+static void dwt_boundaries(const T *signal, size_t signalSize, const T *Lo_D,
+                           const T *Ho_D, size_t filterSize, T *cA, T *cD,
+                           size_t first, size_t last, size_t &interiorFirst,
+                           size_t &interiorLast, bool fused) {
+  // output k reads samples 2k + 2 - L .. 2k + 1
+  interiorFirst = (filterSize - 1) / 2;
+  interiorLast = signalSize / 2;
+  if (interiorFirst < first) {
+    interiorFirst = first;
+  }
+  if (interiorLast > last) {
+    interiorLast = last;
+  }
+  if (interiorFirst > interiorLast) {
+    interiorFirst = interiorLast;
+  }
+  for (size_t k = first; k < interiorFirst; ++k) {
+    dwt_boundary(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, k, fused);
+  }
+  for (size_t k = interiorLast > first ? interiorLast : first; k < last; ++k) {
+    dwt_boundary(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, k, fused);
+  }
+}
+
+// Interior outputs are computed in blocks from an even and an odd phase copy
+// of the block's input, which turns the stride-2 taps into unit-stride vector
+// loads. Longer filters than kMaxPhaseFilter fall back to the scalar loop.
+static const size_t kPhaseBlock = 256;
+static const size_t kMaxPhaseFilter = 64;
+
+/**
+ * Copies the samples read by the interior outputs [k0, k0 + count) into even
+ * and odd phase buffers, so that tap j of output k0 + q reads
+ * (j even ? even : odd)[q + j / 2].
+ */
+template <typename T>
+static void dwt_split_phases(const T *signal, size_t filterSize, size_t k0,
+                             size_t count, T *even, T *odd) {
+  const T *x = signal + 2 * k0 + 2 - filterSize;
+  const size_t evenCount = count + (filterSize - 1) / 2;
+  const size_t oddCount = filterSize > 1 ? count + (filterSize - 2) / 2 : 0;
+  for (size_t m = 0; m < evenCount; ++m) {
+    even[m] = x[2 * m];
+  }
+  for (size_t m = 0; m < oddCount; ++m) {
+    odd[m] = x[2 * m + 1];
+  }
+}
+
+/**
+ * Scalar fused multiply-add loop over interior outputs of one phase block,
+ * used for the tails of the FMA kernels.
+ */
+template <typename T>
+static void dwt_phase_tail_fma(const T *even, const T *odd, const T *Lo_D,
+                               const T *Ho_D, size_t filterSize, T *cA, T *cD,
+                               size_t q, size_t count) {
+  for (; q < count; ++q) {
+    T a = 0;
+    T d = 0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      const T *phase = (j & 1) ? odd : even;
+      const T x = phase[q + j / 2];
+      a = std::fma(x, Lo_D[filterSize - j - 1], a);
+      d = std::fma(x, Ho_D[filterSize - j - 1], d);
+    }
+    cA[q] = a;
+    cD[q] = d;
+  }
+}
+
+// The synthesis of an even length filter pair needs no extension: output i
+// reads cA and cD at i / 2 .. i / 2 + filterSize / 2 - 1 against the even
+// (odd) taps for even (odd) i, last tap first. The vector kernels compute
+// the even and odd outputs of consecutive coefficients in two registers and
+// interleave them on store.
+
+/**
+ * Scalar fused multiply-add synthesis of outputs [first, last), used for the
+ * heads and tails of the FMA kernels.
+ */
+static void idwt_synthesis_fma(const double *cA, const double *cD,
+                               const double *Lo_R, const double *Ho_R,
+                               size_t filterSize, double *output, size_t first,
+                               size_t last) {
+  for (size_t i = first; i < last; ++i) {
+    const double *a = cA + i / 2;
+    const double *d = cD + i / 2;
+    const size_t tap = filterSize - 2 + (i & 1);
+    double x = 0.0;
+    for (size_t s = 0; s < filterSize / 2; ++s) {
+      x = std::fma(a[s], Lo_R[tap - 2 * s], x);
+      x = std::fma(d[s], Ho_R[tap - 2 * s], x);
+    }
+    output[i] = x;
+  }
+}
+
+// The interleaved kernels run one channel per vector lane: every tap is one
+// broadcast of the filter coefficient against the same sample of a block of
+// channels, and the symmetric extension is resolved once per tap for all of
+// them.
+
+/**
+ * Maps an index of the symmetrically extended signal back into the signal.
+ *
+ * @param signalSize The number of samples in the signal.
+ * @param index The (possibly out of range) sample index.
+ * @return The index of the same sample inside the signal.
+ */
+static inline size_t sym_index(std::ptrdiff_t signalSize,
+                               std::ptrdiff_t index) {
+  if (index < 0) {
+    return -index - 1;
+  }
+  if (index >= signalSize) {
+    return 2 * signalSize - index - 1;
+  }
+  return index;
+}
+
+/**
+ * Computes where the samples read by the taps of dwt output k start in an
+ * interleaved signal, offsets[j] for tap j.
+ */
+static void dwt_tap_offsets(size_t signalSize, size_t stride,
+                            size_t filterSize, size_t k, size_t *offsets) {
+  const std::ptrdiff_t n = signalSize;
+  const std::ptrdiff_t L = filterSize;
+  const std::ptrdiff_t start = 2 * static_cast<std::ptrdiff_t>(k) + 2 - L;
+  for (std::ptrdiff_t j = 0; j < L; ++j) {
+    offsets[j] = sym_index(n, start + j) * stride;
+  }
+}
+
+/**
+ * Scalar fused multiply-add loop over the channels [c, channels) of one
+ * interleaved output, used for the tails of the FMA kernels.
+ */
+static void dwt_interleaved_tail_fma(const double *signal,
+                                     const size_t *offsets, size_t channels,
+                                     const double *Lo_D, const double *Ho_D,
+                                     size_t filterSize, double *a, double *d,
+                                     size_t c) {
+  for (; c < channels; ++c) {
+    double sa = 0.0;
+    double sd = 0.0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double x = signal[offsets[j] + c];
+      sa = std::fma(x, Lo_D[filterSize - j - 1], sa);
+      sd = std::fma(x, Ho_D[filterSize - j - 1], sd);
+    }
+    a[c] = sa;
+    d[c] = sd;
+  }
+}
+
+// The a trous kernels vectorize over consecutive outputs: tap j of outputs
+// i .. i + w - 1 is one unit stride load at i + j * step, so the dilation
+// costs nothing beyond the addressing.
+
+/**
+ * Scalar fused multiply-add a trous analysis of outputs [i, outputSize),
+ * used for the tails of the FMA kernels.
+ */
+static void swt_analysis_tail_fma(const double *signal, size_t outputSize,
+                                  size_t step, const double *Lo_D,
+                                  const double *Ho_D, size_t filterSize,
+                                  double *cA, double *cD, size_t i) {
+  for (; i < outputSize; ++i) {
+    double a = 0.0;
+    double d = 0.0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double x = signal[i + j * step];
+      a = std::fma(x, Lo_D[filterSize - j - 1], a);
+      d = std::fma(x, Ho_D[filterSize - j - 1], d);
+    }
+    cA[i] = a;
+    cD[i] = d;
+  }
+}
+
+/**
+ * Scalar fused multiply-add a trous synthesis of outputs [i, outputSize),
+ * used for the tails of the FMA kernels.
+ */
+static void swt_synthesis_tail_fma(const double *cA, const double *cD,
+                                   size_t outputSize, size_t step,
+                                   const double *Lo_R, const double *Ho_R,
+                                   size_t filterSize, double *output,
+                                   size_t i) {
+  for (; i < outputSize; ++i) {
+    double x = 0.0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      x = std::fma(cA[i + j * step], Lo_R[filterSize - j - 1], x);
+      x = std::fma(cD[i + j * step], Ho_R[filterSize - j - 1], x);
+    }
+    output[i] = x;
+  }
+}
+
+//-------------------------------------------------------------
+// scalar
+
+/**
+ * Scalar "valid" convolution, the reference for the vectorized kernels.
+ *
+ * @param input The input signal.
+ * @param outputSize The number of outputs, inputSize - filterSize + 1.
+ * @param filter The filter, applied reversed.
+ * @param filterSize The filter length.
+ * @param output The convolution result.
+ */
+static void conv_valid_scalar(const double *input, size_t outputSize,
+                              const double *filter, size_t filterSize,
+                              double *output) {
+  for (size_t i = 0; i < outputSize; ++i) {
+    double acc = 0.0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      acc += input[i + j] * filter[filterSize - j - 1];
+    }
+    output[i] = acc;
+  }
+}
+
+/**
+ * Scalar single level dwt, the reference for the vectorized kernels.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples in the signal.
+ * @param Lo_D The low pass decomposition filter.
+ * @param Ho_D The high pass decomposition filter.
+ * @param filterSize The length of both filters.
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ * @param first The first coefficient to compute.
+ * @param last One past the last coefficient to compute.
+ */
+template <typename T>
+static void dwt_analysis_scalar(const T *signal, size_t signalSize,
+                                const T *Lo_D, const T *Ho_D, size_t filterSize,
+                                T *cA, T *cD, size_t first, size_t last) {
+  size_t interiorFirst, interiorLast;
+  dwt_boundaries(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, first,
+                 last, interiorFirst, interiorLast, false);
+  for (size_t k = interiorFirst; k < interiorLast; ++k) {
+    const T *x = signal + 2 * k + 2 - filterSize;
+    T a = 0;
+    T d = 0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      a += x[j] * Lo_D[filterSize - j - 1];
+      d += x[j] * Ho_D[filterSize - j - 1];
+    }
+    cA[k] = a;
+    cD[k] = d;
+  }
+}
+
+/**
+ * Scalar lifting step, target[i] += coeff * source[i].
+ *
+ * @param target The samples to update.
+ * @param source The samples to lift from, not overlapping target.
+ * @param coeff The lifting coefficient.
+ * @param count The number of samples.
+ */
+static void lifting_step_scalar(double *target, const double *source,
+                                double coeff, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    target[i] += coeff * source[i];
+  }
+}
+
+/**
+ * Scalar single level idwt, the reference for the vectorized kernels.
+ *
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ * @param Lo_R The low pass reconstruction filter.
+ * @param Ho_R The high pass reconstruction filter.
+ * @param filterSize The even length of both filters.
+ * @param output The reconstructed signal.
+ * @param first The first sample to compute.
+ * @param last One past the last sample to compute.
+ */
+static void idwt_synthesis_scalar(const double *cA, const double *cD,
+                                  const double *Lo_R, const double *Ho_R,
+                                  size_t filterSize, double *output,
+                                  size_t first, size_t last) {
+  for (size_t i = first; i < last; ++i) {
+    const double *a = cA + i / 2;
+    const double *d = cD + i / 2;
+    // even outputs take the even taps, odd outputs the odd ones
+    const size_t tap = filterSize - 2 + (i & 1);
+    double x = 0.0;
+    for (size_t s = 0; s < filterSize / 2; ++s) {
+      x += a[s] * Lo_R[tap - 2 * s];
+      x += d[s] * Ho_R[tap - 2 * s];
+    }
+    output[i] = x;
+  }
+}
+
+/**
+ * Scalar interleaved multichannel dwt, the reference for the vectorized
+ * kernels.
+ *
+ * @param signal The input signals, interleaved.
+ * @param signalSize The number of samples in each signal.
+ * @param channels The number of signals.
+ * @param stride The distance between consecutive samples of a signal, and
+ * between consecutive coefficients.
+ * @param Lo_D The low pass decomposition filter.
+ * @param Ho_D The high pass decomposition filter.
+ * @param filterSize The length of both filters.
+ * @param cA The approximation coefficients, interleaved.
+ * @param cD The detail coefficients, interleaved.
+ * @param first The first coefficient to compute.
+ * @param last One past the last coefficient to compute.
+ */
+static void dwt_analysis_interleaved_scalar(const double *signal,
+                                            size_t signalSize, size_t channels,
+                                            size_t stride, const double *Lo_D,
+                                            const double *Ho_D,
+                                            size_t filterSize, double *cA,
+                                            double *cD, size_t first,
+                                            size_t last) {
+  const std::ptrdiff_t n = signalSize;
+  const std::ptrdiff_t L = filterSize;
+  for (size_t k = first; k < last; ++k) {
+    const std::ptrdiff_t start = 2 * static_cast<std::ptrdiff_t>(k) + 2 - L;
+    double *a = cA + k * stride;
+    double *d = cD + k * stride;
+    for (size_t c = 0; c < channels; ++c) {
+      double sa = 0.0;
+      double sd = 0.0;
+      for (std::ptrdiff_t j = 0; j < L; ++j) {
+        const double x = signal[sym_index(n, start + j) * stride + c];
+        sa += x * Lo_D[L - j - 1];
+        sd += x * Ho_D[L - j - 1];
+      }
+      a[c] = sa;
+      d[c] = sd;
+    }
+  }
+}
+
+/**
+ * Scalar a trous analysis, the reference for the vectorized kernels.
+ *
+ * @param signal The input signal, outputSize + (filterSize - 1) * step
+ * samples.
+ * @param outputSize The number of coefficients.
+ * @param step The distance between the samples read by consecutive taps.
+ * @param Lo_D The low pass decomposition filter.
+ * @param Ho_D The high pass decomposition filter.
+ * @param filterSize The length of both filters.
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ */
+static void swt_analysis_scalar(const double *signal, size_t outputSize,
+                                size_t step, const double *Lo_D,
+                                const double *Ho_D, size_t filterSize,
+                                double *cA, double *cD) {
+  for (size_t i = 0; i < outputSize; ++i) {
+    double a = 0.0;
+    double d = 0.0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double x = signal[i + j * step];
+      a += x * Lo_D[filterSize - j - 1];
+      d += x * Ho_D[filterSize - j - 1];
+    }
+    cA[i] = a;
+    cD[i] = d;
+  }
+}
+
+/**
+ * Scalar a trous synthesis, the reference for the vectorized kernels.
+ *
+ * @param cA The approximation coefficients, outputSize + (filterSize - 1) *
+ * step of them.
+ * @param cD The detail coefficients, as many.
+ * @param outputSize The number of samples.
+ * @param step The distance between the coefficients read by consecutive
+ * taps.
+ * @param Lo_R The low pass reconstruction filter.
+ * @param Ho_R The high pass reconstruction filter.
+ * @param filterSize The length of both filters.
+ * @param output The samples.
+ */
+static void swt_synthesis_scalar(const double *cA, const double *cD,
+                                 size_t outputSize, size_t step,
+                                 const double *Lo_R, const double *Ho_R,
+                                 size_t filterSize, double *output) {
+  for (size_t i = 0; i < outputSize; ++i) {
+    double x = 0.0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      x += cA[i + j * step] * Lo_R[filterSize - j - 1];
+      x += cD[i + j * step] * Ho_R[filterSize - j - 1];
+    }
+    output[i] = x;
+  }
+}
+
+/**
+ * Thresholds one coefficient, the reference for the vectorized kernels,
+ * which compute the same expressions lane by lane. Every shrinkage gives +0
+ * unless |x| > threshold, which also maps NaN to +0. Above it the firm
+ * shrinkage is min(scale (|x| - low), |x|) with the sign of x, since
+ * scale (|x| - low) with scale = high / (high - low) passes |x| exactly at
+ * high.
+ *
+ * @param x The coefficient.
+ * @param kind The shrinkage.
+ * @param threshold The threshold, the lower one of the firm shrinkage.
+ * @param square threshold * threshold, for the garrote.
+ * @param scale high / (high - low), for the firm shrinkage.
+ * @return The thresholded coefficient.
+ */
+static inline double threshold_one(double x, ThresholdKind kind,
+                                   double threshold, double square,
+                                   double scale) {
+  const double a = std::abs(x);
+  switch (kind) {
+  case ThresholdKind::Hard:
+    return a > threshold ? x : 0.0;
+  case ThresholdKind::Soft:
+    return a > threshold ? std::copysign(a - threshold, x) : 0.0;
+  case ThresholdKind::Garrote:
+    return a > threshold ? x - square / x : 0.0;
+  default:
+    return a > threshold
+               ? std::copysign(std::min(scale * (a - threshold), a), x)
+               : 0.0;
+  }
+}
+
+/**
+ * Computes the factor of the firm shrinkage, high / (high - low).
+ */
+static inline double firm_scale(ThresholdKind kind, double low, double high) {
+  return kind == ThresholdKind::Firm ? high / (high - low) : 0.0;
+}
+
+/**
+ * Scalar thresholding in place.
+ *
+ * @param x The coefficients.
+ * @param count The number of coefficients.
+ * @param kind The shrinkage.
+ * @param threshold The threshold, the lower one of the firm shrinkage.
+ * @param high The upper threshold of the firm shrinkage.
+ */
+static void threshold_scalar(double *x, size_t count, ThresholdKind kind,
+                             double threshold, double high) {
+  const double square = threshold * threshold;
+  const double scale = firm_scale(kind, threshold, high);
+  for (size_t i = 0; i < count; ++i) {
+    x[i] = threshold_one(x[i], kind, threshold, square, scale);
+  }
+}
+
+#ifdef CODEWAVELETS_X86
+//-------------------------------------------------------------
+// SSE2
+
+/**
+ * SSE2 "valid" convolution, 8 outputs per iteration in four registers.
+ */
+__attribute__((target("sse2"))) static void
+conv_valid_sse2(const double *input, size_t outputSize, const double *filter,
+                size_t filterSize, double *output) {
+  size_t i = 0;
+  for (; i + 8 <= outputSize; i += 8) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd();
+    __m128d acc3 = _mm_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const __m128d tap = _mm_set1_pd(filter[filterSize - j - 1]);
+      const double *x = input + i + j;
+      acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x), tap));
+      acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + 2), tap));
+      acc2 = _mm_add_pd(acc2, _mm_mul_pd(_mm_loadu_pd(x + 4), tap));
+      acc3 = _mm_add_pd(acc3, _mm_mul_pd(_mm_loadu_pd(x + 6), tap));
+    }
+    _mm_storeu_pd(output + i, acc0);
+    _mm_storeu_pd(output + i + 2, acc1);
+    _mm_storeu_pd(output + i + 4, acc2);
+    _mm_storeu_pd(output + i + 6, acc3);
+  }
+  for (; i + 2 <= outputSize; i += 2) {
+    __m128d acc = _mm_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const __m128d tap = _mm_set1_pd(filter[filterSize - j - 1]);
+      acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(input + i + j), tap));
+    }
+    _mm_storeu_pd(output + i, acc);
+  }
+  conv_valid_scalar(input + i, outputSize - i, filter, filterSize, output + i);
+}
+
+/**
+ * SSE2 single level dwt, 4 coefficient pairs per iteration.
+ */
+__attribute__((target("sse2"))) static void
+dwt_analysis_sse2(const double *signal, size_t signalSize, const double *Lo_D,
+                  const double *Ho_D, size_t filterSize, double *cA,
+                  double *cD, size_t first, size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_scalar(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD,
+                        first, last);
+    return;
+  }
+  size_t interiorFirst, interiorLast;
+  dwt_boundaries(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, first,
+                 last, interiorFirst, interiorLast, false);
+
+  double even[kPhaseBlock + kMaxPhaseFilter / 2];
+  double odd[kPhaseBlock + kMaxPhaseFilter / 2];
+  for (size_t k0 = interiorFirst; k0 < interiorLast; k0 += kPhaseBlock) {
+    const size_t count = interiorLast - k0 < kPhaseBlock ? interiorLast - k0
+                                                         : kPhaseBlock;
+    dwt_split_phases(signal, filterSize, k0, count, even, odd);
+    double *a = cA + k0;
+    double *d = cD + k0;
+    size_t q = 0;
+    for (; q + 4 <= count; q += 4) {
+      __m128d lo0 = _mm_setzero_pd();
+      __m128d lo1 = _mm_setzero_pd();
+      __m128d hi0 = _mm_setzero_pd();
+      __m128d hi1 = _mm_setzero_pd();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const double *phase = (j & 1) ? odd : even;
+        const double *x = phase + q + j / 2;
+        const __m128d x0 = _mm_loadu_pd(x);
+        const __m128d x1 = _mm_loadu_pd(x + 2);
+        const __m128d fl = _mm_set1_pd(Lo_D[filterSize - j - 1]);
+        const __m128d fh = _mm_set1_pd(Ho_D[filterSize - j - 1]);
+        lo0 = _mm_add_pd(lo0, _mm_mul_pd(x0, fl));
+        lo1 = _mm_add_pd(lo1, _mm_mul_pd(x1, fl));
+        hi0 = _mm_add_pd(hi0, _mm_mul_pd(x0, fh));
+        hi1 = _mm_add_pd(hi1, _mm_mul_pd(x1, fh));
+      }
+      _mm_storeu_pd(a + q, lo0);
+      _mm_storeu_pd(a + q + 2, lo1);
+      _mm_storeu_pd(d + q, hi0);
+      _mm_storeu_pd(d + q + 2, hi1);
+    }
+    for (; q < count; ++q) {
+      double sa = 0.0;
+      double sd = 0.0;
+      for (size_t j = 0; j < filterSize; ++j) {
+        const double *phase = (j & 1) ? odd : even;
+        const double x = phase[q + j / 2];
+        sa += x * Lo_D[filterSize - j - 1];
+        sd += x * Ho_D[filterSize - j - 1];
+      }
+      a[q] = sa;
+      d[q] = sd;
+    }
+  }
+}
+
+/**
+ * SSE2 single level dwt, 8 coefficient pairs per iteration.
+ */
+__attribute__((target("sse2"))) static void
+dwt_analysis_f32_sse2(const float *signal, size_t signalSize,
+                      const float *Lo_D, const float *Ho_D, size_t filterSize,
+                      float *cA, float *cD, size_t first, size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_scalar(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD,
+                        first, last);
+    return;
+  }
+  size_t interiorFirst, interiorLast;
+  dwt_boundaries(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, first,
+                 last, interiorFirst, interiorLast, false);
+
+  float even[kPhaseBlock + kMaxPhaseFilter / 2];
+  float odd[kPhaseBlock + kMaxPhaseFilter / 2];
+  for (size_t k0 = interiorFirst; k0 < interiorLast; k0 += kPhaseBlock) {
+    const size_t count = interiorLast - k0 < kPhaseBlock ? interiorLast - k0
+                                                         : kPhaseBlock;
+    dwt_split_phases(signal, filterSize, k0, count, even, odd);
+    float *a = cA + k0;
+    float *d = cD + k0;
+    size_t q = 0;
+    for (; q + 8 <= count; q += 8) {
+      __m128 lo0 = _mm_setzero_ps();
+      __m128 lo1 = _mm_setzero_ps();
+      __m128 hi0 = _mm_setzero_ps();
+      __m128 hi1 = _mm_setzero_ps();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const float *phase = (j & 1) ? odd : even;
+        const float *x = phase + q + j / 2;
+        const __m128 x0 = _mm_loadu_ps(x);
+        const __m128 x1 = _mm_loadu_ps(x + 4);
+        const __m128 fl = _mm_set1_ps(Lo_D[filterSize - j - 1]);
+        const __m128 fh = _mm_set1_ps(Ho_D[filterSize - j - 1]);
+        lo0 = _mm_add_ps(lo0, _mm_mul_ps(x0, fl));
+        lo1 = _mm_add_ps(lo1, _mm_mul_ps(x1, fl));
+        hi0 = _mm_add_ps(hi0, _mm_mul_ps(x0, fh));
+        hi1 = _mm_add_ps(hi1, _mm_mul_ps(x1, fh));
+      }
+      _mm_storeu_ps(a + q, lo0);
+      _mm_storeu_ps(a + q + 4, lo1);
+      _mm_storeu_ps(d + q, hi0);
+      _mm_storeu_ps(d + q + 4, hi1);
+    }
+    for (; q < count; ++q) {
+      float sa = 0;
+      float sd = 0;
+      for (size_t j = 0; j < filterSize; ++j) {
+        const float *phase = (j & 1) ? odd : even;
+        const float x = phase[q + j / 2];
+        sa += x * Lo_D[filterSize - j - 1];
+        sd += x * Ho_D[filterSize - j - 1];
+      }
+      a[q] = sa;
+      d[q] = sd;
+    }
+  }
+}
+
+/**
+ * SSE2 lifting step, 4 samples per iteration.
+ */
+__attribute__((target("sse2"))) static void
+lifting_step_sse2(double *target, const double *source, double coeff,
+                  size_t count) {
+  const __m128d c = _mm_set1_pd(coeff);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128d t0 = _mm_loadu_pd(target + i);
+    const __m128d t1 = _mm_loadu_pd(target + i + 2);
+    _mm_storeu_pd(target + i,
+                  _mm_add_pd(t0, _mm_mul_pd(c, _mm_loadu_pd(source + i))));
+    _mm_storeu_pd(target + i + 2,
+                  _mm_add_pd(t1, _mm_mul_pd(c, _mm_loadu_pd(source + i + 2))));
+  }
+  lifting_step_scalar(target + i, source + i, coeff, count - i);
+}
+
+/**
+ * SSE2 single level idwt, 4 output pairs per iteration.
+ */
+__attribute__((target("sse2"))) static void
+idwt_synthesis_sse2(const double *cA, const double *cD, const double *Lo_R,
+                    const double *Ho_R, size_t filterSize, double *output,
+                    size_t first, size_t last) {
+  if (first & 1) {
+    idwt_synthesis_scalar(cA, cD, Lo_R, Ho_R, filterSize, output, first,
+                          first + 1 < last ? first + 1 : last);
+    ++first;
+  }
+  size_t i = first;
+  for (; i + 8 <= last; i += 8) {
+    const double *a = cA + i / 2;
+    const double *d = cD + i / 2;
+    __m128d even0 = _mm_setzero_pd();
+    __m128d even1 = _mm_setzero_pd();
+    __m128d odd0 = _mm_setzero_pd();
+    __m128d odd1 = _mm_setzero_pd();
+    for (size_t s = 0; s < filterSize / 2; ++s) {
+      const size_t tap = filterSize - 2 - 2 * s;
+      const __m128d a0 = _mm_loadu_pd(a + s);
+      const __m128d a1 = _mm_loadu_pd(a + s + 2);
+      const __m128d d0 = _mm_loadu_pd(d + s);
+      const __m128d d1 = _mm_loadu_pd(d + s + 2);
+      const __m128d le = _mm_set1_pd(Lo_R[tap]);
+      const __m128d lo = _mm_set1_pd(Lo_R[tap + 1]);
+      const __m128d he = _mm_set1_pd(Ho_R[tap]);
+      const __m128d ho = _mm_set1_pd(Ho_R[tap + 1]);
+      even0 = _mm_add_pd(even0, _mm_mul_pd(a0, le));
+      even1 = _mm_add_pd(even1, _mm_mul_pd(a1, le));
+      odd0 = _mm_add_pd(odd0, _mm_mul_pd(a0, lo));
+      odd1 = _mm_add_pd(odd1, _mm_mul_pd(a1, lo));
+      even0 = _mm_add_pd(even0, _mm_mul_pd(d0, he));
+      even1 = _mm_add_pd(even1, _mm_mul_pd(d1, he));
+      odd0 = _mm_add_pd(odd0, _mm_mul_pd(d0, ho));
+      odd1 = _mm_add_pd(odd1, _mm_mul_pd(d1, ho));
+    }
+    _mm_storeu_pd(output + i, _mm_unpacklo_pd(even0, odd0));
+    _mm_storeu_pd(output + i + 2, _mm_unpackhi_pd(even0, odd0));
+    _mm_storeu_pd(output + i + 4, _mm_unpacklo_pd(even1, odd1));
+    _mm_storeu_pd(output + i + 6, _mm_unpackhi_pd(even1, odd1));
+  }
+  idwt_synthesis_scalar(cA, cD, Lo_R, Ho_R, filterSize, output, i, last);
+}
+
+/**
+ * SSE2 interleaved multichannel dwt, 4 channels per iteration.
+ */
+__attribute__((target("sse2"))) static void
+dwt_analysis_interleaved_sse2(const double *signal, size_t signalSize,
+                              size_t channels, size_t stride,
+                              const double *Lo_D, const double *Ho_D,
+                              size_t filterSize, double *cA,
+                              double *cD, size_t first, size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_interleaved_scalar(signal, signalSize, channels, stride,
+                                    Lo_D, Ho_D, filterSize, cA, cD, first,
+                                    last);
+    return;
+  }
+  size_t offsets[kMaxPhaseFilter];
+  for (size_t k = first; k < last; ++k) {
+    dwt_tap_offsets(signalSize, stride, filterSize, k, offsets);
+    double *a = cA + k * stride;
+    double *d = cD + k * stride;
+    size_t c = 0;
+    for (; c + 4 <= channels; c += 4) {
+      __m128d lo0 = _mm_setzero_pd();
+      __m128d lo1 = _mm_setzero_pd();
+      __m128d hi0 = _mm_setzero_pd();
+      __m128d hi1 = _mm_setzero_pd();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const double *x = signal + offsets[j] + c;
+        const __m128d x0 = _mm_loadu_pd(x);
+        const __m128d x1 = _mm_loadu_pd(x + 2);
+        const __m128d fl = _mm_set1_pd(Lo_D[filterSize - j - 1]);
+        const __m128d fh = _mm_set1_pd(Ho_D[filterSize - j - 1]);
+        lo0 = _mm_add_pd(lo0, _mm_mul_pd(x0, fl));
+        lo1 = _mm_add_pd(lo1, _mm_mul_pd(x1, fl));
+        hi0 = _mm_add_pd(hi0, _mm_mul_pd(x0, fh));
+        hi1 = _mm_add_pd(hi1, _mm_mul_pd(x1, fh));
+      }
+      _mm_storeu_pd(a + c, lo0);
+      _mm_storeu_pd(a + c + 2, lo1);
+      _mm_storeu_pd(d + c, hi0);
+      _mm_storeu_pd(d + c + 2, hi1);
+    }
+    for (; c < channels; ++c) {
+      double sa = 0.0;
+      double sd = 0.0;
+      for (size_t j = 0; j < filterSize; ++j) {
+        const double x = signal[offsets[j] + c];
+        sa += x * Lo_D[filterSize - j - 1];
+        sd += x * Ho_D[filterSize - j - 1];
+      }
+      a[c] = sa;
+      d[c] = sd;
+    }
+  }
+}
+
+/**
+ * SSE2 a trous analysis, 4 coefficient pairs per iteration.
+ */
+__attribute__((target("sse2"))) static void
+swt_analysis_sse2(const double *signal, size_t outputSize, size_t step,
+                  const double *Lo_D, const double *Ho_D, size_t filterSize,
+                  double *cA, double *cD) {
+  size_t i = 0;
+  for (; i + 4 <= outputSize; i += 4) {
+    __m128d lo0 = _mm_setzero_pd();
+    __m128d lo1 = _mm_setzero_pd();
+    __m128d hi0 = _mm_setzero_pd();
+    __m128d hi1 = _mm_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double *x = signal + i + j * step;
+      const __m128d x0 = _mm_loadu_pd(x);
+      const __m128d x1 = _mm_loadu_pd(x + 2);
+      const __m128d fl = _mm_set1_pd(Lo_D[filterSize - j - 1]);
+      const __m128d fh = _mm_set1_pd(Ho_D[filterSize - j - 1]);
+      lo0 = _mm_add_pd(lo0, _mm_mul_pd(x0, fl));
+      lo1 = _mm_add_pd(lo1, _mm_mul_pd(x1, fl));
+      hi0 = _mm_add_pd(hi0, _mm_mul_pd(x0, fh));
+      hi1 = _mm_add_pd(hi1, _mm_mul_pd(x1, fh));
+    }
+    _mm_storeu_pd(cA + i, lo0);
+    _mm_storeu_pd(cA + i + 2, lo1);
+    _mm_storeu_pd(cD + i, hi0);
+    _mm_storeu_pd(cD + i + 2, hi1);
+  }
+  swt_analysis_scalar(signal + i, outputSize - i, step, Lo_D, Ho_D,
+                      filterSize, cA + i, cD + i);
+}
+
+/**
+ * SSE2 a trous synthesis, 4 samples per iteration.
+ */
+__attribute__((target("sse2"))) static void
+swt_synthesis_sse2(const double *cA, const double *cD, size_t outputSize,
+                   size_t step, const double *Lo_R, const double *Ho_R,
+                   size_t filterSize, double *output) {
+  size_t i = 0;
+  for (; i + 4 <= outputSize; i += 4) {
+    __m128d x0 = _mm_setzero_pd();
+    __m128d x1 = _mm_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double *a = cA + i + j * step;
+      const double *d = cD + i + j * step;
+      const __m128d fl = _mm_set1_pd(Lo_R[filterSize - j - 1]);
+      const __m128d fh = _mm_set1_pd(Ho_R[filterSize - j - 1]);
+      x0 = _mm_add_pd(x0, _mm_mul_pd(_mm_loadu_pd(a), fl));
+      x1 = _mm_add_pd(x1, _mm_mul_pd(_mm_loadu_pd(a + 2), fl));
+      x0 = _mm_add_pd(x0, _mm_mul_pd(_mm_loadu_pd(d), fh));
+      x1 = _mm_add_pd(x1, _mm_mul_pd(_mm_loadu_pd(d + 2), fh));
+    }
+    _mm_storeu_pd(output + i, x0);
+    _mm_storeu_pd(output + i + 2, x1);
+  }
+  swt_synthesis_scalar(cA + i, cD + i, outputSize - i, step, Lo_R, Ho_R,
+                       filterSize, output + i);
+}
+
+/**
+ * SSE2 threshold of one vector, with the mask of |x| > threshold, false for
+ * NaN, clearing the other lanes and the sign bit for copysign.
+ */
+__attribute__((target("sse2"))) static inline __m128d
+threshold_vector_sse2(__m128d x, ThresholdKind kind, __m128d threshold,
+                      __m128d square, __m128d scale) {
+  const __m128d sign = _mm_set1_pd(-0.0);
+  const __m128d a = _mm_andnot_pd(sign, x);
+  const __m128d above = _mm_cmpgt_pd(a, threshold);
+  switch (kind) {
+  case ThresholdKind::Hard:
+    return _mm_and_pd(x, above);
+  case ThresholdKind::Soft:
+    return _mm_and_pd(
+        _mm_or_pd(_mm_sub_pd(a, threshold), _mm_and_pd(sign, x)), above);
+  case ThresholdKind::Garrote:
+    return _mm_and_pd(_mm_sub_pd(x, _mm_div_pd(square, x)), above);
+  default:
+    return _mm_and_pd(
+        _mm_or_pd(_mm_min_pd(_mm_mul_pd(scale, _mm_sub_pd(a, threshold)), a),
+                  _mm_and_pd(sign, x)),
+        above);
+  }
+}
+
+/**
+ * SSE2 thresholding in place, 4 coefficients per iteration.
+ */
+__attribute__((target("sse2"))) static void
+threshold_sse2(double *x, size_t count, ThresholdKind kind, double threshold,
+               double high) {
+  const __m128d t = _mm_set1_pd(threshold);
+  const __m128d square = _mm_set1_pd(threshold * threshold);
+  const __m128d scale = _mm_set1_pd(firm_scale(kind, threshold, high));
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128d x0 = _mm_loadu_pd(x + i);
+    const __m128d x1 = _mm_loadu_pd(x + i + 2);
+    _mm_storeu_pd(x + i, threshold_vector_sse2(x0, kind, t, square, scale));
+    _mm_storeu_pd(x + i + 2,
+                  threshold_vector_sse2(x1, kind, t, square, scale));
+  }
+  threshold_scalar(x + i, count - i, kind, threshold, high);
+}
+
+//-------------------------------------------------------------
+// AVX2 + FMA
+
+/**
+ * AVX2 + FMA "valid" convolution, 16 outputs per iteration in four registers.
+ */
+__attribute__((target("avx2,fma"))) static void
+conv_valid_avx2(const double *input, size_t outputSize, const double *filter,
+                size_t filterSize, double *output) {
+  size_t i = 0;
+  for (; i + 16 <= outputSize; i += 16) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const __m256d tap = _mm256_broadcast_sd(filter + filterSize - j - 1);
+      const double *x = input + i + j;
+      acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x), tap, acc0);
+      acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + 4), tap, acc1);
+      acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + 8), tap, acc2);
+      acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + 12), tap, acc3);
+    }
+    _mm256_storeu_pd(output + i, acc0);
+    _mm256_storeu_pd(output + i + 4, acc1);
+    _mm256_storeu_pd(output + i + 8, acc2);
+    _mm256_storeu_pd(output + i + 12, acc3);
+  }
+  for (; i + 4 <= outputSize; i += 4) {
+    __m256d acc = _mm256_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const __m256d tap = _mm256_broadcast_sd(filter + filterSize - j - 1);
+      acc = _mm256_fmadd_pd(_mm256_loadu_pd(input + i + j), tap, acc);
+    }
+    _mm256_storeu_pd(output + i, acc);
+  }
+  for (; i < outputSize; ++i) {
+    double acc = 0.0;
+    for (size_t j = 0; j < filterSize; ++j) {
+      acc = std::fma(input[i + j], filter[filterSize - j - 1], acc);
+    }
+    output[i] = acc;
+  }
+}
+
+/**
+ * AVX2 + FMA single level dwt, 8 coefficient pairs per iteration.
+ */
+__attribute__((target("avx2,fma"))) static void
+dwt_analysis_avx2(const double *signal, size_t signalSize, const double *Lo_D,
+                  const double *Ho_D, size_t filterSize, double *cA,
+                  double *cD, size_t first, size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_scalar(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD,
+                        first, last);
+    return;
+  }
+  size_t interiorFirst, interiorLast;
+  dwt_boundaries(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, first,
+                 last, interiorFirst, interiorLast, true);
+
+  double even[kPhaseBlock + kMaxPhaseFilter / 2];
+  double odd[kPhaseBlock + kMaxPhaseFilter / 2];
+  for (size_t k0 = interiorFirst; k0 < interiorLast; k0 += kPhaseBlock) {
+    const size_t count = interiorLast - k0 < kPhaseBlock ? interiorLast - k0
+                                                         : kPhaseBlock;
+    dwt_split_phases(signal, filterSize, k0, count, even, odd);
+    double *a = cA + k0;
+    double *d = cD + k0;
+    size_t q = 0;
+    for (; q + 8 <= count; q += 8) {
+      __m256d lo0 = _mm256_setzero_pd();
+      __m256d lo1 = _mm256_setzero_pd();
+      __m256d hi0 = _mm256_setzero_pd();
+      __m256d hi1 = _mm256_setzero_pd();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const double *phase = (j & 1) ? odd : even;
+        const double *x = phase + q + j / 2;
+        const __m256d x0 = _mm256_loadu_pd(x);
+        const __m256d x1 = _mm256_loadu_pd(x + 4);
+        const __m256d fl = _mm256_broadcast_sd(Lo_D + filterSize - j - 1);
+        const __m256d fh = _mm256_broadcast_sd(Ho_D + filterSize - j - 1);
+        lo0 = _mm256_fmadd_pd(x0, fl, lo0);
+        lo1 = _mm256_fmadd_pd(x1, fl, lo1);
+        hi0 = _mm256_fmadd_pd(x0, fh, hi0);
+        hi1 = _mm256_fmadd_pd(x1, fh, hi1);
+      }
+      _mm256_storeu_pd(a + q, lo0);
+      _mm256_storeu_pd(a + q + 4, lo1);
+      _mm256_storeu_pd(d + q, hi0);
+      _mm256_storeu_pd(d + q + 4, hi1);
+    }
+    dwt_phase_tail_fma(even, odd, Lo_D, Ho_D, filterSize, a, d, q, count);
+  }
+}
+
+/**
+ * AVX2 + FMA single level dwt, 16 coefficient pairs per iteration.
+ */
+__attribute__((target("avx2,fma"))) static void
+dwt_analysis_f32_avx2(const float *signal, size_t signalSize,
+                      const float *Lo_D, const float *Ho_D, size_t filterSize,
+                      float *cA, float *cD, size_t first, size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_scalar(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD,
+                        first, last);
+    return;
+  }
+  size_t interiorFirst, interiorLast;
+  dwt_boundaries(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, first,
+                 last, interiorFirst, interiorLast, true);
+
+  float even[kPhaseBlock + kMaxPhaseFilter / 2];
+  float odd[kPhaseBlock + kMaxPhaseFilter / 2];
+  for (size_t k0 = interiorFirst; k0 < interiorLast; k0 += kPhaseBlock) {
+    const size_t count = interiorLast - k0 < kPhaseBlock ? interiorLast - k0
+                                                         : kPhaseBlock;
+    dwt_split_phases(signal, filterSize, k0, count, even, odd);
+    float *a = cA + k0;
+    float *d = cD + k0;
+    size_t q = 0;
+    for (; q + 16 <= count; q += 16) {
+      __m256 lo0 = _mm256_setzero_ps();
+      __m256 lo1 = _mm256_setzero_ps();
+      __m256 hi0 = _mm256_setzero_ps();
+      __m256 hi1 = _mm256_setzero_ps();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const float *phase = (j & 1) ? odd : even;
+        const float *x = phase + q + j / 2;
+        const __m256 x0 = _mm256_loadu_ps(x);
+        const __m256 x1 = _mm256_loadu_ps(x + 8);
+        const __m256 fl = _mm256_broadcast_ss(Lo_D + filterSize - j - 1);
+        const __m256 fh = _mm256_broadcast_ss(Ho_D + filterSize - j - 1);
+        lo0 = _mm256_fmadd_ps(x0, fl, lo0);
+        lo1 = _mm256_fmadd_ps(x1, fl, lo1);
+        hi0 = _mm256_fmadd_ps(x0, fh, hi0);
+        hi1 = _mm256_fmadd_ps(x1, fh, hi1);
+      }
+      _mm256_storeu_ps(a + q, lo0);
+      _mm256_storeu_ps(a + q + 8, lo1);
+      _mm256_storeu_ps(d + q, hi0);
+      _mm256_storeu_ps(d + q + 8, hi1);
+    }
+    dwt_phase_tail_fma(even, odd, Lo_D, Ho_D, filterSize, a, d, q, count);
+  }
+}
+
+/**
+ * AVX2 + FMA lifting step, 8 samples per iteration.
+ */
+__attribute__((target("avx2,fma"))) static void
+lifting_step_avx2(double *target, const double *source, double coeff,
+                  size_t count) {
+  const __m256d c = _mm256_set1_pd(coeff);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256d t0 = _mm256_loadu_pd(target + i);
+    const __m256d t1 = _mm256_loadu_pd(target + i + 4);
+    _mm256_storeu_pd(target + i,
+                     _mm256_fmadd_pd(c, _mm256_loadu_pd(source + i), t0));
+    _mm256_storeu_pd(target + i + 4,
+                     _mm256_fmadd_pd(c, _mm256_loadu_pd(source + i + 4), t1));
+  }
+  for (; i < count; ++i) {
+    target[i] = std::fma(coeff, source[i], target[i]);
+  }
+}
+
+/**
+ * AVX2 + FMA single level idwt, 8 output pairs per iteration.
+ */
+__attribute__((target("avx2,fma"))) static void
+idwt_synthesis_avx2(const double *cA, const double *cD, const double *Lo_R,
+                    const double *Ho_R, size_t filterSize, double *output,
+                    size_t first, size_t last) {
+  if (first & 1) {
+    idwt_synthesis_fma(cA, cD, Lo_R, Ho_R, filterSize, output, first,
+                       first + 1 < last ? first + 1 : last);
+    ++first;
+  }
+  size_t i = first;
+  for (; i + 16 <= last; i += 16) {
+    const double *a = cA + i / 2;
+    const double *d = cD + i / 2;
+    __m256d even0 = _mm256_setzero_pd();
+    __m256d even1 = _mm256_setzero_pd();
+    __m256d odd0 = _mm256_setzero_pd();
+    __m256d odd1 = _mm256_setzero_pd();
+    for (size_t s = 0; s < filterSize / 2; ++s) {
+      const size_t tap = filterSize - 2 - 2 * s;
+      const __m256d a0 = _mm256_loadu_pd(a + s);
+      const __m256d a1 = _mm256_loadu_pd(a + s + 4);
+      const __m256d d0 = _mm256_loadu_pd(d + s);
+      const __m256d d1 = _mm256_loadu_pd(d + s + 4);
+      const __m256d le = _mm256_set1_pd(Lo_R[tap]);
+      const __m256d lo = _mm256_set1_pd(Lo_R[tap + 1]);
+      const __m256d he = _mm256_set1_pd(Ho_R[tap]);
+      const __m256d ho = _mm256_set1_pd(Ho_R[tap + 1]);
+      even0 = _mm256_fmadd_pd(a0, le, even0);
+      even1 = _mm256_fmadd_pd(a1, le, even1);
+      odd0 = _mm256_fmadd_pd(a0, lo, odd0);
+      odd1 = _mm256_fmadd_pd(a1, lo, odd1);
+      even0 = _mm256_fmadd_pd(d0, he, even0);
+      even1 = _mm256_fmadd_pd(d1, he, even1);
+      odd0 = _mm256_fmadd_pd(d0, ho, odd0);
+      odd1 = _mm256_fmadd_pd(d1, ho, odd1);
+    }
+    // [e0 o0 e2 o2] and [e1 o1 e3 o3] to [e0 o0 e1 o1] and [e2 o2 e3 o3]
+    const __m256d lo0 = _mm256_unpacklo_pd(even0, odd0);
+    const __m256d hi0 = _mm256_unpackhi_pd(even0, odd0);
+    const __m256d lo1 = _mm256_unpacklo_pd(even1, odd1);
+    const __m256d hi1 = _mm256_unpackhi_pd(even1, odd1);
+    _mm256_storeu_pd(output + i, _mm256_permute2f128_pd(lo0, hi0, 0x20));
+    _mm256_storeu_pd(output + i + 4, _mm256_permute2f128_pd(lo0, hi0, 0x31));
+    _mm256_storeu_pd(output + i + 8, _mm256_permute2f128_pd(lo1, hi1, 0x20));
+    _mm256_storeu_pd(output + i + 12,
+                     _mm256_permute2f128_pd(lo1, hi1, 0x31));
+  }
+  idwt_synthesis_fma(cA, cD, Lo_R, Ho_R, filterSize, output, i, last);
+}
+
+/**
+ * AVX2 + FMA interleaved multichannel dwt, 8 channels per iteration.
+ */
+__attribute__((target("avx2,fma"))) static void
+dwt_analysis_interleaved_avx2(const double *signal, size_t signalSize,
+                              size_t channels, size_t stride,
+                              const double *Lo_D, const double *Ho_D,
+                              size_t filterSize, double *cA,
+                              double *cD, size_t first, size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_interleaved_scalar(signal, signalSize, channels, stride,
+                                    Lo_D, Ho_D, filterSize, cA, cD, first,
+                                    last);
+    return;
+  }
+  size_t offsets[kMaxPhaseFilter];
+  for (size_t k = first; k < last; ++k) {
+    dwt_tap_offsets(signalSize, stride, filterSize, k, offsets);
+    double *a = cA + k * stride;
+    double *d = cD + k * stride;
+    size_t c = 0;
+    for (; c + 8 <= channels; c += 8) {
+      __m256d lo0 = _mm256_setzero_pd();
+      __m256d lo1 = _mm256_setzero_pd();
+      __m256d hi0 = _mm256_setzero_pd();
+      __m256d hi1 = _mm256_setzero_pd();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const double *x = signal + offsets[j] + c;
+        const __m256d x0 = _mm256_loadu_pd(x);
+        const __m256d x1 = _mm256_loadu_pd(x + 4);
+        const __m256d fl = _mm256_broadcast_sd(Lo_D + filterSize - j - 1);
+        const __m256d fh = _mm256_broadcast_sd(Ho_D + filterSize - j - 1);
+        lo0 = _mm256_fmadd_pd(x0, fl, lo0);
+        lo1 = _mm256_fmadd_pd(x1, fl, lo1);
+        hi0 = _mm256_fmadd_pd(x0, fh, hi0);
+        hi1 = _mm256_fmadd_pd(x1, fh, hi1);
+      }
+      _mm256_storeu_pd(a + c, lo0);
+      _mm256_storeu_pd(a + c + 4, lo1);
+      _mm256_storeu_pd(d + c, hi0);
+      _mm256_storeu_pd(d + c + 4, hi1);
+    }
+    for (; c + 4 <= channels; c += 4) {
+      __m256d lo = _mm256_setzero_pd();
+      __m256d hi = _mm256_setzero_pd();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const __m256d x = _mm256_loadu_pd(signal + offsets[j] + c);
+        lo = _mm256_fmadd_pd(x, _mm256_broadcast_sd(Lo_D + filterSize - j - 1),
+                             lo);
+        hi = _mm256_fmadd_pd(x, _mm256_broadcast_sd(Ho_D + filterSize - j - 1),
+                             hi);
+      }
+      _mm256_storeu_pd(a + c, lo);
+      _mm256_storeu_pd(d + c, hi);
+    }
+    dwt_interleaved_tail_fma(signal, offsets, channels, Lo_D, Ho_D, filterSize,
+                             a, d, c);
+  }
+}
+
+/**
+ * AVX2 + FMA a trous analysis, 8 coefficient pairs per iteration.
+ */
+__attribute__((target("avx2,fma"))) static void
+swt_analysis_avx2(const double *signal, size_t outputSize, size_t step,
+                  const double *Lo_D, const double *Ho_D, size_t filterSize,
+                  double *cA, double *cD) {
+  size_t i = 0;
+  for (; i + 8 <= outputSize; i += 8) {
+    __m256d lo0 = _mm256_setzero_pd();
+    __m256d lo1 = _mm256_setzero_pd();
+    __m256d hi0 = _mm256_setzero_pd();
+    __m256d hi1 = _mm256_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double *x = signal + i + j * step;
+      const __m256d x0 = _mm256_loadu_pd(x);
+      const __m256d x1 = _mm256_loadu_pd(x + 4);
+      const __m256d fl = _mm256_broadcast_sd(Lo_D + filterSize - j - 1);
+      const __m256d fh = _mm256_broadcast_sd(Ho_D + filterSize - j - 1);
+      lo0 = _mm256_fmadd_pd(x0, fl, lo0);
+      lo1 = _mm256_fmadd_pd(x1, fl, lo1);
+      hi0 = _mm256_fmadd_pd(x0, fh, hi0);
+      hi1 = _mm256_fmadd_pd(x1, fh, hi1);
+    }
+    _mm256_storeu_pd(cA + i, lo0);
+    _mm256_storeu_pd(cA + i + 4, lo1);
+    _mm256_storeu_pd(cD + i, hi0);
+    _mm256_storeu_pd(cD + i + 4, hi1);
+  }
+  swt_analysis_tail_fma(signal, outputSize, step, Lo_D, Ho_D, filterSize, cA,
+                        cD, i);
+}
+
+/**
+ * AVX2 + FMA a trous synthesis, 8 samples per iteration.
+ */
+__attribute__((target("avx2,fma"))) static void
+swt_synthesis_avx2(const double *cA, const double *cD, size_t outputSize,
+                   size_t step, const double *Lo_R, const double *Ho_R,
+                   size_t filterSize, double *output) {
+  size_t i = 0;
+  for (; i + 8 <= outputSize; i += 8) {
+    __m256d x0 = _mm256_setzero_pd();
+    __m256d x1 = _mm256_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double *a = cA + i + j * step;
+      const double *d = cD + i + j * step;
+      const __m256d fl = _mm256_broadcast_sd(Lo_R + filterSize - j - 1);
+      const __m256d fh = _mm256_broadcast_sd(Ho_R + filterSize - j - 1);
+      x0 = _mm256_fmadd_pd(_mm256_loadu_pd(a), fl, x0);
+      x1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + 4), fl, x1);
+      x0 = _mm256_fmadd_pd(_mm256_loadu_pd(d), fh, x0);
+      x1 = _mm256_fmadd_pd(_mm256_loadu_pd(d + 4), fh, x1);
+    }
+    _mm256_storeu_pd(output + i, x0);
+    _mm256_storeu_pd(output + i + 4, x1);
+  }
+  swt_synthesis_tail_fma(cA, cD, outputSize, step, Lo_R, Ho_R, filterSize,
+                         output, i);
+}
+
+/**
+ * AVX2 threshold of one vector, see threshold_vector_sse2().
+ */
+__attribute__((target("avx2,fma"))) static inline __m256d
+threshold_vector_avx2(__m256d x, ThresholdKind kind, __m256d threshold,
+                      __m256d square, __m256d scale) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  const __m256d a = _mm256_andnot_pd(sign, x);
+  const __m256d above = _mm256_cmp_pd(a, threshold, _CMP_GT_OQ);
+  switch (kind) {
+  case ThresholdKind::Hard:
+    return _mm256_and_pd(x, above);
+  case ThresholdKind::Soft:
+    return _mm256_and_pd(
+        _mm256_or_pd(_mm256_sub_pd(a, threshold), _mm256_and_pd(sign, x)),
+        above);
+  case ThresholdKind::Garrote:
+    return _mm256_and_pd(_mm256_sub_pd(x, _mm256_div_pd(square, x)), above);
+  default:
+    return _mm256_and_pd(
+        _mm256_or_pd(
+            _mm256_min_pd(_mm256_mul_pd(scale, _mm256_sub_pd(a, threshold)),
+                          a),
+            _mm256_and_pd(sign, x)),
+        above);
+  }
+}
+
+/**
+ * AVX2 thresholding in place, 8 coefficients per iteration.
+ */
+__attribute__((target("avx2,fma"))) static void
+threshold_avx2(double *x, size_t count, ThresholdKind kind, double threshold,
+               double high) {
+  const __m256d t = _mm256_set1_pd(threshold);
+  const __m256d square = _mm256_set1_pd(threshold * threshold);
+  const __m256d scale = _mm256_set1_pd(firm_scale(kind, threshold, high));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256d x0 = _mm256_loadu_pd(x + i);
+    const __m256d x1 = _mm256_loadu_pd(x + i + 4);
+    _mm256_storeu_pd(x + i,
+                     threshold_vector_avx2(x0, kind, t, square, scale));
+    _mm256_storeu_pd(x + i + 4,
+                     threshold_vector_avx2(x1, kind, t, square, scale));
+  }
+  threshold_scalar(x + i, count - i, kind, threshold, high);
+}
+
+//-------------------------------------------------------------
+// AVX-512
+
+/**
+ * AVX-512 "valid" convolution, 32 outputs per iteration in four registers.
+ */
+__attribute__((target("avx512f"))) static void
+conv_valid_avx512(const double *input, size_t outputSize, const double *filter,
+                  size_t filterSize, double *output) {
+  size_t i = 0;
+  for (; i + 32 <= outputSize; i += 32) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd();
+    __m512d acc3 = _mm512_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const __m512d tap = _mm512_set1_pd(filter[filterSize - j - 1]);
+      const double *x = input + i + j;
+      acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x), tap, acc0);
+      acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + 8), tap, acc1);
+      acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(x + 16), tap, acc2);
+      acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(x + 24), tap, acc3);
+    }
+    _mm512_storeu_pd(output + i, acc0);
+    _mm512_storeu_pd(output + i + 8, acc1);
+    _mm512_storeu_pd(output + i + 16, acc2);
+    _mm512_storeu_pd(output + i + 24, acc3);
+  }
+  // the tail uses masked loads instead of a scalar loop
+  for (; i < outputSize; i += 8) {
+    const size_t remaining = outputSize - i;
+    const __mmask8 mask =
+        remaining >= 8 ? 0xFF : static_cast<__mmask8>((1u << remaining) - 1);
+    __m512d acc = _mm512_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const __m512d tap = _mm512_set1_pd(filter[filterSize - j - 1]);
+      acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, input + i + j), tap,
+                            acc);
+    }
+    _mm512_mask_storeu_pd(output + i, mask, acc);
+  }
+}
+
+/**
+ * AVX-512 single level dwt, 16 coefficient pairs per iteration.
+ */
+__attribute__((target("avx512f"))) static void
+dwt_analysis_avx512(const double *signal, size_t signalSize, const double *Lo_D,
+                    const double *Ho_D, size_t filterSize, double *cA,
+                    double *cD, size_t first, size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_scalar(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD,
+                        first, last);
+    return;
+  }
+  size_t interiorFirst, interiorLast;
+  dwt_boundaries(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, first,
+                 last, interiorFirst, interiorLast, true);
+
+  double even[kPhaseBlock + kMaxPhaseFilter / 2];
+  double odd[kPhaseBlock + kMaxPhaseFilter / 2];
+  for (size_t k0 = interiorFirst; k0 < interiorLast; k0 += kPhaseBlock) {
+    const size_t count = interiorLast - k0 < kPhaseBlock ? interiorLast - k0
+                                                         : kPhaseBlock;
+    dwt_split_phases(signal, filterSize, k0, count, even, odd);
+    double *a = cA + k0;
+    double *d = cD + k0;
+    size_t q = 0;
+    for (; q + 16 <= count; q += 16) {
+      __m512d lo0 = _mm512_setzero_pd();
+      __m512d lo1 = _mm512_setzero_pd();
+      __m512d hi0 = _mm512_setzero_pd();
+      __m512d hi1 = _mm512_setzero_pd();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const double *phase = (j & 1) ? odd : even;
+        const double *x = phase + q + j / 2;
+        const __m512d x0 = _mm512_loadu_pd(x);
+        const __m512d x1 = _mm512_loadu_pd(x + 8);
+        const __m512d fl = _mm512_set1_pd(Lo_D[filterSize - j - 1]);
+        const __m512d fh = _mm512_set1_pd(Ho_D[filterSize - j - 1]);
+        lo0 = _mm512_fmadd_pd(x0, fl, lo0);
+        lo1 = _mm512_fmadd_pd(x1, fl, lo1);
+        hi0 = _mm512_fmadd_pd(x0, fh, hi0);
+        hi1 = _mm512_fmadd_pd(x1, fh, hi1);
+      }
+      _mm512_storeu_pd(a + q, lo0);
+      _mm512_storeu_pd(a + q + 8, lo1);
+      _mm512_storeu_pd(d + q, hi0);
+      _mm512_storeu_pd(d + q + 8, hi1);
+    }
+    dwt_phase_tail_fma(even, odd, Lo_D, Ho_D, filterSize, a, d, q, count);
+  }
+}
+
+/**
+ * AVX-512 single level dwt, 32 coefficient pairs per iteration.
+ */
+__attribute__((target("avx512f"))) static void
+dwt_analysis_f32_avx512(const float *signal, size_t signalSize,
+                        const float *Lo_D, const float *Ho_D,
+                        size_t filterSize, float *cA, float *cD, size_t first,
+                        size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_scalar(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD,
+                        first, last);
+    return;
+  }
+  size_t interiorFirst, interiorLast;
+  dwt_boundaries(signal, signalSize, Lo_D, Ho_D, filterSize, cA, cD, first,
+                 last, interiorFirst, interiorLast, true);
+
+  float even[kPhaseBlock + kMaxPhaseFilter / 2];
+  float odd[kPhaseBlock + kMaxPhaseFilter / 2];
+  for (size_t k0 = interiorFirst; k0 < interiorLast; k0 += kPhaseBlock) {
+    const size_t count = interiorLast - k0 < kPhaseBlock ? interiorLast - k0
+                                                         : kPhaseBlock;
+    dwt_split_phases(signal, filterSize, k0, count, even, odd);
+    float *a = cA + k0;
+    float *d = cD + k0;
+    size_t q = 0;
+    for (; q + 32 <= count; q += 32) {
+      __m512 lo0 = _mm512_setzero_ps();
+      __m512 lo1 = _mm512_setzero_ps();
+      __m512 hi0 = _mm512_setzero_ps();
+      __m512 hi1 = _mm512_setzero_ps();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const float *phase = (j & 1) ? odd : even;
+        const float *x = phase + q + j / 2;
+        const __m512 x0 = _mm512_loadu_ps(x);
+        const __m512 x1 = _mm512_loadu_ps(x + 16);
+        const __m512 fl = _mm512_set1_ps(Lo_D[filterSize - j - 1]);
+        const __m512 fh = _mm512_set1_ps(Ho_D[filterSize - j - 1]);
+        lo0 = _mm512_fmadd_ps(x0, fl, lo0);
+        lo1 = _mm512_fmadd_ps(x1, fl, lo1);
+        hi0 = _mm512_fmadd_ps(x0, fh, hi0);
+        hi1 = _mm512_fmadd_ps(x1, fh, hi1);
+      }
+      _mm512_storeu_ps(a + q, lo0);
+      _mm512_storeu_ps(a + q + 16, lo1);
+      _mm512_storeu_ps(d + q, hi0);
+      _mm512_storeu_ps(d + q + 16, hi1);
+    }
+    dwt_phase_tail_fma(even, odd, Lo_D, Ho_D, filterSize, a, d, q, count);
+  }
+}
+/**
+ * AVX-512 lifting step, 16 samples per iteration and a masked tail.
+ */
+__attribute__((target("avx512f"))) static void
+lifting_step_avx512(double *target, const double *source, double coeff,
+                    size_t count) {
+  const __m512d c = _mm512_set1_pd(coeff);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m512d t0 = _mm512_loadu_pd(target + i);
+    const __m512d t1 = _mm512_loadu_pd(target + i + 8);
+    _mm512_storeu_pd(target + i,
+                     _mm512_fmadd_pd(c, _mm512_loadu_pd(source + i), t0));
+    _mm512_storeu_pd(target + i + 8,
+                     _mm512_fmadd_pd(c, _mm512_loadu_pd(source + i + 8), t1));
+  }
+  for (; i < count; i += 8) {
+    const size_t remaining = count - i;
+    const __mmask8 mask =
+        remaining >= 8 ? 0xFF : static_cast<__mmask8>((1u << remaining) - 1);
+    const __m512d t = _mm512_maskz_loadu_pd(mask, target + i);
+    const __m512d x = _mm512_maskz_loadu_pd(mask, source + i);
+    _mm512_mask_storeu_pd(target + i, mask, _mm512_fmadd_pd(c, x, t));
+  }
+}
+
+/**
+ * AVX-512 single level idwt, 16 output pairs per iteration.
+ */
+__attribute__((target("avx512f"))) static void
+idwt_synthesis_avx512(const double *cA, const double *cD, const double *Lo_R,
+                      const double *Ho_R, size_t filterSize, double *output,
+                      size_t first, size_t last) {
+  if (first & 1) {
+    idwt_synthesis_fma(cA, cD, Lo_R, Ho_R, filterSize, output, first,
+                       first + 1 < last ? first + 1 : last);
+    ++first;
+  }
+  const __m512i lowHalf = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+  const __m512i highHalf = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+  size_t i = first;
+  for (; i + 32 <= last; i += 32) {
+    const double *a = cA + i / 2;
+    const double *d = cD + i / 2;
+    __m512d even0 = _mm512_setzero_pd();
+    __m512d even1 = _mm512_setzero_pd();
+    __m512d odd0 = _mm512_setzero_pd();
+    __m512d odd1 = _mm512_setzero_pd();
+    for (size_t s = 0; s < filterSize / 2; ++s) {
+      const size_t tap = filterSize - 2 - 2 * s;
+      const __m512d a0 = _mm512_loadu_pd(a + s);
+      const __m512d a1 = _mm512_loadu_pd(a + s + 8);
+      const __m512d d0 = _mm512_loadu_pd(d + s);
+      const __m512d d1 = _mm512_loadu_pd(d + s + 8);
+      const __m512d le = _mm512_set1_pd(Lo_R[tap]);
+      const __m512d lo = _mm512_set1_pd(Lo_R[tap + 1]);
+      const __m512d he = _mm512_set1_pd(Ho_R[tap]);
+      const __m512d ho = _mm512_set1_pd(Ho_R[tap + 1]);
+      even0 = _mm512_fmadd_pd(a0, le, even0);
+      even1 = _mm512_fmadd_pd(a1, le, even1);
+      odd0 = _mm512_fmadd_pd(a0, lo, odd0);
+      odd1 = _mm512_fmadd_pd(a1, lo, odd1);
+      even0 = _mm512_fmadd_pd(d0, he, even0);
+      even1 = _mm512_fmadd_pd(d1, he, even1);
+      odd0 = _mm512_fmadd_pd(d0, ho, odd0);
+      odd1 = _mm512_fmadd_pd(d1, ho, odd1);
+    }
+    _mm512_storeu_pd(output + i,
+                     _mm512_permutex2var_pd(even0, lowHalf, odd0));
+    _mm512_storeu_pd(output + i + 8,
+                     _mm512_permutex2var_pd(even0, highHalf, odd0));
+    _mm512_storeu_pd(output + i + 16,
+                     _mm512_permutex2var_pd(even1, lowHalf, odd1));
+    _mm512_storeu_pd(output + i + 24,
+                     _mm512_permutex2var_pd(even1, highHalf, odd1));
+  }
+  idwt_synthesis_fma(cA, cD, Lo_R, Ho_R, filterSize, output, i, last);
+}
+
+/**
+ * AVX-512 interleaved multichannel dwt, 16 channels per iteration and a
+ * masked tail.
+ */
+__attribute__((target("avx512f"))) static void
+dwt_analysis_interleaved_avx512(const double *signal, size_t signalSize,
+                                size_t channels, size_t stride,
+                                const double *Lo_D, const double *Ho_D,
+                                size_t filterSize, double *cA,
+                                double *cD, size_t first, size_t last) {
+  if (filterSize > kMaxPhaseFilter) {
+    dwt_analysis_interleaved_scalar(signal, signalSize, channels, stride,
+                                    Lo_D, Ho_D, filterSize, cA, cD, first,
+                                    last);
+    return;
+  }
+  size_t offsets[kMaxPhaseFilter];
+  for (size_t k = first; k < last; ++k) {
+    dwt_tap_offsets(signalSize, stride, filterSize, k, offsets);
+    double *a = cA + k * stride;
+    double *d = cD + k * stride;
+    size_t c = 0;
+    for (; c + 16 <= channels; c += 16) {
+      __m512d lo0 = _mm512_setzero_pd();
+      __m512d lo1 = _mm512_setzero_pd();
+      __m512d hi0 = _mm512_setzero_pd();
+      __m512d hi1 = _mm512_setzero_pd();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const double *x = signal + offsets[j] + c;
+        const __m512d x0 = _mm512_loadu_pd(x);
+        const __m512d x1 = _mm512_loadu_pd(x + 8);
+        const __m512d fl = _mm512_set1_pd(Lo_D[filterSize - j - 1]);
+        const __m512d fh = _mm512_set1_pd(Ho_D[filterSize - j - 1]);
+        lo0 = _mm512_fmadd_pd(x0, fl, lo0);
+        lo1 = _mm512_fmadd_pd(x1, fl, lo1);
+        hi0 = _mm512_fmadd_pd(x0, fh, hi0);
+        hi1 = _mm512_fmadd_pd(x1, fh, hi1);
+      }
+      _mm512_storeu_pd(a + c, lo0);
+      _mm512_storeu_pd(a + c + 8, lo1);
+      _mm512_storeu_pd(d + c, hi0);
+      _mm512_storeu_pd(d + c + 8, hi1);
+    }
+    for (; c < channels; c += 8) {
+      const size_t remaining = channels - c;
+      const __mmask8 mask =
+          remaining >= 8 ? 0xFF : static_cast<__mmask8>((1u << remaining) - 1);
+      __m512d lo = _mm512_setzero_pd();
+      __m512d hi = _mm512_setzero_pd();
+      for (size_t j = 0; j < filterSize; ++j) {
+        const __m512d x =
+            _mm512_maskz_loadu_pd(mask, signal + offsets[j] + c);
+        lo = _mm512_fmadd_pd(x, _mm512_set1_pd(Lo_D[filterSize - j - 1]), lo);
+        hi = _mm512_fmadd_pd(x, _mm512_set1_pd(Ho_D[filterSize - j - 1]), hi);
+      }
+      _mm512_mask_storeu_pd(a + c, mask, lo);
+      _mm512_mask_storeu_pd(d + c, mask, hi);
+    }
+  }
+}
+/**
+ * AVX-512 a trous analysis, 16 coefficient pairs per iteration and a masked
+ * tail.
+ */
+__attribute__((target("avx512f"))) static void
+swt_analysis_avx512(const double *signal, size_t outputSize, size_t step,
+                    const double *Lo_D, const double *Ho_D, size_t filterSize,
+                    double *cA, double *cD) {
+  size_t i = 0;
+  for (; i + 16 <= outputSize; i += 16) {
+    __m512d lo0 = _mm512_setzero_pd();
+    __m512d lo1 = _mm512_setzero_pd();
+    __m512d hi0 = _mm512_setzero_pd();
+    __m512d hi1 = _mm512_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double *x = signal + i + j * step;
+      const __m512d x0 = _mm512_loadu_pd(x);
+      const __m512d x1 = _mm512_loadu_pd(x + 8);
+      const __m512d fl = _mm512_set1_pd(Lo_D[filterSize - j - 1]);
+      const __m512d fh = _mm512_set1_pd(Ho_D[filterSize - j - 1]);
+      lo0 = _mm512_fmadd_pd(x0, fl, lo0);
+      lo1 = _mm512_fmadd_pd(x1, fl, lo1);
+      hi0 = _mm512_fmadd_pd(x0, fh, hi0);
+      hi1 = _mm512_fmadd_pd(x1, fh, hi1);
+    }
+    _mm512_storeu_pd(cA + i, lo0);
+    _mm512_storeu_pd(cA + i + 8, lo1);
+    _mm512_storeu_pd(cD + i, hi0);
+    _mm512_storeu_pd(cD + i + 8, hi1);
+  }
+  for (; i < outputSize; i += 8) {
+    const size_t remaining = outputSize - i;
+    const __mmask8 mask =
+        remaining >= 8 ? 0xFF : static_cast<__mmask8>((1u << remaining) - 1);
+    __m512d lo = _mm512_setzero_pd();
+    __m512d hi = _mm512_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const __m512d x = _mm512_maskz_loadu_pd(mask, signal + i + j * step);
+      lo = _mm512_fmadd_pd(x, _mm512_set1_pd(Lo_D[filterSize - j - 1]), lo);
+      hi = _mm512_fmadd_pd(x, _mm512_set1_pd(Ho_D[filterSize - j - 1]), hi);
+    }
+    _mm512_mask_storeu_pd(cA + i, mask, lo);
+    _mm512_mask_storeu_pd(cD + i, mask, hi);
+  }
+}
+
+/**
+ * AVX-512 a trous synthesis, 16 samples per iteration and a masked tail.
+ */
+__attribute__((target("avx512f"))) static void
+swt_synthesis_avx512(const double *cA, const double *cD, size_t outputSize,
+                     size_t step, const double *Lo_R, const double *Ho_R,
+                     size_t filterSize, double *output) {
+  size_t i = 0;
+  for (; i + 16 <= outputSize; i += 16) {
+    __m512d x0 = _mm512_setzero_pd();
+    __m512d x1 = _mm512_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const double *a = cA + i + j * step;
+      const double *d = cD + i + j * step;
+      const __m512d fl = _mm512_set1_pd(Lo_R[filterSize - j - 1]);
+      const __m512d fh = _mm512_set1_pd(Ho_R[filterSize - j - 1]);
+      x0 = _mm512_fmadd_pd(_mm512_loadu_pd(a), fl, x0);
+      x1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + 8), fl, x1);
+      x0 = _mm512_fmadd_pd(_mm512_loadu_pd(d), fh, x0);
+      x1 = _mm512_fmadd_pd(_mm512_loadu_pd(d + 8), fh, x1);
+    }
+    _mm512_storeu_pd(output + i, x0);
+    _mm512_storeu_pd(output + i + 8, x1);
+  }
+  for (; i < outputSize; i += 8) {
+    const size_t remaining = outputSize - i;
+    const __mmask8 mask =
+        remaining >= 8 ? 0xFF : static_cast<__mmask8>((1u << remaining) - 1);
+    __m512d x = _mm512_setzero_pd();
+    for (size_t j = 0; j < filterSize; ++j) {
+      const size_t offset = i + j * step;
+      x = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, cA + offset),
+                          _mm512_set1_pd(Lo_R[filterSize - j - 1]), x);
+      x = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, cD + offset),
+                          _mm512_set1_pd(Ho_R[filterSize - j - 1]), x);
+    }
+    _mm512_mask_storeu_pd(output + i, mask, x);
+  }
+}
+/**
+ * AVX-512 threshold of one vector, with the mask register of
+ * |x| > threshold zeroing the other lanes and the sign bit for copysign.
+ */
+__attribute__((target("avx512f"))) static inline __m512d
+threshold_vector_avx512(__m512d x, ThresholdKind kind, __m512d threshold,
+                        __m512d square, __m512d scale) {
+  const __m512i sign = _mm512_set1_epi64(INT64_MIN);
+  const __m512d a = _mm512_abs_pd(x);
+  const __m512i xSign = _mm512_and_epi64(_mm512_castpd_si512(x), sign);
+  const __mmask8 above = _mm512_cmp_pd_mask(a, threshold, _CMP_GT_OQ);
+  switch (kind) {
+  case ThresholdKind::Hard:
+    return _mm512_maskz_mov_pd(above, x);
+  case ThresholdKind::Soft:
+    return _mm512_castsi512_pd(_mm512_maskz_or_epi64(
+        above, _mm512_castpd_si512(_mm512_maskz_sub_pd(above, a, threshold)),
+        xSign));
+  case ThresholdKind::Garrote:
+    return _mm512_maskz_sub_pd(above, x, _mm512_div_pd(square, x));
+  default:
+    return _mm512_castsi512_pd(_mm512_maskz_or_epi64(
+        above,
+        _mm512_castpd_si512(_mm512_maskz_min_pd(
+            above, _mm512_mul_pd(scale, _mm512_sub_pd(a, threshold)), a)),
+        xSign));
+  }
+}
+
+/**
+ * AVX-512 thresholding in place, 16 coefficients per iteration and a masked
+ * tail.
+ */
+__attribute__((target("avx512f"))) static void
+threshold_avx512(double *x, size_t count, ThresholdKind kind,
+                 double threshold, double high) {
+  const __m512d t = _mm512_set1_pd(threshold);
+  const __m512d square = _mm512_set1_pd(threshold * threshold);
+  const __m512d scale = _mm512_set1_pd(firm_scale(kind, threshold, high));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m512d x0 = _mm512_loadu_pd(x + i);
+    const __m512d x1 = _mm512_loadu_pd(x + i + 8);
+    _mm512_storeu_pd(x + i,
+                     threshold_vector_avx512(x0, kind, t, square, scale));
+    _mm512_storeu_pd(x + i + 8,
+                     threshold_vector_avx512(x1, kind, t, square, scale));
+  }
+  for (; i < count; i += 8) {
+    const size_t remaining = count - i;
+    const __mmask8 mask =
+        remaining >= 8 ? 0xFF : static_cast<__mmask8>((1u << remaining) - 1);
+    const __m512d x0 = _mm512_maskz_loadu_pd(mask, x + i);
+    _mm512_mask_storeu_pd(x + i, mask,
+                          threshold_vector_avx512(x0, kind, t, square, scale));
+  }
+}
+#endif
+
+//-------------------------------------------------------------
+// dispatch
+
+static const KernelTable kScalarKernels = {
+    KernelIsa::Scalar, "scalar", 24, conv_valid_scalar, dwt_analysis_scalar,
+    lifting_step_scalar, idwt_synthesis_scalar, dwt_analysis_scalar,
+    dwt_analysis_interleaved_scalar, swt_analysis_scalar,
+    swt_synthesis_scalar, threshold_scalar};
+
+#ifdef CODEWAVELETS_X86
+static const KernelTable kSse2Kernels = {
+    KernelIsa::SSE2, "sse2", 80, conv_valid_sse2, dwt_analysis_sse2,
+    lifting_step_sse2, idwt_synthesis_sse2, dwt_analysis_f32_sse2,
+    dwt_analysis_interleaved_sse2, swt_analysis_sse2, swt_synthesis_sse2,
+    threshold_sse2};
+
+static const KernelTable kAvx2Kernels = {
+    KernelIsa::AVX2, "avx2", 256, conv_valid_avx2, dwt_analysis_avx2,
+    lifting_step_avx2, idwt_synthesis_avx2, dwt_analysis_f32_avx2,
+    dwt_analysis_interleaved_avx2, swt_analysis_avx2, swt_synthesis_avx2,
+    threshold_avx2};
+
+static const KernelTable kAvx512Kernels = {
+    KernelIsa::AVX512, "avx512", 384, conv_valid_avx512, dwt_analysis_avx512,
+    lifting_step_avx512, idwt_synthesis_avx512, dwt_analysis_f32_avx512,
+    dwt_analysis_interleaved_avx512, swt_analysis_avx512,
+    swt_synthesis_avx512, threshold_avx512};
+#endif
+
+/**
+ * Checks whether the running CPU (and OS) supports an instruction set
+ * variant.
+ *
+ * @param isa The instruction set variant.
+ * @return True if the kernels of that variant can run.
+ */
+bool kernel_isa_supported(KernelIsa isa) {
+  if (isa == KernelIsa::Scalar) {
+    return true;
+  }
+#ifdef CODEWAVELETS_X86
+  __builtin_cpu_init();
+  switch (isa) {
+  case KernelIsa::SSE2:
+    return __builtin_cpu_supports("sse2");
+  case KernelIsa::AVX2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case KernelIsa::AVX512:
+    return __builtin_cpu_supports("avx512f");
+  default:
+    break;
+  }
+#endif
+  return false;
+}
+
+/**
+ * Returns the kernels of one instruction set variant.
+ *
+ * @param isa The instruction set variant.
+ * @return The kernel table.
+ */
+const KernelTable &kernel_table(KernelIsa isa) {
+  if (!kernel_isa_supported(isa)) {
+    throw std::runtime_error("Kernel isa is not supported!");
+  }
+#ifdef CODEWAVELETS_X86
+  switch (isa) {
+  case KernelIsa::SSE2:
+    return kSse2Kernels;
+  case KernelIsa::AVX2:
+    return kAvx2Kernels;
+  case KernelIsa::AVX512:
+    return kAvx512Kernels;
+  default:
+    break;
+  }
+#endif
+  return kScalarKernels;
+}
+
+/**
+ * Picks the widest supported variant. The CODEWAVELETS_ISA environment
+ * variable ("scalar", "sse2", "avx2" or "avx512") caps the choice; unknown
+ * values are ignored.
+ *
+ * @return The selected kernel table.
+ */
+static const KernelTable &select_kernels() {
+  KernelIsa limit = KernelIsa::AVX512;
+  if (const char *requested = std::getenv("CODEWAVELETS_ISA")) {
+    if (std::strcmp(requested, "scalar") == 0) {
+      limit = KernelIsa::Scalar;
+    } else if (std::strcmp(requested, "sse2") == 0) {
+      limit = KernelIsa::SSE2;
+    } else if (std::strcmp(requested, "avx2") == 0) {
+      limit = KernelIsa::AVX2;
+    }
+  }
+  for (KernelIsa isa : {KernelIsa::AVX512, KernelIsa::AVX2, KernelIsa::SSE2}) {
+    if (isa <= limit && kernel_isa_supported(isa)) {
+      return kernel_table(isa);
+    }
+  }
+  return kScalarKernels;
+}
+
+/**
+ * Returns the kernels selected for this process. The selection happens once,
+ * on first use.
+ *
+ * @return The active kernel table.
+ */
+const KernelTable &active_kernels() {
+  static const KernelTable &table = select_kernels();
+  return table;
+}
+
+/**
+ * Reports which instruction set variant the library is running.
+ *
+ * @return "scalar", "sse2", "avx2" or "avx512".
+ */
+const char *active_kernel_isa() { return active_kernels().name; }
+
+/**
+ * Computes the "valid" part of the convolution of input with filter,
+ * output[i] = sum_j input[i + j] * filter[filterSize - j - 1].
+ *
+ * @param input The input signal.
+ * @param inputSize The input length, at least filterSize.
+ * @param filter The filter.
+ * @param filterSize The filter length.
+ * @param output The result, inputSize - filterSize + 1 values.
+ */
+void conv_valid(const double *input, size_t inputSize, const double *filter,
+                size_t filterSize, double *output) {
+  active_kernels().conv_valid(input, inputSize - filterSize + 1, filter,
+                              filterSize, output);
+}
+
+/**
+ * Computes the full convolution of input with filter directly in O(n * m),
+ * output[i] = sum_j input[j] * filter[i - j]. The part where the filter
+ * fully overlaps the input goes through the vectorized "valid" kernel, the
+ * two partial overlaps at the ends are summed directly.
+ *
+ * @param input The input signal.
+ * @param inputSize The input length.
+ * @param filter The filter.
+ * @param filterSize The filter length.
+ * @param output The result, inputSize + filterSize - 1 values.
+ */
+void conv_full(const double *input, size_t inputSize, const double *filter,
+               size_t filterSize, double *output) {
+  // the full convolution is symmetric in its operands, let the longer one
+  // play the input so that the middle part is a "valid" convolution
+  if (inputSize < filterSize) {
+    std::swap(input, filter);
+    std::swap(inputSize, filterSize);
+  }
+  const size_t n = inputSize;
+  const size_t m = filterSize;
+
+  for (size_t i = 0; i + 1 < m; ++i) {
+    double acc = 0.0;
+    for (size_t j = 0; j <= i; ++j) {
+      acc += input[j] * filter[i - j];
+    }
+    output[i] = acc;
+  }
+  active_kernels().conv_valid(input, n - m + 1, filter, m, output + m - 1);
+  for (size_t i = n; i < n + m - 1; ++i) {
+    double acc = 0.0;
+    for (size_t j = i - m + 1; j < n; ++j) {
+      acc += input[j] * filter[i - j];
+    }
+    output[i] = acc;
+  }
+}
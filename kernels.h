@@ -0,0 +1,98 @@
+#ifndef kernels_h
+#define kernels_h
+
+#include <cstddef>
+
+// Instruction set variants of the numeric kernels, from narrowest to widest.
+enum class KernelIsa { Scalar, SSE2, AVX2, AVX512 };
+
+// Shrinkages of the threshold kernel: hard keeps x when |x| > t, soft
+// shrinks |x| by t, the non-negative garrote gives x - t^2 / x when |x| > t,
+// and firm is 0 up to t, x from high on, and linear in between. All give +0
+// for |x| <= t and for NaN, whatever the instruction set.
+enum class ThresholdKind { Hard, Soft, Garrote, Firm };
+
+// One instruction set variant of every kernel behind wconv1 and dwt.
+struct KernelTable {
+  KernelIsa isa;
+  const char *name;
+
+  // shortest operand length from which a "full" convolution is cheaper
+  // through the FFT than with conv_valid, measured on n = 2^18 inputs
+  size_t fft_conv_threshold;
+
+  // output[i] = sum_j input[i + j] * filter[filterSize - j - 1] for
+  // i = 0 .. outputSize - 1
+  void (*conv_valid)(const double *input, size_t outputSize,
+                     const double *filter, size_t filterSize, double *output);
+
+  // cA[k] / cD[k] of a single level "sym" dwt for k = first .. last - 1
+  void (*dwt_analysis)(const double *signal, size_t signalSize,
+                       const double *Lo_D, const double *Ho_D,
+                       size_t filterSize, double *cA, double *cD, size_t first,
+                       size_t last);
+
+  // target[i] += coeff * source[i] for i = 0 .. count - 1
+  void (*lifting_step)(double *target, const double *source, double coeff,
+                       size_t count);
+
+  // output[i] of a single level "sym" idwt for i = first .. last - 1, from
+  // the upsampled cA and cD convolved with the even length filters Lo_R and
+  // Ho_R; output i reads cA and cD at i / 2 .. i / 2 + filterSize / 2 - 1
+  void (*idwt_synthesis)(const double *cA, const double *cD,
+                         const double *Lo_R, const double *Ho_R,
+                         size_t filterSize, double *output, size_t first,
+                         size_t last);
+
+  // dwt_analysis on float samples and filters, twice as many per vector
+  void (*dwt_analysis_f32)(const float *signal, size_t signalSize,
+                           const float *Lo_D, const float *Ho_D,
+                           size_t filterSize, float *cA, float *cD,
+                           size_t first, size_t last);
+
+  // dwt_analysis of channels signals stored interleaved, sample i of channel
+  // c at signal[i * stride + c], with coefficient k of channel c written to
+  // cA[k * stride + c] / cD[k * stride + c]; one vector lane per channel.
+  // stride = channels for a plain interleaved block, wider for a strip of
+  // the columns of a matrix.
+  void (*dwt_analysis_interleaved)(const double *signal, size_t signalSize,
+                                   size_t channels, size_t stride,
+                                   const double *Lo_D, const double *Ho_D,
+                                   size_t filterSize, double *cA, double *cD,
+                                   size_t first, size_t last);
+
+  // cA[i] / cD[i] = sum_j signal[i + j * step] * Lo_D / Ho_D[filterSize - j -
+  // 1] for i = 0 .. outputSize - 1, "valid" convolutions with the filters
+  // dilated by step, reading every step-th sample instead of multiplying the
+  // zeros in between; the a trous filters of swt level log2(step) + 1
+  void (*swt_analysis)(const double *signal, size_t outputSize, size_t step,
+                       const double *Lo_D, const double *Ho_D,
+                       size_t filterSize, double *cA, double *cD);
+
+  // output[i] = sum_j cA[i + j * step] * Lo_R[filterSize - j - 1] +
+  // cD[i + j * step] * Ho_R[filterSize - j - 1], the synthesis counterpart
+  void (*swt_synthesis)(const double *cA, const double *cD, size_t outputSize,
+                        size_t step, const double *Lo_R, const double *Ho_R,
+                        size_t filterSize, double *output);
+
+  // x[i] = shrinkage of x[i] for i = 0 .. count - 1, branch free with
+  // comparison masks; high > threshold is only read by the firm shrinkage
+  void (*threshold)(double *x, size_t count, ThresholdKind kind,
+                    double threshold, double high);
+};
+
+bool kernel_isa_supported(KernelIsa isa);
+
+const KernelTable &kernel_table(KernelIsa isa);
+
+const KernelTable &active_kernels();
+
+const char *active_kernel_isa();
+
+void conv_valid(const double *input, size_t inputSize, const double *filter,
+                size_t filterSize, double *output);
+
+void conv_full(const double *input, size_t inputSize, const double *filter,
+               size_t filterSize, double *output);
+
+#endif /* kernels_h */
@@ -0,0 +1,507 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "kernels.h"
+#include "lifting.h"
+
+// Polyphase matrix [Pe Po; Qe Qo] of a filter bank, one row major 2x2
+// coefficient per power of z. z^m stands for the shift x[k + m], as the
+// outputs of dwt() are correlations of the signal with the reversed filters.
+typedef std::vector<std::array<double, 4>> Polyphase;
+
+// outputs per tile when the lifting steps run fused, two buffers of this
+// size stay in L1
+static const ptrdiff_t kLiftingTile = 512;
+
+static Polyphase filter_polyphase(const std::vector<double> &Lo_D,
+                                  const std::vector<double> &Ho_D) {
+  const size_t L = Lo_D.size();
+  Polyphase M(L / 2);
+  for (size_t m = 0; m < L / 2; ++m) {
+    M[m] = {Lo_D[L - 1 - 2 * m], Lo_D[L - 2 - 2 * m], Ho_D[L - 1 - 2 * m],
+            Ho_D[L - 2 - 2 * m]};
+  }
+  return M;
+}
+
+/**
+ * Evaluates the lattice
+ *   M(z) = R(angles[N-1]) Lambda(z) ... Lambda(z) R(angles[0]) F
+ * with R a rotation, Lambda(z) = diag(1, z) and F = diag(1, -1) for a
+ * reflection, diag(1, 1) otherwise.
+ */
+static Polyphase lattice_polyphase(const std::vector<double> &angles,
+                                   bool reflect) {
+  const size_t N = angles.size();
+  const double sign = reflect ? -1.0 : 1.0;
+  Polyphase M(N, {0.0, 0.0, 0.0, 0.0});
+  double c = std::cos(angles[0]);
+  double s = std::sin(angles[0]);
+  M[0] = {c, -s * sign, s, c * sign};
+  for (size_t j = 1; j < N; ++j) {
+    // Lambda(z) moves the second row up one power
+    for (size_t m = j; m > 0; --m) {
+      M[m][2] = M[m - 1][2];
+      M[m][3] = M[m - 1][3];
+    }
+    M[0][2] = 0.0;
+    M[0][3] = 0.0;
+    c = std::cos(angles[j]);
+    s = std::sin(angles[j]);
+    for (size_t m = 0; m <= j; ++m) {
+      const std::array<double, 4> row = M[m];
+      M[m] = {c * row[0] - s * row[2], c * row[1] - s * row[3],
+              s * row[0] + c * row[2], s * row[1] + c * row[3]};
+    }
+  }
+  return M;
+}
+
+/**
+ * Estimates the lattice angles by degree reduction: the rotation R^T that
+ * clears the first row of the highest coefficient also clears the second row
+ * of the constant one, so Lambda(z)^-1 R^T M(z) has one power less. Both
+ * coefficients have rank one, the rotation is taken from the largest column
+ * of the larger one.
+ */
+static std::vector<double> peel_lattice(Polyphase M, bool &reflect) {
+  std::vector<double> angles;
+  while (M.size() > 1) {
+    const std::array<double, 4> &T = M.back();
+    const std::array<double, 4> &B = M.front();
+    auto norm = [](const std::array<double, 4> &X, int col) {
+      return std::fabs(X[col]) + std::fabs(X[2 + col]);
+    };
+    double c, s;
+    if (norm(T, 0) + norm(T, 1) >= norm(B, 0) + norm(B, 1)) {
+      const int col = norm(T, 0) >= norm(T, 1) ? 0 : 1;
+      const double r = std::hypot(T[col], T[2 + col]);
+      c = T[2 + col] / r;
+      s = -T[col] / r;
+    } else {
+      const int col = norm(B, 0) >= norm(B, 1) ? 0 : 1;
+      const double r = std::hypot(B[col], B[2 + col]);
+      c = B[col] / r;
+      s = B[2 + col] / r;
+    }
+
+    Polyphase reduced(M.size() - 1);
+    for (size_t m = 0; m + 1 < M.size(); ++m) {
+      const std::array<double, 4> &row0 = M[m];
+      const std::array<double, 4> &row1 = M[m + 1];
+      reduced[m] = {c * row0[0] + s * row0[2], c * row0[1] + s * row0[3],
+                    -s * row1[0] + c * row1[2], -s * row1[1] + c * row1[3]};
+    }
+    angles.push_back(std::atan2(s, c));
+    M = std::move(reduced);
+  }
+  const std::array<double, 4> &R = M.front();
+  reflect = R[0] * R[3] - R[1] * R[2] < 0.0;
+  angles.push_back(std::atan2(R[2], R[0]));
+  std::reverse(angles.begin(), angles.end());
+  return angles;
+}
+
+/**
+ * Refines the lattice angles by Gauss-Newton iterations on the difference to
+ * the filters. The degree reduction loses accuracy for long filters, whose
+ * outer coefficients are tiny, while the lattice itself is well conditioned.
+ *
+ * @return The largest remaining difference to the filters.
+ */
+static double refine_lattice(std::vector<double> &angles, bool reflect,
+                             const Polyphase &target) {
+  const size_t N = angles.size();
+  const size_t R = 4 * N;
+  const double eps = 1e-7;
+  std::vector<double> residual(R), jacobian(R * N);
+
+  // returns the sum of squares of the residual
+  auto evaluate = [&](const std::vector<double> &a, double *out) {
+    const Polyphase M = lattice_polyphase(a, reflect);
+    double sum = 0.0;
+    for (size_t m = 0; m < N; ++m) {
+      for (size_t e = 0; e < 4; ++e) {
+        out[4 * m + e] = M[m][e] - target[m][e];
+        sum += out[4 * m + e] * out[4 * m + e];
+      }
+    }
+    return sum;
+  };
+
+  double sum = evaluate(angles, residual.data());
+  for (int iteration = 0; iteration < 30 && sum > 0.0; ++iteration) {
+    // central differences, column i of the R x N jacobian
+    std::vector<double> plus(R), minus(R), shifted = angles;
+    for (size_t i = 0; i < N; ++i) {
+      shifted[i] = angles[i] + eps;
+      evaluate(shifted, plus.data());
+      shifted[i] = angles[i] - eps;
+      evaluate(shifted, minus.data());
+      shifted[i] = angles[i];
+      for (size_t r = 0; r < R; ++r) {
+        jacobian[r * N + i] = (plus[r] - minus[r]) / (2.0 * eps);
+      }
+    }
+
+    // normal equations J^T J step = -J^T residual, by gaussian elimination
+    std::vector<double> A(N * N), b(N);
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t j = 0; j < N; ++j) {
+        double acc = 0.0;
+        for (size_t r = 0; r < R; ++r) {
+          acc += jacobian[r * N + i] * jacobian[r * N + j];
+        }
+        A[i * N + j] = acc;
+      }
+      double acc = 0.0;
+      for (size_t r = 0; r < R; ++r) {
+        acc -= jacobian[r * N + i] * residual[r];
+      }
+      b[i] = acc;
+    }
+    for (size_t col = 0; col < N; ++col) {
+      size_t pivot = col;
+      for (size_t row = col + 1; row < N; ++row) {
+        if (std::fabs(A[row * N + col]) > std::fabs(A[pivot * N + col])) {
+          pivot = row;
+        }
+      }
+      for (size_t j = 0; j < N; ++j) {
+        std::swap(A[col * N + j], A[pivot * N + j]);
+      }
+      std::swap(b[col], b[pivot]);
+      for (size_t row = col + 1; row < N; ++row) {
+        const double factor = A[row * N + col] / A[col * N + col];
+        for (size_t j = col; j < N; ++j) {
+          A[row * N + j] -= factor * A[col * N + j];
+        }
+        b[row] -= factor * b[col];
+      }
+    }
+    for (size_t i = N; i-- > 0;) {
+      double acc = b[i];
+      for (size_t j = i + 1; j < N; ++j) {
+        acc -= A[i * N + j] * b[j];
+      }
+      b[i] = acc / A[i * N + i];
+    }
+
+    // halve the step until it reduces the residual, far from the solution
+    // the full step can overshoot, and a singular system gives no step
+    std::vector<double> trial(N), trialResidual(R);
+    double factor = 1.0;
+    double trialSum = sum;
+    for (int halving = 0; halving < 20; ++halving, factor *= 0.5) {
+      for (size_t i = 0; i < N; ++i) {
+        trial[i] = angles[i] + factor * b[i];
+      }
+      trialSum = evaluate(trial, trialResidual.data());
+      if (trialSum < sum) {
+        break;
+      }
+    }
+    if (!(trialSum < sum)) {
+      break;
+    }
+    angles = trial;
+    residual = trialResidual;
+    sum = trialSum;
+  }
+
+  double error = 0.0;
+  for (double r : residual) {
+    error = std::max(error, std::fabs(r));
+  }
+  return error;
+}
+
+// The "sym" extension is periodic with period 2 * signalSize.
+static double sym_extended(const double *signal, size_t signalSize,
+                           ptrdiff_t index) {
+  const ptrdiff_t period = 2 * static_cast<ptrdiff_t>(signalSize);
+  ptrdiff_t i = index % period;
+  if (i < 0) {
+    i += period;
+  }
+  if (i >= static_cast<ptrdiff_t>(signalSize)) {
+    i = period - 1 - i;
+  }
+  return signal[i];
+}
+
+/**
+ * Factorizes an orthogonal analysis filter bank into lifting steps.
+ *
+ * A rotation [c -s; s c] with |c| >= |s| is the update step -s / c, the
+ * scaling diag(c, 1 / c) and the predict step s / c. Otherwise it is first
+ * rotated by 90 degrees, which only swaps and negates the two channels.
+ *
+ * @param Lo_D The low pass decomposition filter.
+ * @param Ho_D The high pass decomposition filter, of the same even length.
+ */
+LiftingScheme::LiftingScheme(const std::vector<double> &Lo_D,
+                             const std::vector<double> &Ho_D)
+    : filterSize_(Lo_D.size()) {
+  if (Lo_D.empty() || Lo_D.size() != Ho_D.size() || Lo_D.size() % 2 != 0) {
+    throw std::runtime_error("Lifting filters must have the same even length!");
+  }
+
+  const Polyphase M = filter_polyphase(Lo_D, Ho_D);
+  bool reflect = false;
+  std::vector<double> angles = peel_lattice(M, reflect);
+  double scale = 0.0;
+  for (const auto &coeff : M) {
+    for (double value : coeff) {
+      scale = std::max(scale, std::fabs(value));
+    }
+  }
+  if (!(refine_lattice(angles, reflect, M) <= 1e-10 * scale)) {
+    throw std::runtime_error("Lifting needs an orthogonal filter bank!");
+  }
+
+  // the true channels are scales[i] * buffer[channel[i]][k + delay[i]],
+  // which absorbs delays, scalings and swaps without touching the buffers
+  int channel[2] = {0, 1};
+  int delay[2] = {0, 0};
+  double scales[2] = {1.0, reflect ? -1.0 : 1.0};
+  // true channel target += coeff * the other true channel
+  auto lift = [&](int target, double coeff) {
+    const int source = 1 - target;
+    steps_.push_back(LiftingStep{channel[target] == 1,
+                                 delay[source] - delay[target],
+                                 coeff * scales[source] / scales[target]});
+  };
+  for (size_t j = 0; j < angles.size(); ++j) {
+    if (j > 0) {
+      delay[1] += 1;
+    }
+    double c = std::cos(angles[j]);
+    double s = std::sin(angles[j]);
+    const bool swap = std::fabs(c) < std::fabs(s);
+    if (swap) {
+      // [c -s; s c] = [0 -1; 1 0] [s c; -c s]
+      const double t = c;
+      c = s;
+      s = -t;
+    }
+    lift(0, -s / c);
+    scales[0] *= c;
+    scales[1] /= c;
+    lift(1, s / c);
+    if (swap) {
+      std::swap(channel[0], channel[1]);
+      std::swap(delay[0], delay[1]);
+      const double t = scales[0];
+      scales[0] = -scales[1];
+      scales[1] = t;
+    }
+  }
+  lowOdd_ = channel[0] == 1;
+  lowScale_ = scales[0];
+  highScale_ = scales[1];
+  lowShift_ = delay[0];
+  highShift_ = delay[1];
+
+  // walk the steps backwards to find which polyphase samples the outputs
+  // depend on, relative to the output index
+  int first[2], last[2];
+  first[channel[0]] = last[channel[0]] = lowShift_;
+  first[channel[1]] = last[channel[1]] = highShift_;
+  for (auto step = steps_.rbegin(); step != steps_.rend(); ++step) {
+    const int target = step->predict ? 1 : 0;
+    const int source = 1 - target;
+    first[source] = std::min(first[source], first[target] + step->shift);
+    last[source] = std::max(last[source], last[target] + step->shift);
+  }
+  marginBefore_ = -std::min(first[0], first[1]);
+  marginAfter_ = std::max(last[0], last[1]);
+
+  // a step may only run over a tile once the steps before it have produced
+  // the samples it reads, and before it overwrites samples they still read
+  lags_.assign(steps_.size(), 0);
+  for (size_t i = 1; i < steps_.size(); ++i) {
+    int lag = lags_[0];
+    for (size_t j = 0; j < i; ++j) {
+      if (steps_[j].predict == steps_[i].predict) {
+        lag = std::max(lag, lags_[j]);
+      } else {
+        lag = std::max(lag, lags_[j] + std::max(steps_[i].shift,
+                                                -steps_[j].shift));
+      }
+    }
+    lags_[i] = lag;
+  }
+
+  touchFirst_ = 0;
+  touchLast_ = 0;
+  for (size_t i = 0; i < steps_.size(); ++i) {
+    const int shift = steps_[i].shift;
+    touchFirst_ = std::min(touchFirst_, std::min(0, shift) - lags_[i]);
+    touchLast_ = std::max(touchLast_, std::max(0, shift) - lags_[i]);
+  }
+  finalLag_[0] = finalLag_[1] = -touchLast_;
+  for (size_t i = 0; i < steps_.size(); ++i) {
+    const int target = steps_[i].predict ? 1 : 0;
+    finalLag_[target] = std::max(finalLag_[target], lags_[i]);
+  }
+
+  // samples near the start are not needed by any output, the first tile
+  // starts where the earliest step can run
+  firstTile_ = 0;
+  for (size_t i = 0; i < steps_.size(); ++i) {
+    const int iBegin = std::max(0, -steps_[i].shift) + lags_[i];
+    firstTile_ = i == 0 ? iBegin : std::min(firstTile_, iBegin);
+  }
+
+  // the largest span between the window start and the end of the next tile,
+  // from the three bounds on where analysis() keeps the window
+  const int lowBuffer = lowOdd_ ? 1 : 0;
+  const int minShift = std::min(lowShift_, highShift_);
+  const int pending = std::max(finalLag_[lowBuffer] + lowShift_,
+                               finalLag_[1 - lowBuffer] + highShift_) -
+                      minShift;
+  const int tile = static_cast<int>(kLiftingTile);
+  windowSize_ = std::max({firstTile_ + tile + touchLast_,
+                          tile + touchLast_ - touchFirst_,
+                          tile + touchLast_ + pending, marginAfter_ - minShift,
+                          tile});
+}
+
+/**
+ * Computes a single level "sym" dwt with the lifting steps, see the overload
+ * with a workspace.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples in the signal.
+ * @param cA The approximation coefficients, outputSize of them.
+ * @param cD The detail coefficients, outputSize of them.
+ * @param outputSize The number of coefficients, (signalSize + L - 1) / 2.
+ */
+void LiftingScheme::analysis(const double *signal, size_t signalSize,
+                             double *cA, double *cD, size_t outputSize) const {
+  std::vector<double> workspace(workspace_size());
+  analysis(signal, signalSize, cA, cD, outputSize, workspace.data());
+}
+
+/**
+ * Computes a single level "sym" dwt with the lifting steps. The steps run
+ * tile by tile over the even and odd samples of the extended signal, in the
+ * same order per sample as running them one after another over the whole
+ * signal. Only a window of a few tiles is kept: each tile splits the samples
+ * it needs from the signal, lifts them in place and writes out the
+ * coefficients that are final.
+ *
+ * @param signal The input signal.
+ * @param signalSize The number of samples in the signal.
+ * @param cA The approximation coefficients, outputSize of them.
+ * @param cD The detail coefficients, outputSize of them.
+ * @param outputSize The number of coefficients, (signalSize + L - 1) / 2.
+ * @param workspace Scratch memory for the window, workspace_size() doubles.
+ */
+void LiftingScheme::analysis(const double *signal, size_t signalSize,
+                             double *cA, double *cD, size_t outputSize,
+                             double *workspace) const {
+  // position i holds the polyphase samples at index begin + i, so that cA[k]
+  // comes from position marginBefore_ + k + lowShift_
+  const ptrdiff_t n = signalSize;
+  const ptrdiff_t begin =
+      1 - static_cast<ptrdiff_t>(filterSize_ / 2) - marginBefore_;
+  const ptrdiff_t count = outputSize + marginBefore_ + marginAfter_;
+  const ptrdiff_t outputs = outputSize;
+
+  // the window holds positions base .. filled - 1, even samples in the first
+  // half of the workspace and odd ones in the second
+  double *window[2] = {workspace, workspace + windowSize_};
+  ptrdiff_t base = 0, filled = 0, emitted = 0;
+
+  auto fill = [&](ptrdiff_t to) {
+    if (to <= filled) {
+      return;
+    }
+    if (to - base > windowSize_) {
+      throw std::runtime_error("Lifting window is too small!");
+    }
+    double *even = window[0] - base;
+    double *odd = window[1] - base;
+    for (ptrdiff_t i = filled; i < to; ++i) {
+      const ptrdiff_t index = 2 * (begin + i);
+      if (index >= 0 && index + 1 < n) {
+        even[i] = signal[index];
+        odd[i] = signal[index + 1];
+      } else {
+        even[i] = sym_extended(signal, signalSize, index);
+        odd[i] = sym_extended(signal, signalSize, index + 1);
+      }
+    }
+    filled = to;
+  };
+
+  const int lowBuffer = lowOdd_ ? 1 : 0;
+  auto emit = [&](ptrdiff_t to) {
+    const double *low = window[lowBuffer];
+    const double *high = window[1 - lowBuffer];
+    const ptrdiff_t lowOffset = marginBefore_ + lowShift_ - base;
+    const ptrdiff_t highOffset = marginBefore_ + highShift_ - base;
+    for (ptrdiff_t k = emitted; k < to; ++k) {
+      cA[k] = lowScale_ * low[k + lowOffset];
+      cD[k] = highScale_ * high[k + highOffset];
+    }
+    emitted = std::max(emitted, to);
+  };
+
+  // each step only runs where its reads stay inside positions 0 .. count - 1
+  ptrdiff_t pEnd = 0;
+  for (size_t i = 0; i < steps_.size(); ++i) {
+    const ptrdiff_t shift = steps_[i].shift;
+    pEnd = std::max(pEnd,
+                    std::min<ptrdiff_t>(count, count - shift) + lags_[i]);
+  }
+
+  const KernelTable &kernels = active_kernels();
+  for (ptrdiff_t p = firstTile_; p < pEnd; p += kLiftingTile) {
+    fill(std::min(count, p + kLiftingTile + touchLast_));
+
+    for (size_t i = 0; i < steps_.size(); ++i) {
+      const LiftingStep &step = steps_[i];
+      const ptrdiff_t shift = step.shift;
+      const ptrdiff_t first = std::max<ptrdiff_t>({0, -shift, p - lags_[i]});
+      const ptrdiff_t last = std::min<ptrdiff_t>(
+          {count, count - shift, p + kLiftingTile - lags_[i]});
+      if (first >= last) {
+        continue;
+      }
+      double *target = window[step.predict ? 1 : 0];
+      const double *source = window[step.predict ? 0 : 1];
+      kernels.lifting_step(target + (first - base),
+                           source + (first + shift - base), step.coeff,
+                           last - first);
+    }
+
+    const ptrdiff_t next = p + kLiftingTile;
+    emit(std::min({outputs,
+                   next - finalLag_[lowBuffer] - marginBefore_ - lowShift_,
+                   next - finalLag_[1 - lowBuffer] - marginBefore_ -
+                       highShift_}));
+
+    // drop the positions that neither later tiles nor pending outputs need
+    const ptrdiff_t keep = std::min(
+        {next + touchFirst_,
+         marginBefore_ + emitted + std::min(lowShift_, highShift_), filled});
+    if (keep > base) {
+      for (double *samples : window) {
+        std::copy(samples + (keep - base), samples + (filled - base),
+                  samples);
+      }
+      base = keep;
+    }
+  }
+
+  fill(count);
+  emit(outputs);
+}
@@ -0,0 +1,66 @@
+#ifndef lifting_h
+#define lifting_h
+
+#include <cstddef>
+#include <vector>
+
+// One lifting step on the polyphase components of a signal. A predict step
+// updates the odd samples from the even ones,
+//   odd[k] += coeff * even[k + shift],
+// an update step the even samples from the odd ones.
+struct LiftingStep {
+  bool predict;
+  int shift;
+  double coeff;
+};
+
+// Factorization of an orthogonal two channel filter bank into lifting steps.
+// The polyphase matrix of the filters is a lattice of rotations and delays,
+// and each rotation is two lifting steps and a scaling. The scalings and
+// delays are folded into the step coefficients and the final output scaling.
+class LiftingScheme {
+public:
+  LiftingScheme(const std::vector<double> &Lo_D,
+                const std::vector<double> &Ho_D);
+
+  const std::vector<LiftingStep> &steps() const { return steps_; }
+
+  size_t filter_size() const { return filterSize_; }
+
+  // Single level "sym" dwt, same output as the filter bank in dwt().
+  void analysis(const double *signal, size_t signalSize, double *cA,
+                double *cD, size_t outputSize) const;
+
+  // Same, without allocating: workspace holds workspace_size() doubles.
+  void analysis(const double *signal, size_t signalSize, double *cA,
+                double *cD, size_t outputSize, double *workspace) const;
+
+  size_t workspace_size() const { return 2 * windowSize_; }
+
+private:
+  size_t filterSize_;
+  std::vector<LiftingStep> steps_;
+  // how far each step trails the first one when they run fused over tiles
+  std::vector<int> lags_;
+  // the tile at p touches positions p + touchFirst_ .. p + tile + touchLast_
+  // and leaves the even (odd) samples final below p + tile - finalLag_[0]
+  // (finalLag_[1])
+  int touchFirst_;
+  int touchLast_;
+  int finalLag_[2];
+  // position of the first tile, and how many positions the window can hold
+  int firstTile_;
+  int windowSize_;
+  // cA[k] = lowScale_ * (odd if lowOdd_ else even)[k + lowShift_], and cD
+  // likewise from the other buffer
+  bool lowOdd_;
+  double lowScale_;
+  double highScale_;
+  int lowShift_;
+  int highShift_;
+  // polyphase samples needed around the outputs, from the steps' reach
+  int marginBefore_;
+  int marginAfter_;
+};
+
+#endif /* lifting_h */
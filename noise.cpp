@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "buffers.h"
+#include "noise.h"
+
+// bins of the histogram method
+static const size_t kHistogramBins = 4096;
+
+// owner of the per thread buffer of this file, the magnitudes of "select"
+struct NoiseBuffers;
+
+//-------------------------------------------------------------
+/**
+ * Finds the median magnitude with introselect, the mean of the two middle
+ * ones for an even count.
+ *
+ * @param cD The details.
+ * @param count The number of details.
+ * @return median(|cD|).
+ */
+static double select_median(const double *cD, size_t count) {
+  double *work = thread_buffer<NoiseBuffers>(0, count);
+  for (size_t i = 0; i < count; ++i) {
+    work[i] = std::abs(cD[i]);
+  }
+  const size_t middle = count / 2;
+  std::nth_element(work, work + middle, work + count);
+  double median = work[middle];
+  if (count % 2 == 0) {
+    // the larger of the lower half is the other middle value
+    median = (median + *std::max_element(work, work + middle)) / 2.0;
+  }
+  return median;
+}
+
+//-------------------------------------------------------------
+/**
+ * Interpolates the value of a rank within its bin of a histogram, as if the
+ * values of the bin were spread evenly over it.
+ *
+ * @param bins The counts of the bins.
+ * @param rank The rank, below the total count.
+ * @param scale The number of bins per unit.
+ * @return The value.
+ */
+static double histogram_rank(const size_t *bins, size_t rank, double scale) {
+  size_t below = 0;
+  size_t bin = 0;
+  while (below + bins[bin] <= rank) {
+    below += bins[bin];
+    ++bin;
+  }
+  return (bin + (rank - below + 0.5) / bins[bin]) / scale;
+}
+
+//-------------------------------------------------------------
+/**
+ * Approximates the median magnitude from a histogram over [0, max |cD|],
+ * the mean of the two middle ranks for an even count.
+ *
+ * @param cD The details.
+ * @param count The number of details.
+ * @return median(|cD|), within max |cD| / kHistogramBins.
+ */
+static double histogram_median(const double *cD, size_t count) {
+  double largest = 0.0;
+  for (size_t i = 0; i < count; ++i) {
+    largest = std::max(largest, std::abs(cD[i]));
+  }
+  if (!(largest > 0.0)) {
+    return 0.0;
+  }
+  size_t bins[kHistogramBins] = {};
+  const double scale = kHistogramBins / largest;
+  for (size_t i = 0; i < count; ++i) {
+    // the largest magnitude falls in the last bin
+    ++bins[std::min(size_t(std::abs(cD[i]) * scale), kHistogramBins - 1)];
+  }
+  const double lower = histogram_rank(bins, (count - 1) / 2, scale);
+  if (count % 2 == 1) {
+    return lower;
+  }
+  return (lower + histogram_rank(bins, count / 2, scale)) / 2.0;
+}
+
+//-------------------------------------------------------------
+/**
+ * Estimates the noise level from finest details.
+ *
+ * @param cD The details.
+ * @param method "select" or "histogram".
+ * @return median(|cD|) / 0.6745.
+ */
+double noise_sigma(const std::vector<double> &cD, const std::string method) {
+  return noise_sigma(cD.data(), cD.size(), method);
+}
+
+//-------------------------------------------------------------
+/**
+ * Estimates the noise level from finest details.
+ *
+ * @param cD The details.
+ * @param count The number of details.
+ * @param method "select" or "histogram".
+ * @return median(|cD|) / 0.6745.
+ */
+double noise_sigma(const double *cD, size_t count, const std::string &method) {
+  if (method != "select" && method != "histogram") {
+    throw std::runtime_error("Noise method error!");
+  }
+  if (count == 0) {
+    throw std::runtime_error("Details are empty!");
+  }
+  const double median = method == "select" ? select_median(cD, count)
+                                           : histogram_median(cD, count);
+  return median / 0.6745;
+}
+
+//-------------------------------------------------------------
+/**
+ * Starts an estimate of the p-quantile.
+ *
+ * @param p The quantile, in [0, 1].
+ */
+P2Quantile::P2Quantile(double p) : p_(p) {
+  if (!(p >= 0.0 && p <= 1.0)) {
+    throw std::runtime_error("Quantile must be in [0, 1]!");
+  }
+  reset();
+}
+
+//-------------------------------------------------------------
+/**
+ * Forgets the samples.
+ */
+void P2Quantile::reset() {
+  count_ = 0;
+  const double desired[5] = {1.0, 1.0 + 2.0 * p_, 1.0 + 4.0 * p_,
+                             3.0 + 2.0 * p_, 5.0};
+  const double increments[5] = {0.0, p_ / 2.0, p_, (1.0 + p_) / 2.0, 1.0};
+  for (size_t i = 0; i < 5; ++i) {
+    heights_[i] = 0.0;
+    positions_[i] = double(i + 1);
+    desired_[i] = desired[i];
+    increments_[i] = increments[i];
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Adds a sample. The first five become the markers; after that the cell of
+ * the sample is found, the positions of the markers above it move up, and
+ * each inner marker that is a position or more off its desired one moves by
+ * one, its height following the parabola through it and its neighbours, or
+ * the line to the neighbour it moves towards when the parabola would leave
+ * them out of order.
+ *
+ * @param x The sample.
+ */
+void P2Quantile::push(double x) {
+  if (count_ < 5) {
+    // kept sorted
+    size_t i = count_;
+    while (i > 0 && heights_[i - 1] > x) {
+      heights_[i] = heights_[i - 1];
+      --i;
+    }
+    heights_[i] = x;
+    ++count_;
+    return;
+  }
+  ++count_;
+
+  size_t cell;
+  if (x < heights_[0]) {
+    heights_[0] = x;
+    cell = 0;
+  } else if (x >= heights_[4]) {
+    heights_[4] = std::max(heights_[4], x);
+    cell = 3;
+  } else {
+    cell = 0;
+    while (x >= heights_[cell + 1]) {
+      ++cell;
+    }
+  }
+  for (size_t i = cell + 1; i < 5; ++i) {
+    positions_[i] += 1.0;
+  }
+  for (size_t i = 0; i < 5; ++i) {
+    desired_[i] += increments_[i];
+  }
+
+  for (size_t i = 1; i < 4; ++i) {
+    const double offset = desired_[i] - positions_[i];
+    const double up = positions_[i + 1] - positions_[i];
+    const double down = positions_[i - 1] - positions_[i];
+    if ((offset >= 1.0 && up > 1.0) || (offset <= -1.0 && down < -1.0)) {
+      const double d = offset > 0.0 ? 1.0 : -1.0;
+      const double parabolic =
+          heights_[i] +
+          d / (positions_[i + 1] - positions_[i - 1]) *
+              ((positions_[i] - positions_[i - 1] + d) *
+                   (heights_[i + 1] - heights_[i]) / up +
+               (positions_[i + 1] - positions_[i] - d) *
+                   (heights_[i] - heights_[i - 1]) / -down);
+      if (heights_[i - 1] < parabolic && parabolic < heights_[i + 1]) {
+        heights_[i] = parabolic;
+      } else {
+        const size_t j = d > 0.0 ? i + 1 : i - 1;
+        heights_[i] += d * (heights_[j] - heights_[i]) /
+                       (positions_[j] - positions_[i]);
+      }
+      positions_[i] += d;
+    }
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Returns the estimate of the quantile.
+ *
+ * @return The middle marker, or the nearest rank quantile of fewer than five
+ * samples, which are kept sorted.
+ */
+double P2Quantile::value() const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+  if (count_ < 5) {
+    return heights_[size_t(p_ * (count_ - 1) + 0.5)];
+  }
+  return heights_[2];
+}
+
+//-------------------------------------------------------------
+/**
+ * Adds a block of details.
+ *
+ * @param cD The details.
+ * @param count The number of details.
+ */
+void StreamingNoise::push(const double *cD, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    median_.push(std::abs(cD[i]));
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef noise_h
+#define noise_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Noise level of white Gaussian noise from the finest details of dwt(),
+// sigma = median(|cD_1|) / 0.6745, without sorting. The method is "select",
+// the exact median by introselect on a per thread copy of the magnitudes
+// that is reused between calls, or "histogram", read only and without a
+// copy: the magnitudes are binned over [0, max |cD|] into 4096 bins, and the
+// median is interpolated within its bin, off by at most max |cD| / 4096.
+double noise_sigma(const std::vector<double> &cD,
+                   const std::string method = "select");
+
+double noise_sigma(const double *cD, size_t count, const std::string &method);
+
+// Streaming estimate of the p-quantile of a sequence with the P^2 algorithm
+// of Jain and Chlamtac: five markers whose heights follow the minimum, the
+// p / 2, p and (1 + p) / 2 quantiles and the maximum, moved by piecewise
+// parabolic interpolation as samples arrive. Constant memory and time per
+// sample. With fewer than five samples the value is the nearest rank
+// quantile of those.
+class P2Quantile {
+public:
+  explicit P2Quantile(double p = 0.5);
+
+  void push(double x);
+
+  // 0 before the first sample
+  double value() const;
+
+  size_t count() const { return count_; }
+
+  void reset();
+
+private:
+  double p_;
+  size_t count_;
+  double heights_[5];
+  double positions_[5];
+  double desired_[5];
+  double increments_[5];
+};
+
+// noise_sigma() over details that arrive in blocks, for instance from
+// StreamingDwt, with the median of |cD| tracked by P2Quantile.
+class StreamingNoise {
+public:
+  void push(const double *cD, size_t count);
+
+  // 0 before the first detail
+  double sigma() const { return median_.value() / 0.6745; }
+
+  size_t count() const { return median_.count(); }
+
+  void reset() { median_.reset(); }
+
+private:
+  P2Quantile median_;
+};
+
+#endif /* noise_h */
@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dwt.h"
+#include "kernels.h"
+#include "packet.h"
+#include "threadpool.h"
+#include "wavelets.h"
+
+// Coefficients per kernel call, whose cost is added up right after.
+static const size_t kCostBlock = 4096;
+
+// Nodes of at least two chunks are split over the thread pool, a chunk at a
+// time. The cost of a node always sums the costs of its chunks in order, so
+// that the split does not change it.
+static const size_t kParallelChunk = 1 << 15;
+
+// Subtrees per thread from which the tree runs as subtree tasks.
+static const size_t kSubtreesPerThread = 4;
+
+enum class Entropy { Shannon, LogEnergy };
+
+/**
+ * Parses the name of a cost function.
+ *
+ * @param entropy The name, "shannon" or "log energy".
+ * @return The cost function.
+ */
+static Entropy entropy_type(const std::string &entropy) {
+  if (entropy == "shannon") {
+    return Entropy::Shannon;
+  }
+  if (entropy == "log energy") {
+    return Entropy::LogEnergy;
+  }
+  throw std::runtime_error("Entropy error!");
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the additive entropy cost of coefficients.
+ *
+ * @param x The coefficients.
+ * @param size The number of coefficients.
+ * @param entropy The cost function.
+ * @return The cost.
+ */
+static double entropy_cost(const double *x, size_t size, Entropy entropy) {
+  double cost = 0.0;
+  for (size_t i = 0; i < size; ++i) {
+    const double e = x[i] * x[i];
+    if (e == 0.0) {
+      continue;
+    }
+    cost += entropy == Entropy::Shannon ? -e * std::log(e) : std::log(e);
+  }
+  return cost;
+}
+
+//-------------------------------------------------------------
+/**
+ * Returns the start of a node of the arena.
+ *
+ * @param packet The tree.
+ * @param depth The depth of the node.
+ * @param position The position of the node.
+ * @return The coefficients of the node.
+ */
+static double *node_data(WaveletPacket &packet, size_t depth,
+                         size_t position) {
+  return packet.coeffs.data() + packet.offsets[depth] +
+         position * packet.lengths[depth];
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the outputs [first, last) of both children of a node, a block at
+ * a time, and the costs of those outputs.
+ *
+ * @param costA Set to the cost of the outputs of the cA child.
+ * @param costD Set to the cost of the outputs of the cD child.
+ */
+static void split_chunk(const Wavelet &w, const KernelTable &kernels,
+                        const double *parent, size_t parentSize, double *cA,
+                        double *cD, size_t first, size_t last,
+                        Entropy entropy, double &costA, double &costD) {
+  costA = 0.0;
+  costD = 0.0;
+  for (size_t k0 = first; k0 < last; k0 += kCostBlock) {
+    const size_t k1 = std::min(k0 + kCostBlock, last);
+    kernels.dwt_analysis(parent, parentSize, w.Lo_D, w.Ho_D, w.filterSize, cA,
+                         cD, k0, k1);
+    costA += entropy_cost(cA + k0, k1 - k0, entropy);
+    costD += entropy_cost(cD + k0, k1 - k0, entropy);
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Splits a node into its children, chunk after chunk, and sets their costs.
+ *
+ * @param packet The tree.
+ * @param depth The depth of the node, less than the level.
+ * @param position The position of the node.
+ */
+static void split_node(WaveletPacket &packet, const Wavelet &w,
+                       const KernelTable &kernels, size_t depth,
+                       size_t position, Entropy entropy) {
+  const size_t size = packet.lengths[depth + 1];
+  const double *parent = node_data(packet, depth, position);
+  double *cA = node_data(packet, depth + 1, 2 * position);
+  double *cD = node_data(packet, depth + 1, 2 * position + 1);
+  double costA = 0.0;
+  double costD = 0.0;
+  for (size_t first = 0; first < size; first += kParallelChunk) {
+    double chunkA, chunkD;
+    split_chunk(w, kernels, parent, packet.lengths[depth], cA, cD, first,
+                std::min(first + kParallelChunk, size), entropy, chunkA,
+                chunkD);
+    costA += chunkA;
+    costD += chunkD;
+  }
+  const size_t index = (size_t(2) << depth) - 1 + 2 * position;
+  packet.costs[index] = costA;
+  packet.costs[index + 1] = costD;
+}
+
+//-------------------------------------------------------------
+/**
+ * Splits a node and then, depth first, every node below it, so that the
+ * children are transformed while the parent is still in cache.
+ *
+ * @param packet The tree.
+ * @param depth The depth of the node.
+ * @param position The position of the node.
+ */
+static void split_subtree(WaveletPacket &packet, const Wavelet &w,
+                          const KernelTable &kernels, size_t depth,
+                          size_t position, Entropy entropy) {
+  if (depth == packet.level) {
+    return;
+  }
+  split_node(packet, w, kernels, depth, position, entropy);
+  split_subtree(packet, w, kernels, depth + 1, 2 * position, entropy);
+  split_subtree(packet, w, kernels, depth + 1, 2 * position + 1, entropy);
+}
+
+//-------------------------------------------------------------
+/**
+ * Splits every node of a depth on the pool, one task per chunk of a node.
+ * The costs of the chunks are summed in order afterwards, as split_node()
+ * does.
+ *
+ * @param packet The tree.
+ * @param depth The depth of the nodes, less than the level.
+ * @param pool The threads to run on.
+ */
+static void split_depth(WaveletPacket &packet, const Wavelet &w,
+                        const KernelTable &kernels, size_t depth,
+                        Entropy entropy, ThreadPool &pool) {
+  const size_t nodes = size_t(1) << depth;
+  const size_t size = packet.lengths[depth + 1];
+  const size_t chunks = (size + kParallelChunk - 1) / kParallelChunk;
+  std::vector<double> chunkCosts(2 * nodes * chunks);
+  std::vector<size_t> tasks(nodes * chunks);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    tasks[i] = i;
+  }
+  pool.run(tasks, [&](size_t task) {
+    const size_t position = task / chunks;
+    const size_t first = task % chunks * kParallelChunk;
+    split_chunk(w, kernels, node_data(packet, depth, position),
+                packet.lengths[depth],
+                node_data(packet, depth + 1, 2 * position),
+                node_data(packet, depth + 1, 2 * position + 1), first,
+                std::min(first + kParallelChunk, size), entropy,
+                chunkCosts[2 * task], chunkCosts[2 * task + 1]);
+  });
+  for (size_t position = 0; position < nodes; ++position) {
+    double costA = 0.0;
+    double costD = 0.0;
+    for (size_t c = 0; c < chunks; ++c) {
+      costA += chunkCosts[2 * (position * chunks + c)];
+      costD += chunkCosts[2 * (position * chunks + c) + 1];
+    }
+    const size_t index = (size_t(2) << depth) - 1 + 2 * position;
+    packet.costs[index] = costA;
+    packet.costs[index + 1] = costD;
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the number of coefficients of a wavelet packet tree.
+ *
+ * @param signalSize The number of samples.
+ * @param level The depth of the tree.
+ * @param w The wavelet.
+ * @return The size of the arena.
+ */
+size_t wpdec_output_size(size_t signalSize, size_t level, const Wavelet &w) {
+  size_t outputSize = signalSize;
+  size_t size = signalSize;
+  for (size_t d = 1; d <= level; ++d) {
+    size = dwt_output_size(size, w);
+    outputSize += (size_t(1) << d) * size;
+  }
+  return outputSize;
+}
+
+//-------------------------------------------------------------
+/**
+ * Builds a wavelet packet tree, serially or on a pool.
+ *
+ * @param signal The signal.
+ * @param level The depth of the tree.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param entropy The cost function.
+ * @param pool The threads to run on, or nullptr.
+ * @return The tree.
+ */
+static WaveletPacket packet_tree(const std::vector<double> &signal,
+                                 size_t level, const std::string &wavelet_name,
+                                 const std::string &entropy,
+                                 ThreadPool *pool) {
+  const Wavelet &w = wavelet(wavelet_name);
+  const Entropy type = entropy_type(entropy);
+  if (level >= 8 * sizeof(size_t) - 1) {
+    throw std::runtime_error("Level out of range!");
+  }
+
+  WaveletPacket packet;
+  packet.level = level;
+  packet.lengths.push_back(signal.size());
+  packet.offsets.push_back(0);
+  for (size_t d = 1; d <= level; ++d) {
+    packet.offsets.push_back(packet.offsets.back() +
+                             (size_t(1) << (d - 1)) * packet.lengths.back());
+    packet.lengths.push_back(dwt_output_size(packet.lengths.back(), w));
+  }
+  packet.coeffs.resize(wpdec_output_size(signal.size(), level, w));
+  packet.costs.resize((size_t(2) << level) - 1);
+  std::copy(signal.begin(), signal.end(), packet.coeffs.begin());
+  packet.costs[0] = 0.0;
+  for (size_t first = 0; first < signal.size(); first += kParallelChunk) {
+    const size_t last = std::min(first + kParallelChunk, signal.size());
+    double cost = 0.0;
+    for (size_t k0 = first; k0 < last; k0 += kCostBlock) {
+      cost += entropy_cost(signal.data() + k0,
+                           std::min(k0 + kCostBlock, last) - k0, type);
+    }
+    packet.costs[0] += cost;
+  }
+
+  const KernelTable &kernels = active_kernels();
+  if (pool == nullptr || pool->size() < 2) {
+    split_subtree(packet, w, kernels, 0, 0, type);
+    return packet;
+  }
+  size_t depth = 0;
+  while (depth < level &&
+         (size_t(1) << depth) < kSubtreesPerThread * pool->size()) {
+    split_depth(packet, w, kernels, depth, type, *pool);
+    ++depth;
+  }
+  if (depth < level) {
+    std::vector<size_t> subtrees(size_t(1) << depth);
+    for (size_t p = 0; p < subtrees.size(); ++p) {
+      subtrees[p] = p;
+    }
+    pool->run(subtrees, [&](size_t p) {
+      split_subtree(packet, w, kernels, depth, p, type);
+    });
+  }
+  return packet;
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a wavelet packet decomposition.
+ *
+ * @param signal The signal.
+ * @param level The depth of the tree.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param entropy The cost function, "shannon" or "log energy".
+ * @return The tree with the cost of every node.
+ */
+WaveletPacket wpdec(const std::vector<double> &signal, size_t level,
+                    const std::string wavelet_name,
+                    const std::string entropy) {
+  return packet_tree(signal, level, wavelet_name, entropy, nullptr);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a wavelet packet decomposition on a thread pool.
+ *
+ * @param signal The signal.
+ * @param level The depth of the tree.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param entropy The cost function, "shannon" or "log energy".
+ * @param pool The threads to run on.
+ * @return The tree with the cost of every node.
+ */
+WaveletPacket wpdec(const std::vector<double> &signal, size_t level,
+                    const std::string wavelet_name, const std::string entropy,
+                    ThreadPool &pool) {
+  return packet_tree(signal, level, wavelet_name, entropy, &pool);
+}
+
+//-------------------------------------------------------------
+/**
+ * Selects the best basis of a wavelet packet tree by cost.
+ *
+ * @param packet The tree.
+ * @return The (depth, position) of the basis nodes, from low to high
+ * positions.
+ */
+std::vector<std::pair<size_t, size_t>>
+best_basis(const WaveletPacket &packet) {
+  const size_t nodes = packet.costs.size();
+  // best cost below every node, and whether the node itself is kept
+  std::vector<double> best(packet.costs);
+  std::vector<char> kept(nodes, 1);
+  for (size_t d = packet.level; d-- > 0;) {
+    for (size_t p = 0; p < (size_t(1) << d); ++p) {
+      const size_t index = (size_t(1) << d) - 1 + p;
+      const size_t child = (size_t(2) << d) - 1 + 2 * p;
+      const double children = best[child] + best[child + 1];
+      if (children < best[index]) {
+        best[index] = children;
+        kept[index] = 0;
+      }
+    }
+  }
+
+  // the kept nodes with no kept ancestor, depth first from the left
+  std::vector<std::pair<size_t, size_t>> basis;
+  std::vector<std::pair<size_t, size_t>> stack(1, std::make_pair(0, 0));
+  while (!stack.empty()) {
+    const std::pair<size_t, size_t> node = stack.back();
+    stack.pop_back();
+    if (kept[(size_t(1) << node.first) - 1 + node.second]) {
+      basis.push_back(node);
+      continue;
+    }
+    stack.push_back(std::make_pair(node.first + 1, 2 * node.second + 1));
+    stack.push_back(std::make_pair(node.first + 1, 2 * node.second));
+  }
+  return basis;
+}
@@ -0,0 +1,65 @@
+#ifndef packet_h
+#define packet_h
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wavelets.h"
+
+class ThreadPool;
+
+// Full wavelet packet tree: node (d, p) at depth d = 0 .. level and position
+// p = 0 .. 2^d - 1, with node (0, 0) the signal and nodes (d + 1, 2p) and
+// (d + 1, 2p + 1) the cA and cD of the "sym" dwt() of node (d, p). Every
+// node of a depth has the same length. The nodes live in one arena, depth by
+// depth and within a depth by position, together with the entropy cost of
+// each node.
+struct WaveletPacket {
+  size_t level;
+  // number of coefficients of a node at depth 0 .. level
+  std::vector<size_t> lengths;
+  // where depth 0 .. level starts in coeffs
+  std::vector<size_t> offsets;
+  std::vector<double> coeffs;
+  // cost of node (d, p) at 2^d - 1 + p
+  std::vector<double> costs;
+
+  const double *node(size_t depth, size_t position) const {
+    return coeffs.data() + offsets[depth] + position * lengths[depth];
+  }
+
+  double cost(size_t depth, size_t position) const {
+    return costs[(size_t(1) << depth) - 1 + position];
+  }
+};
+
+// Number of coefficients of the arena of wpdec(), all depths included.
+size_t wpdec_output_size(size_t signalSize, size_t level, const Wavelet &w);
+
+// Wavelet packet decomposition down to level, with the cost of every node
+// computed by entropy, "shannon" (-sum x^2 log x^2) or "log energy"
+// (sum log x^2), zeros skipped. The cost of a node is added up block by
+// block as the kernel writes it, while the block is in cache.
+WaveletPacket wpdec(const std::vector<double> &signal, size_t level,
+                    const std::string wavelet_name,
+                    const std::string entropy = "shannon");
+
+// Same on a thread pool: the depths with fewer nodes than a few per thread
+// run level by level, split into chunks of coefficients; below, every
+// subtree is one task that runs depth first, and idle threads steal whole
+// subtrees. The result is bit-identical to the serial one. Must not be
+// called from a task of the same pool.
+WaveletPacket wpdec(const std::vector<double> &signal, size_t level,
+                    const std::string wavelet_name, const std::string entropy,
+                    ThreadPool &pool);
+
+// Coifman-Wickerhauser best basis: from the deepest nodes up, a node is kept
+// when its cost is at most the summed costs of the best bases of its
+// children. Returns the (depth, position) of the basis nodes from low to high
+// positions.
+std::vector<std::pair<size_t, size_t>>
+best_basis(const WaveletPacket &packet);
+
+#endif /* packet_h */
@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dwt.h"
+#include "kernels.h"
+#include "streaming.h"
+#include "wavelets.h"
+
+// Samples taken into the buffer at a time, which bounds the memory of a
+// stream whatever the block size.
+static const size_t kStreamPiece = 1024;
+
+/**
+ * Sets up a stream for the named wavelet.
+ *
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param mode The extension mode, which can be "sym".
+ */
+StreamingDwt::StreamingDwt(const std::string &wavelet_name,
+                           const std::string &mode)
+    : StreamingDwt(wavelet(wavelet_name), mode) {}
+
+//-------------------------------------------------------------
+/**
+ * Sets up a stream, allocating its buffers once.
+ *
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ */
+StreamingDwt::StreamingDwt(const Wavelet &w, const std::string &mode)
+    : wavelet_(&w), kernels_(&active_kernels()), base_(0), used_(0),
+      received_(0), emitted_(0) {
+  if (mode != "sym") {
+    throw std::runtime_error("Mode error!");
+  }
+  // the kept samples, a piece and the reflection at the end
+  buffer_.resize(kStreamPiece + 2 * w.filterSize);
+  stageA_.resize(buffer_.size() / 2 + w.filterSize);
+  stageD_.resize(stageA_.size());
+  reset();
+}
+
+//-------------------------------------------------------------
+/**
+ * Drops the samples of the current signal, so that the next push() starts a
+ * new one.
+ */
+void StreamingDwt::reset() {
+  base_ = 0;
+  // room for the reflection at the start, filled in once the samples it
+  // mirrors are in
+  used_ = wavelet_->filterSize - 2;
+  received_ = 0;
+  emitted_ = 0;
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes how many coefficient pairs a push() of blockSize samples emits.
+ *
+ * @param blockSize The number of samples to push.
+ * @return The number of cA, and of cD, coefficients.
+ */
+size_t StreamingDwt::push_output_size(size_t blockSize) const {
+  const size_t total = received_ + blockSize;
+  // cA[k] is complete with sample 2k + 1
+  return total + 1 >= wavelet_->filterSize ? total / 2 - emitted_ : 0;
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes how many coefficient pairs flush() emits.
+ *
+ * @return The number of cA, and of cD, coefficients.
+ */
+size_t StreamingDwt::flush_output_size() const {
+  return dwt_output_size(received_, *wavelet_) - emitted_;
+}
+
+//-------------------------------------------------------------
+/**
+ * Appends a block of samples, a piece at a time, and emits the coefficients
+ * it completes.
+ *
+ * @param block The samples.
+ * @param blockSize The number of samples.
+ * @param cA The approximation coefficients, push_output_size() of them.
+ * @param cD The detail coefficients, push_output_size() of them.
+ * @return The number of coefficient pairs written.
+ */
+size_t StreamingDwt::push(const double *block, size_t blockSize, double *cA,
+                          double *cD) {
+  const size_t L = wavelet_->filterSize;
+  size_t written = 0;
+  while (blockSize > 0) {
+    // keep room for the reflection at the end
+    const size_t take =
+        std::min(blockSize, buffer_.size() - used_ - (L - 1));
+    std::copy(block, block + take, buffer_.data() + used_);
+    const bool started = received_ + 1 >= L;
+    used_ += take;
+    received_ += take;
+    block += take;
+    blockSize -= take;
+    if (received_ + 1 < L) {
+      continue;
+    }
+    if (!started) {
+      // extended[j] = x[L - 3 - j] for j < L - 2, x[i] being extended[i + L
+      // - 2]
+      for (size_t j = 0; j + 2 < L; ++j) {
+        buffer_[j] = buffer_[2 * L - 5 - j];
+      }
+    }
+    const size_t ready = received_ / 2;
+    emit(ready, cA + written, cD + written);
+    written += ready - emitted_;
+    emitted_ = ready;
+
+    // keep the windows of the coefficients to come, and at least the last
+    // L - 1 samples for the reflection at the end; base_ stays even so that
+    // cA[k] starts at buffer index 2k - base_
+    const size_t end = base_ + used_;
+    const size_t keep = std::min(2 * emitted_, end - (L - 1)) & ~size_t(1);
+    std::copy(buffer_.begin() + (keep - base_), buffer_.begin() + used_,
+              buffer_.begin());
+    used_ = end - keep;
+    base_ = keep;
+  }
+  return written;
+}
+
+//-------------------------------------------------------------
+/**
+ * Ends the signal with the "sym" reflection of its last samples, emits the
+ * remaining coefficients and starts over.
+ *
+ * @param cA The approximation coefficients, flush_output_size() of them.
+ * @param cD The detail coefficients, flush_output_size() of them.
+ * @return The number of coefficient pairs written.
+ */
+size_t StreamingDwt::flush(double *cA, double *cD) {
+  const size_t L = wavelet_->filterSize;
+  const size_t total = dwt_output_size(received_, *wavelet_);
+  // x[n + i] = x[n - 1 - i]
+  for (size_t i = 0; i + 1 < L; ++i) {
+    buffer_[used_ + i] = buffer_[used_ - 1 - i];
+  }
+  used_ += L - 1;
+  emit(total, cA, cD);
+  const size_t written = total - emitted_;
+  reset();
+  return written;
+}
+
+//-------------------------------------------------------------
+/**
+ * Appends a block of samples.
+ *
+ * @param block The samples.
+ * @return The coefficients the block completes.
+ */
+std::pair<std::vector<double>, std::vector<double>>
+StreamingDwt::push(const std::vector<double> &block) {
+  std::vector<double> cA(push_output_size(block.size()));
+  std::vector<double> cD(cA.size());
+  push(block.data(), block.size(), cA.data(), cD.data());
+  return std::make_pair(std::move(cA), std::move(cD));
+}
+
+//-------------------------------------------------------------
+/**
+ * Ends the signal.
+ *
+ * @return The remaining coefficients.
+ */
+std::pair<std::vector<double>, std::vector<double>> StreamingDwt::flush() {
+  std::vector<double> cA(flush_output_size());
+  std::vector<double> cD(cA.size());
+  flush(cA.data(), cD.data());
+  return std::make_pair(std::move(cA), std::move(cD));
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the coefficients emitted_ .. last - 1 from the buffer. Their
+ * windows lie inside the buffer, so the kernel runs them as interior outputs,
+ * the same way dwt() computes every coefficient.
+ *
+ * @param last One past the last coefficient.
+ * @param cA The approximation coefficients.
+ * @param cD The detail coefficients.
+ */
+void StreamingDwt::emit(size_t last, double *cA, double *cD) {
+  if (last <= emitted_) {
+    return;
+  }
+  const Wavelet &w = *wavelet_;
+  // kernel output k reads buffer[2k + 2 - L .. 2k + 1]
+  const size_t first = emitted_ - base_ / 2 + w.filterSize / 2 - 1;
+  const size_t count = last - emitted_;
+  kernels_->dwt_analysis(buffer_.data(), used_, w.Lo_D, w.Ho_D, w.filterSize,
+                         stageA_.data(), stageD_.data(), first, first + count);
+  std::copy(stageA_.begin() + first, stageA_.begin() + first + count, cA);
+  std::copy(stageD_.begin() + first, stageD_.begin() + first + count, cD);
+}
+
+//-------------------------------------------------------------
+/**
+ * Sets up a streaming decomposition for the named wavelet.
+ *
+ * @param level The decomposition level.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param mode The extension mode, which can be "sym".
+ */
+StreamingDecomposition::StreamingDecomposition(size_t level,
+                                               const std::string &wavelet_name,
+                                               const std::string &mode)
+    : StreamingDecomposition(level, wavelet(wavelet_name), mode) {}
+
+//-------------------------------------------------------------
+/**
+ * Sets up a streaming decomposition, one stage per level.
+ *
+ * @param level The decomposition level.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param mode The extension mode, which can be "sym".
+ */
+StreamingDecomposition::StreamingDecomposition(size_t level, const Wavelet &w,
+                                               const std::string &mode)
+    : wavelet_(&w), received_(0) {
+  if (mode != "sym") {
+    throw std::runtime_error("Mode error!");
+  }
+  stages_.reserve(level);
+  for (size_t i = 0; i < level; ++i) {
+    stages_.emplace_back(w, mode);
+  }
+  // a stage emits at most one pair per two samples of a piece, and less than
+  // a filter length of them on flush
+  for (std::vector<double> &scratch : scratch_) {
+    scratch.resize(kStreamPiece / 2 + w.filterSize);
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Drops the samples of the current signal in every stage.
+ */
+void StreamingDecomposition::reset() {
+  for (StreamingDwt &stage : stages_) {
+    stage.reset();
+  }
+  received_ = 0;
+}
+
+//-------------------------------------------------------------
+/**
+ * Appends a block of samples, running it through the stages a piece at a
+ * time.
+ *
+ * @param block The samples.
+ * @param blockSize The number of samples.
+ * @param out Set to the coefficients the block completes.
+ */
+void StreamingDecomposition::push(const double *block, size_t blockSize,
+                                  StreamingCoefficients &out) {
+  out.cD.resize(stages_.size());
+  for (std::vector<double> &cD : out.cD) {
+    cD.clear();
+  }
+  out.cA.clear();
+  received_ += blockSize;
+
+  while (blockSize > 0) {
+    const size_t take = std::min(blockSize, kStreamPiece);
+    const double *input = block;
+    size_t inputSize = take;
+    block += take;
+    blockSize -= take;
+    for (size_t i = 0; i < stages_.size() && inputSize > 0; ++i) {
+      std::vector<double> &cD = out.cD[i];
+      const size_t count = stages_[i].push_output_size(inputSize);
+      const size_t offset = cD.size();
+      cD.resize(offset + count);
+      double *cA = scratch_[i % 2].data();
+      stages_[i].push(input, inputSize, cA, cD.data() + offset);
+      input = cA;
+      inputSize = count;
+    }
+    if (inputSize > 0) {
+      out.cA.insert(out.cA.end(), input, input + inputSize);
+    }
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Ends the signal: each stage is flushed in turn, after the cA the stage
+ * before emitted on its flush has been pushed into it.
+ *
+ * @param out Set to the remaining coefficients.
+ */
+void StreamingDecomposition::flush(StreamingCoefficients &out) {
+  // check all levels before any stage is flushed
+  wavedec_output_size(received_, stages_.size(), *wavelet_);
+
+  out.cD.resize(stages_.size());
+  const double *input = nullptr;
+  size_t inputSize = 0;
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    StreamingDwt &stage = stages_[i];
+    std::vector<double> &cD = out.cD[i];
+    double *cA = scratch_[i % 2].data();
+    const size_t pushed = stage.push_output_size(inputSize);
+    cD.resize(pushed);
+    stage.push(input, inputSize, cA, cD.data());
+    const size_t flushed = stage.flush_output_size();
+    cD.resize(pushed + flushed);
+    stage.flush(cA + pushed, cD.data() + pushed);
+    input = cA;
+    inputSize = pushed + flushed;
+  }
+  out.cA.assign(input, input + inputSize);
+  received_ = 0;
+}
+
+//-------------------------------------------------------------
+/**
+ * Appends a block of samples.
+ *
+ * @param block The samples.
+ * @return The coefficients the block completes.
+ */
+StreamingCoefficients
+StreamingDecomposition::push(const std::vector<double> &block) {
+  StreamingCoefficients out;
+  push(block.data(), block.size(), out);
+  return out;
+}
+
+//-------------------------------------------------------------
+/**
+ * Ends the signal.
+ *
+ * @return The remaining coefficients.
+ */
+StreamingCoefficients StreamingDecomposition::flush() {
+  StreamingCoefficients out;
+  flush(out);
+  return out;
+}
+
+//-------------------------------------------------------------
+/**
+ * Sets up a per sample decomposition for the named wavelet.
+ *
+ * @param level The decomposition level.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ */
+SampleDwt::SampleDwt(size_t level, const std::string &wavelet_name)
+    : SampleDwt(level, wavelet(wavelet_name)) {}
+
+//-------------------------------------------------------------
+/**
+ * Sets up a per sample decomposition, allocating the rings once. The delays
+ * of the filters h are sum_m m h[m] / sum_m h[m], with (-1)^m h[m] for the
+ * highpass one.
+ *
+ * @param level The decomposition level.
+ * @param w The wavelet, resolved once with wavelet().
+ */
+SampleDwt::SampleDwt(size_t level, const Wavelet &w)
+    : wavelet_(&w), kernels_(&active_kernels()),
+      rings_(2 * w.filterSize * level), positions_(level), counts_(level),
+      stageA_(w.filterSize / 2), stageD_(w.filterSize / 2), lowDelay_(0),
+      highDelay_(0) {
+  // coefficient t reads x[t - m] * Lo_D[m]
+  double lowSum = 0;
+  double highSum = 0;
+  for (size_t m = 0; m < w.filterSize; ++m) {
+    const double sign = m % 2 == 0 ? 1.0 : -1.0;
+    lowSum += w.Lo_D[m];
+    lowDelay_ += m * w.Lo_D[m];
+    highSum += sign * w.Ho_D[m];
+    highDelay_ += m * sign * w.Ho_D[m];
+  }
+  lowDelay_ /= lowSum;
+  highDelay_ /= highSum;
+}
+
+//-------------------------------------------------------------
+/**
+ * Empties the rings, so that the next push() starts a new signal.
+ */
+void SampleDwt::reset() {
+  std::fill(positions_.begin(), positions_.end(), 0);
+  std::fill(counts_.begin(), counts_.end(), 0);
+}
+
+//-------------------------------------------------------------
+/**
+ * Pushes one sample through the levels, each of which passes its cA on to
+ * the next one when it emits.
+ *
+ * @param sample The sample.
+ * @param cD The details, one per level.
+ * @param cA The approximation of the last level.
+ * @return The number of levels that emitted.
+ */
+size_t SampleDwt::push(double sample, double *cD, double &cA) {
+  const Wavelet &w = *wavelet_;
+  const size_t L = w.filterSize;
+  double value = sample;
+  for (size_t j = 0; j < counts_.size(); ++j) {
+    double *ring = rings_.data() + 2 * L * j;
+    size_t &position = positions_[j];
+    ring[position] = value;
+    ring[position + L] = value;
+    position = position + 1 == L ? 0 : position + 1;
+    const size_t count = ++counts_[j];
+    // cA[k] is complete with sample 2k + 1, and inside the signal from
+    // k = L / 2 - 1
+    if (count < L || (count - L) % 2 != 0) {
+      return j;
+    }
+    // the window, oldest sample first, is ring[position .. position + L)
+    kernels_->dwt_analysis(ring + position, L, w.Lo_D, w.Ho_D, L,
+                           stageA_.data(), stageD_.data(), L / 2 - 1, L / 2);
+    cD[j] = stageD_[L / 2 - 1];
+    value = stageA_[L / 2 - 1];
+  }
+  cA = value;
+  return counts_.size();
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the delay of the details of a level: the approximations of the
+ * levels above, each at its own sample rate, then the highpass filter.
+ *
+ * @param level The level, from 1.
+ * @return The delay in input samples.
+ */
+double SampleDwt::detail_delay(size_t level) const {
+  if (level == 0 || level > counts_.size()) {
+    throw std::runtime_error("Level out of range!");
+  }
+  return approximation_delay(level - 1) +
+         static_cast<double>(size_t(1) << (level - 1)) * highDelay_;
+}
+
+//-------------------------------------------------------------
+/**
+ * Computes the delay of the approximation of a level, the lowpass filter at
+ * the sample rate of every level up to it.
+ *
+ * @param level The level, or 0 for the input itself.
+ * @return The delay in input samples.
+ */
+double SampleDwt::approximation_delay(size_t level) const {
+  if (level > counts_.size()) {
+    throw std::runtime_error("Level out of range!");
+  }
+  // lowDelay_ * (1 + 2 + .. + 2^(level - 1))
+  return static_cast<double>((size_t(1) << level) - 1) * lowDelay_;
+}
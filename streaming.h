@@ -0,0 +1,171 @@
+#ifndef streaming_h
+#define streaming_h
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wavelets.h"
+
+struct KernelTable;
+
+// Single level "sym" dwt of a signal that arrives in blocks of any size. The
+// stream keeps the samples that coefficients still to come read, at most
+// filterSize - 1 of them between calls, and emits cA[k] / cD[k] as soon as
+// sample 2k + 1 is in. Emission starts once filterSize - 1 samples are in,
+// which the reflection at the start needs. flush() ends the signal with the
+// reflection at its end, after which the coefficients emitted by all calls
+// are exactly those of dwt() on the whole signal, and the stream starts over.
+class StreamingDwt {
+public:
+  explicit StreamingDwt(const std::string &wavelet_name,
+                        const std::string &mode = "sym");
+
+  explicit StreamingDwt(const Wavelet &w, const std::string &mode = "sym");
+
+  // number of coefficient pairs push() emits for blockSize more samples
+  size_t push_output_size(size_t blockSize) const;
+
+  // number of coefficient pairs flush() emits; throws like dwt() when the
+  // signal is too short for the wavelet
+  size_t flush_output_size() const;
+
+  // Appends samples and writes the coefficients they complete to cA and cD,
+  // push_output_size() of each, which is returned.
+  size_t push(const double *block, size_t blockSize, double *cA, double *cD);
+
+  // Ends the signal, writes the remaining flush_output_size() coefficients
+  // and returns their number.
+  size_t flush(double *cA, double *cD);
+
+  std::pair<std::vector<double>, std::vector<double>>
+  push(const std::vector<double> &block);
+
+  std::pair<std::vector<double>, std::vector<double>> flush();
+
+  // Drops the samples of the current signal.
+  void reset();
+
+  // samples pushed since the signal started
+  size_t samples() const { return received_; }
+
+private:
+  void emit(size_t last, double *cA, double *cD);
+
+  const Wavelet *wavelet_;
+  const KernelTable *kernels_;
+  // samples of the signal extended by the reflection at its start,
+  // extended[base_ .. base_ + used_)
+  std::vector<double> buffer_;
+  // coefficients as the kernel writes them, before they are handed out
+  std::vector<double> stageA_;
+  std::vector<double> stageD_;
+  size_t base_;
+  size_t used_;
+  size_t received_;
+  size_t emitted_;
+};
+
+// Coefficients a StreamingDecomposition emits: the details of every level,
+// cD[0] for level 1 up to cD[level - 1], and the approximation of the last
+// level.
+struct StreamingCoefficients {
+  std::vector<std::vector<double>> cD;
+  std::vector<double> cA;
+};
+
+// Multilevel "sym" decomposition of a signal that arrives in blocks, as a
+// cascade of StreamingDwt stages each fed by the cA the stage before emits.
+// Every stage keeps at most filterSize - 1 samples. After flush() the
+// details of level j emitted by all calls are exactly cD_j of
+// wavelet_decomposition() on the whole signal, and the approximations its
+// cA_level.
+class StreamingDecomposition {
+public:
+  StreamingDecomposition(size_t level, const std::string &wavelet_name,
+                         const std::string &mode = "sym");
+
+  StreamingDecomposition(size_t level, const Wavelet &w,
+                         const std::string &mode = "sym");
+
+  size_t level() const { return stages_.size(); }
+
+  // Appends samples and replaces the contents of out with the coefficients
+  // they complete. out keeps its capacity, so reusing it for every call
+  // stops allocating once it has grown to the block size.
+  void push(const double *block, size_t blockSize, StreamingCoefficients &out);
+
+  // Ends the signal, replaces the contents of out with the remaining
+  // coefficients and starts over. Throws like wavelet_decomposition() when
+  // the signal is too short for the level, keeping the samples.
+  void flush(StreamingCoefficients &out);
+
+  StreamingCoefficients push(const std::vector<double> &block);
+
+  StreamingCoefficients flush();
+
+  void reset();
+
+  // samples pushed since the signal started
+  size_t samples() const { return received_; }
+
+private:
+  const Wavelet *wavelet_;
+  std::vector<StreamingDwt> stages_;
+  // cA passed from one stage to the next
+  std::vector<double> scratch_[2];
+  size_t received_;
+};
+
+// Multilevel dwt of a signal pushed one sample at a time, for loops that need
+// every coefficient as soon as its last sample is in. Each level is a causal
+// decimating filter over a ring buffer of the last filterSize samples it was
+// fed: level 1 emits a coefficient pair on every second sample once the ring
+// is full, and level j + 1 runs on the cA of level j. There is no boundary
+// extension, so level 1 gives cA_1[k] and cD_1[k] of dwt() for k >= filterSize
+// / 2 - 1, and the deeper levels the same outputs for the cA stream of the
+// level above. The rings are allocated once, push() does not allocate.
+class SampleDwt {
+public:
+  SampleDwt(size_t level, const std::string &wavelet_name);
+
+  SampleDwt(size_t level, const Wavelet &w);
+
+  size_t level() const { return counts_.size(); }
+
+  // Pushes one sample. Returns the number m of levels that emitted a
+  // coefficient, always levels 1 .. m, with cD[j - 1] set for those levels
+  // and cA set to the approximation of the last level when m == level().
+  size_t push(double sample, double *cD, double &cA);
+
+  // Delays in samples of the input between the sample a push() emits on and
+  // the coefficient it emits, for the details of level j and the
+  // approximation of level j. They are the group delays of the cascaded
+  // filters, at DC for lowpass and at the Nyquist frequency for highpass
+  // filters; for the symmetric biorthogonal filters they hold at every
+  // frequency.
+  double detail_delay(size_t level) const;
+
+  double approximation_delay(size_t level) const;
+
+  // Empties the rings.
+  void reset();
+
+private:
+  const Wavelet *wavelet_;
+  const KernelTable *kernels_;
+  // per level, the last filterSize samples stored twice, so that the window
+  // ending at the newest one is contiguous
+  std::vector<double> rings_;
+  std::vector<size_t> positions_;
+  // samples fed to each level
+  std::vector<size_t> counts_;
+  // the one coefficient pair the kernel writes, at filterSize / 2 - 1
+  std::vector<double> stageA_;
+  std::vector<double> stageD_;
+  double lowDelay_;
+  double highDelay_;
+};
+
+#endif /* streaming_h */
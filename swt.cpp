@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffers.h"
+#include "kernels.h"
+#include "swt.h"
+#include "threadpool.h"
+#include "wavelets.h"
+
+// Levels of at least two chunks are split over the thread pool, a chunk at a
+// time, as in wavelet_decomposition().
+static const size_t kParallelChunk = 1 << 15;
+
+// owner of the per thread buffers of this file: 0 for the extended input of
+// a level, 1 for the extended details of a level of the inverse, 2 for the
+// halved synthesis filters
+struct SwtBuffers;
+
+//-------------------------------------------------------------
+/**
+ * Checks the sizes of a stationary wavelet transform.
+ *
+ * @param signalSize The number of samples.
+ * @param level The number of levels.
+ */
+static void check_swt_size(size_t signalSize, size_t level) {
+  if (signalSize == 0) {
+    throw std::runtime_error("input or wfilters is empty!");
+  }
+  if (level >= 8 * sizeof(size_t) || signalSize % (size_t(1) << level) != 0) {
+    throw std::runtime_error("Signal length must be a multiple of 2^level!");
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Copies a signal extended periodically, so that extended[i] is
+ * signal[(i - shift) mod signalSize].
+ *
+ * @param signal The signal.
+ * @param signalSize The number of samples.
+ * @param shift How far the signal is moved right, any amount.
+ * @param extended The extended signal.
+ * @param extendedSize The number of samples to write.
+ */
+static void extend_periodic(const double *signal, size_t signalSize,
+                            size_t shift, double *extended,
+                            size_t extendedSize) {
+  size_t index = (signalSize - shift % signalSize) % signalSize;
+  size_t i = 0;
+  while (i < extendedSize) {
+    const size_t count = std::min(signalSize - index, extendedSize - i);
+    std::copy(signal + index, signal + index + count, extended + i);
+    i += count;
+    index = 0;
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Runs task(first, last) over [0, size), in chunks on the pool when there are
+ * at least two of them.
+ *
+ * @param size The number of outputs.
+ * @param pool The threads to run on, or nullptr.
+ * @param task The work on the outputs [first, last).
+ */
+template <typename Task>
+static void for_chunks(size_t size, ThreadPool *pool, const Task &task) {
+  if (pool == nullptr || pool->size() < 2 || size < 2 * kParallelChunk) {
+    task(0, size);
+    return;
+  }
+  std::vector<size_t> chunks((size + kParallelChunk - 1) / kParallelChunk);
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    chunks[i] = i;
+  }
+  pool->run(chunks, [&](size_t i) {
+    const size_t first = i * kParallelChunk;
+    task(first, std::min(first + kParallelChunk, size));
+  });
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a stationary wavelet transform. Level j extends its input
+ * periodically by 2^(j - 1) * (filterSize - 1) samples, placed so that
+ * output i reads input i + 2^(j - 1) * (filterSize / 2 - m) against tap m,
+ * and runs the a trous kernel over the extension.
+ *
+ * @param signal The signal.
+ * @param signalSize The number of samples, a multiple of 2^level.
+ * @param level The number of levels.
+ * @param w The wavelet.
+ * @param swa The approximations, level rows of signalSize.
+ * @param swd The details, level rows of signalSize.
+ * @param pool The threads to run on, or nullptr.
+ */
+static void swt_levels(const double *signal, size_t signalSize, size_t level,
+                       const Wavelet &w, double *swa, double *swd,
+                       ThreadPool *pool) {
+  check_swt_size(signalSize, level);
+  const KernelTable &kernels = active_kernels();
+  const size_t L = w.filterSize;
+  const double *input = signal;
+  for (size_t j = 0; j < level; ++j) {
+    const size_t step = size_t(1) << j;
+    double *extended =
+        thread_buffer<SwtBuffers>(0, signalSize + (L - 1) * step);
+    extend_periodic(input, signalSize, step * (L / 2 - 1), extended,
+                    signalSize + (L - 1) * step);
+    double *cA = swa + j * signalSize;
+    double *cD = swd + j * signalSize;
+    for_chunks(signalSize, pool, [&](size_t first, size_t last) {
+      kernels.swt_analysis(extended + first, last - first, step, w.Lo_D,
+                           w.Ho_D, L, cA + first, cD + first);
+    });
+    input = cA;
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Inverts a stationary wavelet transform. Level j extends its approximation
+ * and details periodically the other way round from swt_levels() and runs
+ * the a trous synthesis kernel with the reconstruction filters halved,
+ * which averages the reconstructions of the two decimation phases. The
+ * approximation of each level is built in the output.
+ *
+ * @param cA The approximation of the last level, signalSize values.
+ * @param swd The details, level rows of signalSize.
+ * @param signalSize The number of samples, a multiple of 2^level.
+ * @param level The number of levels.
+ * @param w The wavelet.
+ * @param signal The reconstructed signal.
+ * @param pool The threads to run on, or nullptr.
+ */
+static void iswt_levels(const double *cA, const double *swd,
+                        size_t signalSize, size_t level, const Wavelet &w,
+                        double *signal, ThreadPool *pool) {
+  check_swt_size(signalSize, level);
+  const KernelTable &kernels = active_kernels();
+  const size_t L = w.filterSize;
+  double *halved = thread_buffer<SwtBuffers>(2, 2 * L);
+  for (size_t m = 0; m < L; ++m) {
+    halved[m] = 0.5 * w.Lo_R[m];
+    halved[L + m] = 0.5 * w.Ho_R[m];
+  }
+
+  std::copy(cA, cA + signalSize, signal);
+  for (size_t j = level; j-- > 0;) {
+    const size_t step = size_t(1) << j;
+    const size_t extendedSize = signalSize + (L - 1) * step;
+    double *a = thread_buffer<SwtBuffers>(0, extendedSize);
+    double *d = thread_buffer<SwtBuffers>(1, extendedSize);
+    extend_periodic(signal, signalSize, step * (L / 2), a, extendedSize);
+    extend_periodic(swd + j * signalSize, signalSize, step * (L / 2), d,
+                    extendedSize);
+    for_chunks(signalSize, pool, [&](size_t first, size_t last) {
+      kernels.swt_synthesis(a + first, d + first, last - first, step, halved,
+                            halved + L, L, signal + first);
+    });
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a stationary wavelet transform of a signal.
+ *
+ * @param signal The signal, a multiple of 2^level samples.
+ * @param level The number of levels.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @return swa and swd, level rows of signal.size() values each.
+ */
+std::pair<std::vector<double>, std::vector<double>>
+swt(const std::vector<double> &signal, size_t level,
+    const std::string wavelet_name) {
+  const Wavelet &w = wavelet(wavelet_name);
+  check_swt_size(signal.size(), level);
+  std::vector<double> swa(level * signal.size());
+  std::vector<double> swd(level * signal.size());
+  swt_levels(signal.data(), signal.size(), level, w, swa.data(), swd.data(),
+             nullptr);
+  return std::make_pair(std::move(swa), std::move(swd));
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a stationary wavelet transform of a signal on a thread pool.
+ *
+ * @param signal The signal, a multiple of 2^level samples.
+ * @param level The number of levels.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @param pool The threads to run on.
+ * @return swa and swd, level rows of signal.size() values each.
+ */
+std::pair<std::vector<double>, std::vector<double>>
+swt(const std::vector<double> &signal, size_t level,
+    const std::string wavelet_name, ThreadPool &pool) {
+  const Wavelet &w = wavelet(wavelet_name);
+  check_swt_size(signal.size(), level);
+  std::vector<double> swa(level * signal.size());
+  std::vector<double> swd(level * signal.size());
+  swt_levels(signal.data(), signal.size(), level, w, swa.data(), swd.data(),
+             &pool);
+  return std::make_pair(std::move(swa), std::move(swd));
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a stationary wavelet transform into caller provided buffers.
+ *
+ * @param signal The signal.
+ * @param signalSize The number of samples, a multiple of 2^level.
+ * @param level The number of levels.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param swa The approximations, level * signalSize values.
+ * @param swd The details, level * signalSize values.
+ */
+void swt(const double *signal, size_t signalSize, size_t level,
+         const Wavelet &w, double *swa, double *swd) {
+  swt_levels(signal, signalSize, level, w, swa, swd, nullptr);
+}
+
+//-------------------------------------------------------------
+/**
+ * Performs a stationary wavelet transform into caller provided buffers on a
+ * thread pool.
+ *
+ * @param signal The signal.
+ * @param signalSize The number of samples, a multiple of 2^level.
+ * @param level The number of levels.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param swa The approximations, level * signalSize values.
+ * @param swd The details, level * signalSize values.
+ * @param pool The threads to run on.
+ */
+void swt(const double *signal, size_t signalSize, size_t level,
+         const Wavelet &w, double *swa, double *swd, ThreadPool &pool) {
+  swt_levels(signal, signalSize, level, w, swa, swd, &pool);
+}
+
+//-------------------------------------------------------------
+/**
+ * Inverts a stationary wavelet transform.
+ *
+ * @param cA The approximation of the last level.
+ * @param swd The details of every level, a multiple of cA.size() values.
+ * @param wavelet_name The wavelet name, see wavelet() for the registry.
+ * @return The signal, cA.size() samples.
+ */
+std::vector<double> iswt(const std::vector<double> &cA,
+                         const std::vector<double> &swd,
+                         const std::string wavelet_name) {
+  const Wavelet &w = wavelet(wavelet_name);
+  if (cA.empty() || swd.size() % cA.size() != 0) {
+    throw std::runtime_error("Detail size is not a multiple of cA size!");
+  }
+  std::vector<double> signal(cA.size());
+  iswt_levels(cA.data(), swd.data(), cA.size(), swd.size() / cA.size(), w,
+              signal.data(), nullptr);
+  return signal;
+}
+
+//-------------------------------------------------------------
+/**
+ * Inverts a stationary wavelet transform into a caller provided buffer.
+ *
+ * @param cA The approximation of the last level, signalSize values.
+ * @param swd The details, level * signalSize values.
+ * @param signalSize The number of samples, a multiple of 2^level.
+ * @param level The number of levels.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param signal The signal, signalSize samples.
+ */
+void iswt(const double *cA, const double *swd, size_t signalSize, size_t level,
+          const Wavelet &w, double *signal) {
+  iswt_levels(cA, swd, signalSize, level, w, signal, nullptr);
+}
+
+//-------------------------------------------------------------
+/**
+ * Inverts a stationary wavelet transform into a caller provided buffer on a
+ * thread pool.
+ *
+ * @param cA The approximation of the last level, signalSize values.
+ * @param swd The details, level * signalSize values.
+ * @param signalSize The number of samples, a multiple of 2^level.
+ * @param level The number of levels.
+ * @param w The wavelet, resolved once with wavelet().
+ * @param signal The signal, signalSize samples.
+ * @param pool The threads to run on.
+ */
+void iswt(const double *cA, const double *swd, size_t signalSize, size_t level,
+          const Wavelet &w, double *signal, ThreadPool &pool) {
+  iswt_levels(cA, swd, signalSize, level, w, signal, &pool);
+}
@@ -0,0 +1,54 @@
+#ifndef swt_h
+#define swt_h
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wavelets.h"
+
+class ThreadPool;
+
+// Stationary (undecimated) wavelet transform with periodic extension, the
+// swt of MATLAB and pywt. Level j filters the cA of level j - 1 with the
+// filters dilated by 2^(j - 1) and keeps every output, so it is shift
+// invariant and each level has as many coefficients as the signal, whose
+// length must be a multiple of 2^level. The dilated filters are applied a
+// trous, reading every 2^(j - 1)-th sample rather than multiplying inserted
+// zeros, so a level costs the same at any depth. The coefficients are swa and
+// swd, level rows of signalSize values each, row j - 1 for level j.
+std::pair<std::vector<double>, std::vector<double>>
+swt(const std::vector<double> &signal, size_t level,
+    const std::string wavelet_name);
+
+// Same with the levels of long signals split over a thread pool in chunks of
+// coefficients; the result is bit-identical to the serial one. Must not be
+// called from a task of the same pool.
+std::pair<std::vector<double>, std::vector<double>>
+swt(const std::vector<double> &signal, size_t level,
+    const std::string wavelet_name, ThreadPool &pool);
+
+// Same, into caller provided buffers of level * signalSize values each. The
+// extended input of a level goes to a per thread buffer that is reused
+// between calls.
+void swt(const double *signal, size_t signalSize, size_t level,
+         const Wavelet &w, double *swa, double *swd);
+
+void swt(const double *signal, size_t signalSize, size_t level,
+         const Wavelet &w, double *swa, double *swd, ThreadPool &pool);
+
+// Inverse of swt() from the approximation of the last level, the last row of
+// swa, and all of swd; the level follows from their sizes. Each level
+// averages the reconstructions of its two decimation phases.
+std::vector<double> iswt(const std::vector<double> &cA,
+                         const std::vector<double> &swd,
+                         const std::string wavelet_name);
+
+void iswt(const double *cA, const double *swd, size_t signalSize, size_t level,
+          const Wavelet &w, double *signal);
+
+void iswt(const double *cA, const double *swd, size_t signalSize, size_t level,
+          const Wavelet &w, double *signal, ThreadPool &pool);
+
+#endif /* swt_h */
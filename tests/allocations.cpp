@@ -0,0 +1,52 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "allocations.h"
+
+// Every form of operator new and delete but the aligned ones is replaced,
+// all over malloc and free, so that whichever form allocates, the one that
+// frees matches it. They live apart from the tests so that their bodies are
+// not inlined next to the allocations of the standard library.
+static std::atomic<size_t> allocations(0);
+
+static void *count_allocation(size_t size) noexcept {
+  ++allocations;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+size_t heap_allocations() { return allocations; }
+
+void *operator new(size_t size) {
+  if (void *p = count_allocation(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return count_allocation(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return count_allocation(size);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,10 @@
+#ifndef allocations_h
+#define allocations_h
+
+#include <cstddef>
+
+// number of heap allocations of the whole test program so far, counted by
+// the operator new of allocations.cpp, for the tests that require none
+size_t heap_allocations();
+
+#endif /* allocations_h */
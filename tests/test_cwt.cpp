@@ -0,0 +1,172 @@
+#include <cmath>
+#include <complex>
+#include <random>
+#include <string>
+#include <vector>
+#include "../cwt.h"
+#include "../threadpool.h"
+#include <catch.hpp>
+
+typedef std::complex<double> Complex;
+
+static const double kPi = 3.14159265358979323846;
+
+// the wavelets from their time domain definitions; cgau through the
+// polynomial P with d^p/dt^p exp(-it - t^2) = P(t) exp(-it - t^2)
+static Complex psi(const std::string &name, double t) {
+  if (name == "morl") {
+    return std::exp(-t * t / 2.0) * std::cos(5.0 * t);
+  }
+  if (name == "mexh") {
+    return 2.0 / (std::sqrt(3.0) * std::pow(kPi, 0.25)) * (1.0 - t * t) *
+           std::exp(-t * t / 2.0);
+  }
+  const size_t order = name[4] - '0';
+  std::vector<Complex> poly(1, 1.0);
+  for (size_t p = 0; p < order; ++p) {
+    // P' + P (-i - 2t)
+    std::vector<Complex> next(poly.size() + 1, 0.0);
+    for (size_t k = 0; k < poly.size(); ++k) {
+      if (k > 0) {
+        next[k - 1] += double(k) * poly[k];
+      }
+      next[k] += Complex(0.0, -1.0) * poly[k];
+      next[k + 1] += -2.0 * poly[k];
+    }
+    poly = next;
+  }
+  Complex value = 0.0;
+  for (size_t k = poly.size(); k-- > 0;) {
+    value = value * t + poly[k];
+  }
+  return value * std::exp(Complex(-t * t, -t));
+}
+
+// unit energy of cgau by quadrature
+static double cgau_energy(const std::string &name) {
+  double energy = 0.0;
+  for (double t = -12.0; t <= 12.0; t += 0.001) {
+    energy += std::norm(psi(name, t)) * 0.001;
+  }
+  return energy;
+}
+
+static std::vector<Complex> cwt_direct(const std::vector<double> &signal,
+                                       const std::vector<double> &scales,
+                                       const std::string &name) {
+  const size_t n = signal.size();
+  double norm = 1.0;
+  if (name.compare(0, 4, "cgau") == 0) {
+    norm = 1.0 / std::sqrt(cgau_energy(name));
+  }
+  std::vector<Complex> coeffs(scales.size() * n);
+  for (size_t s = 0; s < scales.size(); ++s) {
+    for (size_t b = 0; b < n; ++b) {
+      Complex sum = 0.0;
+      for (size_t m = 0; m < n; ++m) {
+        const double t = (double(m) - double(b)) / scales[s];
+        sum += signal[m] * std::conj(psi(name, t));
+      }
+      coeffs[s * n + b] = norm * sum / std::sqrt(scales[s]);
+    }
+  }
+  return coeffs;
+}
+
+TEST_CASE("test cwt func", "[cwt]") {
+  std::mt19937 gen(79);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches the direct sum") {
+    std::vector<double> signal(300);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    const std::vector<double> scales = {4.0, 5.5, 8.0, 13.0, 20.0};
+    for (const char *name : {"morl", "mexh", "cgau1", "cgau2", "cgau5"}) {
+      INFO(name);
+      auto coeffs = cwt(signal, scales, name);
+      auto expected = cwt_direct(signal, scales, name);
+      REQUIRE(coeffs.size() == expected.size());
+      double peak = 0.0;
+      for (const Complex &c : expected) {
+        peak = std::max(peak, std::abs(c));
+      }
+      for (size_t i = 0; i < coeffs.size(); ++i) {
+        REQUIRE(std::abs(coeffs[i] - expected[i]) < 1e-6 * peak);
+      }
+    }
+  }
+
+  SECTION("large scales do not wrap around") {
+    // the wavelets reach past twice the signal length
+    std::vector<double> signal(200);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    const std::vector<double> scales = {30.0, 60.0, 150.0};
+    for (const char *name : {"morl", "mexh", "cgau4"}) {
+      INFO(name);
+      auto coeffs = cwt(signal, scales, name);
+      auto expected = cwt_direct(signal, scales, name);
+      double peak = 0.0;
+      for (const Complex &c : expected) {
+        peak = std::max(peak, std::abs(c));
+      }
+      for (size_t i = 0; i < coeffs.size(); ++i) {
+        REQUIRE(std::abs(coeffs[i] - expected[i]) < 1e-6 * peak);
+      }
+    }
+  }
+
+  SECTION("real wavelets give real coefficients") {
+    std::vector<double> signal(101);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    // an odd number of scales leaves the last one unpaired
+    auto coeffs = cwt(signal, {4.0, 6.0, 9.0}, "mexh");
+    for (const Complex &c : coeffs) {
+      REQUIRE(c.imag() == 0.0);
+    }
+  }
+
+  SECTION("plan reuse and thread pool") {
+    std::vector<double> scales;
+    for (size_t i = 0; i < 40; ++i) {
+      scales.push_back(4.0 * std::pow(1.1, double(i)));
+    }
+    CwtPlan plan(5000, scales, "cgau3");
+    REQUIRE(plan.signal_size() == 5000);
+    REQUIRE(plan.scales() == scales);
+    // padded by the support of the widest cgau3, 8 times its scale
+    REQUIRE(plan.fft_size() >= 5000 + 8.0 * scales.back());
+    ThreadPool pool(3);
+    for (int trial = 0; trial < 2; ++trial) {
+      std::vector<double> signal(5000);
+      for (double &x : signal) {
+        x = dist(gen);
+      }
+      std::vector<Complex> serial(scales.size() * 5000);
+      std::vector<Complex> threaded(scales.size() * 5000);
+      plan.execute(signal.data(), serial.data());
+      plan.execute(signal.data(), threaded.data(), pool);
+      REQUIRE(threaded == serial);
+      REQUIRE(cwt(signal, scales, "cgau3") == serial);
+    }
+  }
+
+  SECTION("errors") {
+    std::vector<double> signal(16);
+    REQUIRE_THROWS_WITH(cwt(signal, {2.0}, "db2"), "Unknown wavelet name!");
+    REQUIRE_THROWS_WITH(cwt(signal, {2.0}, "cgau9"), "Unknown wavelet name!");
+    REQUIRE_THROWS_WITH(cwt(signal, {2.0, 0.0}, "morl"),
+                        "Scales must be positive and finite!");
+    REQUIRE_THROWS_WITH(cwt(signal, {4.0, HUGE_VAL}, "morl"),
+                        "Scales must be positive and finite!");
+    REQUIRE_THROWS_WITH(cwt(signal, {4.0, std::nan("")}, "mexh"),
+                        "Scales must be positive and finite!");
+    REQUIRE_THROWS_WITH(cwt(std::vector<double>(), {2.0}, "morl"),
+                        "Signal is empty!");
+  }
+}
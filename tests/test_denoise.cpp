@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "../denoise.h"
+#include "../dwt.h"
+#include <catch.hpp>
+
+static double median(std::vector<double> x) {
+  std::sort(x.begin(), x.end());
+  const size_t n = x.size();
+  return n % 2 == 1 ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2.0;
+}
+
+// the threshold rules by brute force, for details of unit noise
+static double rule_threshold(const std::vector<double> &x,
+                             const std::string &rule) {
+  const double n = double(x.size());
+  if (rule == "universal") {
+    return std::sqrt(2.0 * std::log(n));
+  }
+  if (rule == "minimax") {
+    return x.size() > 32 ? 0.3936 + 0.1829 * std::log2(n) : 0.0;
+  }
+  // the candidate of least risk n - 2 #{|x| <= t} + sum min(x^2, t^2)
+  double best = 0.0;
+  double bestRisk = 0.0;
+  std::vector<double> candidates;
+  for (double v : x) {
+    candidates.push_back(std::abs(v));
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (size_t k = 0; k < candidates.size(); ++k) {
+    const double t = candidates[k];
+    double risk = n;
+    for (double v : x) {
+      if (std::abs(v) <= t) {
+        risk -= 2.0;
+      }
+      risk += std::min(v * v, t * t);
+    }
+    if (k == 0 || risk < bestRisk) {
+      bestRisk = risk;
+      best = t;
+    }
+  }
+  return best;
+}
+
+static std::vector<double> denoise_reference(const std::vector<double> &signal,
+                                             size_t level,
+                                             const std::string &name,
+                                             const std::string &rule,
+                                             const std::string &shrinkage) {
+  auto decomposition = wavelet_decomposition(signal, level, name);
+  std::vector<double> &coeffs = decomposition.first;
+  const std::vector<double> &lengths = decomposition.second;
+  // cD_level .. cD_1 follow the final cA
+  size_t offset = size_t(lengths.back());
+  for (size_t i = level; i > 0; --i) {
+    const size_t size = size_t(lengths[i - 1]);
+    std::vector<double> magnitudes;
+    for (size_t j = 0; j < size; ++j) {
+      magnitudes.push_back(std::abs(coeffs[offset + j]));
+    }
+    const double sigma = median(magnitudes) / 0.6745;
+    if (sigma > 0.0) {
+      std::vector<double> normalized;
+      for (size_t j = 0; j < size; ++j) {
+        normalized.push_back(coeffs[offset + j] / sigma);
+      }
+      const double t = sigma * rule_threshold(normalized, rule);
+      for (size_t j = 0; j < size; ++j) {
+        double &c = coeffs[offset + j];
+        if (std::abs(c) <= t) {
+          c = 0.0;
+        } else if (shrinkage == "soft") {
+          c = c > 0.0 ? c - t : c + t;
+        } else if (shrinkage == "garrote") {
+          c -= t * t / c;
+        }
+      }
+    }
+    offset += size;
+  }
+  return wavelet_reconstruction(coeffs, lengths, name, signal.size());
+}
+
+TEST_CASE("test wdenoise func", "[denoise]") {
+  std::mt19937 gen(83);
+  std::normal_distribution<double> noise(0.0, 0.3);
+
+  std::vector<double> clean(1500);
+  for (size_t i = 0; i < clean.size(); ++i) {
+    // smooth, with a jump
+    clean[i] = std::sin(0.01 * i) + (i > 700 ? 1.0 : 0.0);
+  }
+  std::vector<double> noisy = clean;
+  for (double &x : noisy) {
+    x += noise(gen);
+  }
+
+  SECTION("matches decomposing, thresholding and reconstructing") {
+    for (const char *rule : {"universal", "sure", "minimax"}) {
+      for (const char *shrinkage : {"soft", "hard", "garrote"}) {
+        for (const char *name : {"db4", "sym5", "bior3.5"}) {
+          INFO(rule << " " << shrinkage << " " << name);
+          auto output = wdenoise(noisy, 4, name, rule, shrinkage);
+          auto expected = denoise_reference(noisy, 4, name, rule, shrinkage);
+          REQUIRE(output.size() == expected.size());
+          for (size_t i = 0; i < output.size(); ++i) {
+            REQUIRE(output[i] == Approx(expected[i]).margin(1e-12));
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("removes noise") {
+    auto output = wdenoise(noisy, 5, "sym8");
+    double before = 0.0;
+    double after = 0.0;
+    for (size_t i = 0; i < clean.size(); ++i) {
+      before += (noisy[i] - clean[i]) * (noisy[i] - clean[i]);
+      after += (output[i] - clean[i]) * (output[i] - clean[i]);
+    }
+    REQUIRE(after < 0.2 * before);
+  }
+
+  SECTION("in place, odd lengths and level 0") {
+    std::vector<double> signal(noisy.begin(), noisy.begin() + 777);
+    auto expected = wdenoise(signal, 3, "coif2", "sure", "soft");
+    wdenoise(signal.data(), signal.size(), 3, wavelet("coif2"), "sure", "soft",
+             signal.data());
+    REQUIRE(signal == expected);
+    REQUIRE(wdenoise(signal, 0, "db2") == signal);
+  }
+
+  SECTION("keeps a noiseless signal") {
+    std::vector<double> constant(256, 2.0);
+    auto output = wdenoise(constant, 3, "db3");
+    for (double x : output) {
+      REQUIRE(x == Approx(2.0));
+    }
+  }
+
+  SECTION("errors") {
+    REQUIRE_THROWS_WITH(wdenoise(noisy, 2, "db2", "bayes"),
+                        "Threshold rule error!");
+    REQUIRE_THROWS_WITH(wdenoise(noisy, 2, "db2", "sure", "firm"),
+                        "Shrinkage error!");
+    REQUIRE_THROWS_WITH(wdenoise(std::vector<double>(5), 1, "db4"),
+                        "input size is less than extendLen!");
+  }
+}
@@ -1,9 +1,12 @@
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
 #define CATCH_CONFIG_MAIN // 告诉Catch2生成main函数
 // #include "catch_amalgamated.hpp" // Include the Catch2 header
 #include "../dwt.h"
+#include "../threadpool.h"
+#include "allocations.h"
 #include <catch.hpp>
 #include <random>
 #include <utility>
@@ -79,6 +82,12 @@ TEST_CASE("test wextend func", "[wextend]") {
     REQUIRE_THROWS_AS(wextend(input, extendLen, mode),
                       const std::runtime_error &);
   }
+
+  SECTION("Test negative extendLen") {
+    std::vector<double> input = {1, 2, 3, 4};
+    REQUIRE_THROWS_WITH(wextend(input, -5, "sym"),
+                        "input size is less than extendLen!");
+  }
 }
 
 TEST_CASE("test wconv1 func", "[wconv1]") {
@@ -175,6 +184,64 @@ TEST_CASE("test wconv1 func", "[wconv1]") {
     std::vector<double> output = wconv1(input, wfilters, mode);
     REQUIRE(output == expectedOutput);
   }
+
+  SECTION("random signals against direct sums") {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (size_t n : {1, 5, 31, 32, 33, 100, 257}) {
+      for (size_t m : {1, 2, 7, 10, 16, 33}) {
+        std::vector<double> input(n), wfilters(m);
+        for (auto &x : input) {
+          x = dist(gen);
+        }
+        for (auto &x : wfilters) {
+          x = dist(gen);
+        }
+        INFO("input size : " << n << ", filter size : " << m);
+
+        std::vector<double> full = wconv1(input, wfilters, "full");
+        REQUIRE(full.size() == n + m - 1);
+        for (size_t i = 0; i < full.size(); ++i) {
+          double expected = 0.0;
+          for (size_t j = 0; j < n; ++j) {
+            if (i >= j && i - j < m) {
+              expected += input[j] * wfilters[i - j];
+            }
+          }
+          REQUIRE(full[i] == Approx(expected).margin(1e-12));
+        }
+
+        std::vector<double> valid = wconv1(input, wfilters, "valid");
+        REQUIRE(valid.size() == (n < m ? 0 : n - m + 1));
+        for (size_t i = 0; i < valid.size(); ++i) {
+          REQUIRE(valid[i] == Approx(full[i + m - 1]).margin(1e-12));
+        }
+      }
+    }
+  }
+
+  SECTION("long filters through the fft") {
+    std::mt19937 gen(8);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> input(3000), wfilters(500);
+    for (auto &x : input) {
+      x = dist(gen);
+    }
+    for (auto &x : wfilters) {
+      x = dist(gen);
+    }
+    std::vector<double> full = wconv1(input, wfilters, "full");
+    REQUIRE(full.size() == input.size() + wfilters.size() - 1);
+    for (size_t i = 0; i < full.size(); ++i) {
+      double expected = 0.0;
+      for (size_t j = 0; j < input.size(); ++j) {
+        if (i >= j && i - j < wfilters.size()) {
+          expected += input[j] * wfilters[i - j];
+        }
+      }
+      REQUIRE(full[i] == Approx(expected).margin(1e-10));
+    }
+  }
 }
 
 TEST_CASE("test downsample func") {
@@ -302,12 +369,117 @@ TEST_CASE("test dwt func", "[dwt]") {
       REQUIRE(cD[i] == Approx(expected_cD[i]).epsilon(0.00001));
     }
   }
+
+  SECTION("matches extend, convolve and downsample") {
+    std::vector<double> Lo_D = {
+        0.00333572528500155, -0.0125807519990155, -0.00624149021301171,
+        0.0775714938400652,  -0.0322448695850295, -0.242294887066190,
+        0.138428145901103,   0.724308528438574,   0.603829269797473,
+        0.160102397974125};
+    std::vector<double> Ho_D = {
+        -0.160102397974125,  0.603829269797473,    -0.724308528438574,
+        0.138428145901103,   0.242294887066190,    -0.0322448695850295,
+        -0.0775714938400652, -0.00624149021301171, 0.0125807519990155,
+        0.00333572528500155};
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int n = 9; n <= 41; ++n) {
+      std::vector<double> signal(n);
+      for (auto &x : signal) {
+        x = dist(gen);
+      }
+      std::vector<double> extended = wextend(signal, 9, mode);
+      std::vector<double> expected_cA =
+          downsample(wconv1(extended, Lo_D, "valid"), 2, n + 9);
+      std::vector<double> expected_cD =
+          downsample(wconv1(extended, Ho_D, "valid"), 2, n + 9);
+
+      auto result = dwt(signal, wavelet_name, mode);
+      INFO("signal length : " << n);
+      REQUIRE(result.first.size() == expected_cA.size());
+      REQUIRE(result.second.size() == expected_cD.size());
+      for (size_t i = 0; i < expected_cA.size(); i++) {
+        REQUIRE(result.first[i] == Approx(expected_cA[i]).margin(1e-12));
+        REQUIRE(result.second[i] == Approx(expected_cD[i]).margin(1e-12));
+      }
+    }
+  }
+
+  SECTION("signal shorter than extension") {
+    std::vector<double> signal(8, 1.0);
+    REQUIRE_THROWS_AS(dwt(signal, wavelet_name, mode),
+                      const std::runtime_error &);
+    REQUIRE_THROWS_AS(dwt(std::vector<double>(), wavelet_name, mode),
+                      const std::runtime_error &);
+  }
+
+  SECTION("invalid mode") {
+    REQUIRE_THROWS_AS(dwt(signal, wavelet_name, "invalid_mode"),
+                      const std::runtime_error &);
+  }
+
+  SECTION("invalid wavelet name") {
+    REQUIRE_THROWS_AS(dwt(signal, "db0", mode), const std::runtime_error &);
+  }
+
+  SECTION("haar") {
+    std::vector<double> input = {1, 2, 3, 4};
+    auto result = dwt(input, "haar", mode);
+    REQUIRE(result.first.size() == 2);
+    REQUIRE(result.first[0] == Approx(3 / std::sqrt(2.0)));
+    REQUIRE(result.first[1] == Approx(7 / std::sqrt(2.0)));
+    REQUIRE(result.second[0] == Approx(-1 / std::sqrt(2.0)));
+    REQUIRE(result.second[1] == Approx(-1 / std::sqrt(2.0)));
+  }
+
+  SECTION("wavelet handle matches name") {
+    for (const std::string name : {"db2", "sym8", "coif3", "bior3.5"}) {
+      const Wavelet &w = wavelet(name);
+      std::vector<double> input(100);
+      for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = std::sin(0.1 * i) + 0.01 * i;
+      }
+      auto byName = dwt(input, name, mode);
+      auto byHandle = dwt(input, w, mode);
+      REQUIRE(byName == byHandle);
+      REQUIRE(byName.first.size() == (input.size() + w.filterSize - 1) / 2);
+    }
+  }
 }
 
 TEST_CASE("test wavedec func") {
   std::string wavelet_name = "db5";
   std::string mode = "sym";
 
+  SECTION("matches dwt level by level") {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (size_t n : {size_t(9), size_t(100), size_t(4097)}) {
+      std::vector<double> signal(n);
+      for (auto &x : signal) {
+        x = dist(gen);
+      }
+      for (size_t level = 0; level <= 6; ++level) {
+        INFO("n = " << n << " level = " << level);
+        // cA_level, cD_level .. cD_1 from single level transforms
+        std::vector<double> cA = signal, details;
+        std::vector<double> lengths;
+        for (size_t i = 0; i < level; ++i) {
+          auto result = dwt(cA, wavelet_name, mode);
+          details.insert(details.begin(), result.second.begin(),
+                         result.second.end());
+          lengths.push_back(result.second.size());
+          cA = result.first;
+        }
+        cA.insert(cA.end(), details.begin(), details.end());
+
+        auto wavedec_set = wavelet_decomposition(signal, level, wavelet_name);
+        REQUIRE(wavedec_set.first == cA);
+        REQUIRE(wavedec_set.second == lengths);
+      }
+    }
+  }
+
   SECTION("test 1") {
     std::vector<double> signal(32, 1.0);
     int level = 5;
@@ -398,4 +570,572 @@ TEST_CASE("test wavedec func") {
               Approx(expected_coeffs[i]).epsilon(0.00001));
     }
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("test DwtPlan", "[dwt]") {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches wavelet_decomposition") {
+    for (const char *name : {"haar", "db2", "db7", "sym5", "coif3",
+                             "bior4.4", "rbio3.9"}) {
+      for (size_t n : {size_t(40), size_t(257), size_t(1000)}) {
+        for (size_t level = 0; level <= 3; ++level) {
+          std::vector<double> signal(n);
+          for (auto &x : signal) {
+            x = dist(gen);
+          }
+          INFO(name << " n = " << n << " level = " << level);
+          auto expected = wavelet_decomposition(signal, level, name);
+          DwtPlan plan(n, level, name);
+          REQUIRE(plan.signal_size() == n);
+          REQUIRE(plan.level() == level);
+          REQUIRE(plan.output_size() == expected.first.size());
+          REQUIRE(plan.lengths().size() == expected.second.size());
+          for (size_t i = 0; i < level; ++i) {
+            REQUIRE(plan.lengths()[i] == expected.second[i]);
+          }
+          std::vector<double> coeffs;
+          plan.execute(signal, coeffs);
+          REQUIRE(coeffs == expected.first);
+        }
+      }
+    }
+  }
+
+  SECTION("lifting strategy") {
+    for (const char *name : {"haar", "db4", "sym8", "coif2"}) {
+      std::vector<double> signal(777);
+      for (auto &x : signal) {
+        x = dist(gen);
+      }
+      INFO(name);
+      auto expected = wavelet_decomposition(signal, 4, name);
+      DwtPlan plan(signal.size(), 4, name, "sym", DwtStrategy::Lifting);
+      std::vector<double> coeffs;
+      plan.execute(signal, coeffs);
+      REQUIRE(coeffs.size() == expected.first.size());
+      for (size_t i = 0; i < coeffs.size(); ++i) {
+        REQUIRE(coeffs[i] == Approx(expected.first[i]).margin(1e-12));
+      }
+    }
+  }
+
+  SECTION("execute does not allocate") {
+    for (DwtStrategy strategy :
+         {DwtStrategy::FilterBank, DwtStrategy::Lifting}) {
+      std::vector<double> signal(5000);
+      for (auto &x : signal) {
+        x = dist(gen);
+      }
+      DwtPlan plan(signal.size(), 5, "db10", "sym", strategy);
+      std::vector<double> coeffs(plan.output_size());
+      std::vector<double> first;
+      plan.execute(signal, first);
+
+      const size_t before = heap_allocations();
+      for (int i = 0; i < 3; ++i) {
+        plan.execute(signal.data(), coeffs.data());
+        plan.execute(signal, coeffs);
+      }
+      const size_t after = heap_allocations();
+      REQUIRE(after == before);
+      REQUIRE(coeffs == first);
+    }
+  }
+
+  SECTION("errors") {
+    REQUIRE_THROWS_WITH(DwtPlan(100, 2, "db2", "zpd"), "Mode error!");
+    REQUIRE_THROWS_WITH(DwtPlan(100, 2, "db99"), "Unknown wavelet name!");
+    REQUIRE_THROWS_WITH(DwtPlan(0, 1, "db2"), "input or wfilters is empty!");
+    // shorter than the 19 samples db10 extends by
+    REQUIRE_THROWS_WITH(DwtPlan(10, 2, "db10"),
+                        "input size is less than extendLen!");
+    REQUIRE_THROWS_WITH(DwtPlan(100, 2, "bior2.2", "sym", DwtStrategy::Lifting),
+                        "Lifting needs an orthogonal wavelet!");
+
+    DwtPlan plan(100, 2, "db2");
+    std::vector<double> signal(99), coeffs;
+    REQUIRE_THROWS_WITH(plan.execute(signal, coeffs),
+                        "Signal size does not match the plan!");
+  }
+}
+
+TEST_CASE("test buffer overloads", "[dwt]") {
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("size queries") {
+    const Wavelet &w = wavelet("db4");
+    REQUIRE(dwt_output_size(100, w) == 53);
+    REQUIRE(dwt_output_size(7, w) == 7);
+    REQUIRE(wavedec_output_size(100, 0, w) == 100);
+    // 100 -> 53 -> 30, and the final cA
+    REQUIRE(wavedec_output_size(100, 2, w) == 53 + 30 + 30);
+    REQUIRE_THROWS_WITH(dwt_output_size(0, w), "input or wfilters is empty!");
+    REQUIRE_THROWS_WITH(dwt_output_size(6, w),
+                        "input size is less than extendLen!");
+    REQUIRE_THROWS_WITH(wavedec_output_size(6, 1, w),
+                        "input size is less than extendLen!");
+  }
+
+  SECTION("dwt matches the vector version") {
+    for (const char *name : {"haar", "db3", "sym6", "bior2.8"}) {
+      const Wavelet &w = wavelet(name);
+      std::vector<double> signal(301);
+      for (auto &x : signal) {
+        x = dist(gen);
+      }
+      INFO(name);
+      auto expected = dwt(signal, w, "sym");
+      std::vector<double> cA(dwt_output_size(signal.size(), w));
+      std::vector<double> cD(cA.size());
+      dwt(signal.data(), signal.size(), w, "sym", cA.data(), cD.data());
+      REQUIRE(cA == expected.first);
+      REQUIRE(cD == expected.second);
+
+      if (w.orthogonal) {
+        auto lifted = dwt(signal, w, "sym", DwtStrategy::Lifting);
+        dwt(signal.data(), signal.size(), w, "sym", cA.data(), cD.data(),
+            DwtStrategy::Lifting);
+        REQUIRE(cA == lifted.first);
+        REQUIRE(cD == lifted.second);
+      }
+    }
+    std::vector<double> out(10);
+    REQUIRE_THROWS_WITH(dwt(out.data(), out.size(), wavelet("haar"), "zpd",
+                            out.data(), out.data()),
+                        "Mode error!");
+  }
+
+  SECTION("wavelet_decomposition matches the vector version") {
+    for (const char *name : {"haar", "db5", "coif2", "rbio1.3"}) {
+      const Wavelet &w = wavelet(name);
+      for (size_t level = 0; level <= 5; ++level) {
+        std::vector<double> signal(1000);
+        for (auto &x : signal) {
+          x = dist(gen);
+        }
+        INFO(name << " level = " << level);
+        auto expected = wavelet_decomposition(signal, level, name);
+        std::vector<double> coeffs(
+            wavedec_output_size(signal.size(), level, w));
+        wavelet_decomposition(signal.data(), signal.size(), level, w,
+                              coeffs.data());
+        REQUIRE(coeffs == expected.first);
+      }
+    }
+  }
+
+  SECTION("repeated calls do not allocate") {
+    const Wavelet &w = wavelet("sym4");
+    std::vector<double> signal(4096);
+    for (auto &x : signal) {
+      x = dist(gen);
+    }
+    std::vector<double> coeffs(wavedec_output_size(signal.size(), 6, w));
+    std::vector<double> cA(dwt_output_size(signal.size(), w));
+    std::vector<double> cD(cA.size());
+    for (DwtStrategy strategy :
+         {DwtStrategy::FilterBank, DwtStrategy::Lifting}) {
+      // the first calls size the per thread buffers
+      wavelet_decomposition(signal.data(), signal.size(), 6, w, coeffs.data(),
+                            strategy);
+      dwt(signal.data(), signal.size(), w, "sym", cA.data(), cD.data(),
+          strategy);
+
+      const size_t before = heap_allocations();
+      wavelet_decomposition(signal.data(), signal.size(), 6, w, coeffs.data(),
+                            strategy);
+      dwt(signal.data(), signal.size(), w, "sym", cA.data(), cD.data(),
+          strategy);
+      const size_t after = heap_allocations();
+      REQUIRE(after == before);
+    }
+  }
+}
+
+TEST_CASE("test idwt func", "[idwt]") {
+  std::mt19937 gen(13);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches upsampling and full convolution") {
+    for (const char *name : {"haar", "db3", "sym7", "bior3.5"}) {
+      const Wavelet &w = wavelet(name);
+      const size_t L = w.filterSize;
+      std::vector<double> cA(25), cD(25);
+      for (size_t i = 0; i < cA.size(); ++i) {
+        cA[i] = dist(gen);
+        cD[i] = dist(gen);
+      }
+      // dyadup, convolve, keep the central 2 * n - L + 2 samples
+      std::vector<double> upA(2 * cA.size() - 1, 0.0), upD(upA.size(), 0.0);
+      for (size_t i = 0; i < cA.size(); ++i) {
+        upA[2 * i] = cA[i];
+        upD[2 * i] = cD[i];
+      }
+      std::vector<double> Lo_R(w.Lo_R, w.Lo_R + L), Ho_R(w.Ho_R, w.Ho_R + L);
+      std::vector<double> a = wconv1(upA, Lo_R, "full");
+      std::vector<double> d = wconv1(upD, Ho_R, "full");
+
+      INFO(name);
+      std::vector<double> signal = idwt(cA, cD, name, "sym");
+      REQUIRE(signal.size() == 2 * cA.size() - L + 2);
+      for (size_t i = 0; i < signal.size(); ++i) {
+        REQUIRE(signal[i] ==
+                Approx(a[i + L - 2] + d[i + L - 2]).margin(1e-12));
+      }
+    }
+  }
+
+  SECTION("inverts dwt for every wavelet") {
+    for (size_t id = 0; id < wavelet_count(); ++id) {
+      const Wavelet &w = wavelet_at(id);
+      for (size_t n :
+           {w.filterSize, w.filterSize + 1, size_t(64), size_t(99)}) {
+        std::vector<double> signal(n);
+        for (auto &x : signal) {
+          x = dist(gen);
+        }
+        INFO(w.name << " n = " << n);
+        auto coeffs = dwt(signal, w, "sym");
+        std::vector<double> rec =
+            idwt(coeffs.first, coeffs.second, w, "sym", n);
+        REQUIRE(rec.size() == n);
+        for (size_t i = 0; i < n; ++i) {
+          REQUIRE(rec[i] == Approx(signal[i]).margin(1e-10));
+        }
+        // odd lengths come back with one extra sample by default
+        REQUIRE(idwt(coeffs.first, coeffs.second, w, "sym").size() ==
+                n + n % 2);
+      }
+    }
+  }
+
+  SECTION("errors") {
+    std::vector<double> cA(10), cD(9);
+    REQUIRE_THROWS_WITH(idwt(cA, cD, "db2", "sym"),
+                        "cA and cD must have the same length!");
+    cD.resize(10);
+    REQUIRE_THROWS_WITH(idwt(cA, cD, "db2", "zpd"), "Mode error!");
+    REQUIRE_THROWS_WITH(idwt(cA, cD, "db2", "sym", 15),
+                        "Signal size does not match the coefficients!");
+    REQUIRE_THROWS_WITH(idwt(cA, cD, "db20", "sym"),
+                        "Coefficients are shorter than the filters!");
+  }
+}
+
+TEST_CASE("test waverec func", "[idwt]") {
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("inverts wavelet_decomposition") {
+    for (const char *name : {"haar", "db4", "sym5", "coif2", "bior2.4",
+                             "rbio6.8"}) {
+      for (size_t n : {size_t(50), size_t(127), size_t(1024)}) {
+        for (size_t level = 0; level <= 4; ++level) {
+          std::vector<double> signal(n);
+          for (auto &x : signal) {
+            x = dist(gen);
+          }
+          INFO(name << " n = " << n << " level = " << level);
+          auto wavedec_set = wavelet_decomposition(signal, level, name);
+          std::vector<double> rec = wavelet_reconstruction(
+              wavedec_set.first, wavedec_set.second, name, n);
+          REQUIRE(rec.size() == n);
+          for (size_t i = 0; i < n; ++i) {
+            REQUIRE(rec[i] == Approx(signal[i]).margin(1e-10));
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("errors") {
+    std::vector<double> signal(100, 1.0);
+    auto wavedec_set = wavelet_decomposition(signal, 3, "db2");
+    wavedec_set.first.pop_back();
+    REQUIRE_THROWS_WITH(
+        wavelet_reconstruction(wavedec_set.first, wavedec_set.second, "db2"),
+        "Coefficients do not match the lengths!");
+    REQUIRE_THROWS_WITH(
+        wavelet_reconstruction(wavedec_set.first, wavedec_set.second, "xyz"),
+        "Unknown wavelet name!");
+  }
+}
+
+TEST_CASE("test sample types", "[dwt]") {
+  std::mt19937 gen(19);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("wextend, wconv1 and downsample on float") {
+    std::vector<float> input = {1, 2, 3, 4, 5};
+    std::vector<float> extended = {2, 1, 1, 2, 3, 4, 5, 5, 4};
+    std::vector<float> differences = {1, 1, 1, 1, 1, -5};
+    std::vector<float> odd = {1, 3, 5};
+    REQUIRE(wextend(input, 2, "sym") == extended);
+    REQUIRE(wconv1(input, std::vector<float>(1, 1.0f), "full") == input);
+    REQUIRE(wconv1(input, std::vector<float>({1, -1}), "full") ==
+            differences);
+    REQUIRE(downsample(input, 1, 5) == odd);
+  }
+
+  SECTION("float dwt and wavedec follow double") {
+    for (const char *name : {"haar", "db4", "sym8", "coif3", "bior3.7"}) {
+      std::vector<double> signal(777);
+      for (auto &x : signal) {
+        x = dist(gen);
+      }
+      std::vector<float> samples(signal.begin(), signal.end());
+      // the input rounding dominates, the filters add about as much
+      INFO(name);
+      auto expected = dwt(signal, name, "sym");
+      auto result = dwt(samples, name, "sym");
+      REQUIRE(result.first.size() == expected.first.size());
+      for (size_t k = 0; k < result.first.size(); ++k) {
+        REQUIRE(result.first[k] == Approx(expected.first[k]).margin(1e-5));
+        REQUIRE(result.second[k] == Approx(expected.second[k]).margin(1e-5));
+      }
+
+      auto expectedDec = wavelet_decomposition(signal, 4, name);
+      auto dec = wavelet_decomposition(samples, 4, name);
+      REQUIRE(dec.second == expectedDec.second);
+      REQUIRE(dec.first.size() == expectedDec.first.size());
+      for (size_t k = 0; k < dec.first.size(); ++k) {
+        REQUIRE(dec.first[k] == Approx(expectedDec.first[k]).margin(1e-4));
+      }
+    }
+  }
+
+  SECTION("integer samples are widened") {
+    std::uniform_int_distribution<int> counts(-32768, 32767);
+    std::vector<int16_t> shorts(501);
+    for (auto &x : shorts) {
+      x = static_cast<int16_t>(counts(gen));
+    }
+    std::vector<float> floats(shorts.begin(), shorts.end());
+    std::vector<int32_t> ints(shorts.begin(), shorts.end());
+    std::vector<double> doubles(shorts.begin(), shorts.end());
+
+    auto fromShorts = wavelet_decomposition(shorts, 3, "db6");
+    static_assert(std::is_same<decltype(fromShorts.first),
+                               std::vector<float>>::value,
+                  "int16_t samples are computed in float");
+    REQUIRE(fromShorts == wavelet_decomposition(floats, 3, "db6"));
+
+    auto fromInts = wavelet_decomposition(ints, 3, "db6");
+    static_assert(std::is_same<decltype(fromInts.first),
+                               std::vector<double>>::value,
+                  "int32_t samples are computed in double");
+    REQUIRE(fromInts == wavelet_decomposition(doubles, 3, "db6"));
+
+    std::vector<float> cA(dwt_output_size(shorts.size(), wavelet("db6")));
+    std::vector<float> cD(cA.size());
+    dwt(shorts.data(), shorts.size(), wavelet("db6"), "sym", cA.data(),
+        cD.data());
+    auto expected = dwt(floats, "db6", "sym");
+    REQUIRE(cA == expected.first);
+    REQUIRE(cD == expected.second);
+  }
+
+  SECTION("lifting needs double") {
+    std::vector<float> samples(64, 1.0f);
+    REQUIRE_THROWS_WITH(dwt(samples, "db2", "sym", DwtStrategy::Lifting),
+                        "Lifting needs double precision!");
+    std::vector<int32_t> ints(64, 1);
+    auto lifted = dwt(ints, "db2", "sym", DwtStrategy::Lifting);
+    auto expected = dwt(std::vector<double>(64, 1.0), "db2", "sym");
+    for (size_t k = 0; k < lifted.first.size(); ++k) {
+      REQUIRE(lifted.first[k] == Approx(expected.first[k]).margin(1e-12));
+    }
+  }
+}
+
+TEST_CASE("test dwt_batch func", "[dwt]") {
+  std::mt19937 gen(23);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches dwt per channel") {
+    for (const char *name : {"haar", "db3", "sym9", "bior6.8"}) {
+      for (size_t channels : {1, 3, 16, 21}) {
+        const size_t n = 75;
+        // channel c of the planar block, sample i
+        std::vector<double> planar(channels * n), interleaved(channels * n);
+        for (size_t c = 0; c < channels; ++c) {
+          for (size_t i = 0; i < n; ++i) {
+            planar[c * n + i] = dist(gen);
+            interleaved[i * channels + c] = planar[c * n + i];
+          }
+        }
+        INFO(name << " channels = " << channels);
+        auto fromPlanar =
+            dwt_batch(planar, channels, ChannelLayout::Planar, name, "sym");
+        auto fromInterleaved = dwt_batch(interleaved, channels,
+                                         ChannelLayout::Interleaved, name,
+                                         "sym");
+        for (size_t c = 0; c < channels; ++c) {
+          std::vector<double> signal(planar.begin() + c * n,
+                                     planar.begin() + (c + 1) * n);
+          auto expected = dwt(signal, name, "sym");
+          const size_t outputSize = expected.first.size();
+          REQUIRE(fromPlanar.first.size() == outputSize * channels);
+          for (size_t k = 0; k < outputSize; ++k) {
+            REQUIRE(fromPlanar.first[c * outputSize + k] ==
+                    Approx(expected.first[k]).margin(1e-12));
+            REQUIRE(fromPlanar.second[c * outputSize + k] ==
+                    Approx(expected.second[k]).margin(1e-12));
+            REQUIRE(fromInterleaved.first[k * channels + c] ==
+                    Approx(expected.first[k]).margin(1e-12));
+            REQUIRE(fromInterleaved.second[k * channels + c] ==
+                    Approx(expected.second[k]).margin(1e-12));
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("errors") {
+    std::vector<double> signals(30);
+    REQUIRE_THROWS_WITH(
+        dwt_batch(signals, 4, ChannelLayout::Planar, "db2", "sym"),
+        "Batch size is not a multiple of the channels!");
+    REQUIRE_THROWS_WITH(
+        dwt_batch(signals, 0, ChannelLayout::Planar, "db2", "sym"),
+        "Batch size is not a multiple of the channels!");
+    REQUIRE_THROWS_WITH(
+        dwt_batch(signals, 3, ChannelLayout::Interleaved, "db2", "zpd"),
+        "Mode error!");
+    REQUIRE_THROWS_WITH(
+        dwt_batch(signals, 10, ChannelLayout::Planar, "db4", "sym"),
+        "input size is less than extendLen!");
+  }
+}
+
+TEST_CASE("test wavelet_decomposition_batch func", "[dwt]") {
+  std::mt19937 gen(29);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches wavelet_decomposition per signal") {
+    // ragged lengths, odd and even
+    const std::vector<size_t> sizes = {300, 17, 1024, 64, 65, 513, 40, 999};
+    std::vector<size_t> offsets(1, 0);
+    std::vector<double> signals;
+    for (size_t n : sizes) {
+      for (size_t i = 0; i < n; ++i) {
+        signals.push_back(dist(gen));
+      }
+      offsets.push_back(signals.size());
+    }
+    for (size_t threads : {1, 2, 5}) {
+      ThreadPool pool(threads);
+      for (DwtStrategy strategy :
+           {DwtStrategy::FilterBank, DwtStrategy::Lifting}) {
+        INFO("threads = " << threads);
+        auto batch = wavelet_decomposition_batch(signals, offsets, 2, "db3",
+                                                 pool, strategy);
+        REQUIRE(batch.second.size() == sizes.size() + 1);
+        REQUIRE(batch.second.back() == batch.first.size());
+        for (size_t s = 0; s < sizes.size(); ++s) {
+          std::vector<double> signal(signals.begin() + offsets[s],
+                                     signals.begin() + offsets[s + 1]);
+          auto expected = wavelet_decomposition(signal, 2, "db3", strategy);
+          REQUIRE(batch.second[s + 1] - batch.second[s] ==
+                  expected.first.size());
+          for (size_t k = 0; k < expected.first.size(); ++k) {
+            REQUIRE(batch.first[batch.second[s] + k] == expected.first[k]);
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("default pool and empty batch") {
+    std::vector<double> signals(200);
+    for (double &x : signals) {
+      x = dist(gen);
+    }
+    std::vector<size_t> offsets = {0, 50, 50 + 70, 200};
+    auto batch = wavelet_decomposition_batch(signals, offsets, 3, "sym4");
+    std::vector<double> last(signals.begin() + 120, signals.end());
+    auto expected = wavelet_decomposition(last, 3, "sym4");
+    for (size_t k = 0; k < expected.first.size(); ++k) {
+      REQUIRE(batch.first[batch.second[2] + k] == expected.first[k]);
+    }
+
+    std::vector<double> none;
+    std::vector<size_t> start(1, 0);
+    auto empty = wavelet_decomposition_batch(none, start, 3, "sym4");
+    REQUIRE(empty.first.empty());
+    REQUIRE(empty.second == start);
+  }
+
+  SECTION("errors") {
+    std::vector<double> signals(100);
+    std::vector<size_t> shortEnd = {0, 50, 90};
+    std::vector<size_t> late = {10, 100};
+    std::vector<size_t> unsorted = {0, 60, 40, 100};
+    std::vector<size_t> none;
+    for (const std::vector<size_t> *offsets :
+         {&shortEnd, &late, &unsorted, &none}) {
+      REQUIRE_THROWS_WITH(
+          wavelet_decomposition_batch(signals, *offsets, 2, "db2"),
+          "Batch offsets do not match the signals!");
+    }
+    std::vector<size_t> tiny = {0, 97, 100};
+    REQUIRE_THROWS_WITH(wavelet_decomposition_batch(signals, tiny, 1, "db4"),
+                        "input size is less than extendLen!");
+  }
+}
+
+TEST_CASE("test parallel wavelet_decomposition", "[dwt]") {
+  std::mt19937 gen(31);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  // long enough for the first two levels to be split into several chunks,
+  // with a partial chunk at the end
+  std::vector<double> signal(300001);
+  for (double &x : signal) {
+    x = dist(gen);
+  }
+
+  SECTION("bit-identical to the serial path") {
+    for (size_t threads : {2, 3}) {
+      ThreadPool pool(threads);
+      for (const char *name : {"haar", "db4", "sym9", "coif5", "bior6.8"}) {
+        INFO(name << " threads = " << threads);
+        auto serial = wavelet_decomposition(signal, 4, name);
+        auto parallel = wavelet_decomposition(signal, 4, name, pool);
+        REQUIRE(parallel.second == serial.second);
+        REQUIRE(parallel.first == serial.first);
+      }
+    }
+  }
+
+  SECTION("float, integer and lifting") {
+    ThreadPool pool(4);
+    std::vector<float> floats(signal.begin(), signal.end());
+    REQUIRE(wavelet_decomposition(floats, 3, "db6", pool).first ==
+            wavelet_decomposition(floats, 3, "db6").first);
+
+    std::vector<int16_t> samples(signal.size());
+    for (size_t i = 0; i < signal.size(); ++i) {
+      samples[i] = static_cast<int16_t>(signal[i] * 1000);
+    }
+    REQUIRE(wavelet_decomposition(samples, 3, "sym4", pool).first ==
+            wavelet_decomposition(samples, 3, "sym4").first);
+
+    REQUIRE(wavelet_decomposition(signal, 3, "db3", pool,
+                                  DwtStrategy::Lifting)
+                .first ==
+            wavelet_decomposition(signal, 3, "db3", DwtStrategy::Lifting)
+                .first);
+  }
+
+  SECTION("buffer overload") {
+    ThreadPool pool(2);
+    const Wavelet &w = wavelet("db8");
+    std::vector<double> coeffs(wavedec_output_size(signal.size(), 2, w));
+    wavelet_decomposition(signal.data(), signal.size(), 2, w, coeffs.data(),
+                          pool);
+    REQUIRE(coeffs == wavelet_decomposition(signal, 2, "db8").first);
+  }
+}
@@ -0,0 +1,152 @@
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../dwt.h"
+#include "../dwt2.h"
+#include <catch.hpp>
+#include "test_helpers.h"
+
+// dwt() of every row and then of every column, the direct definition of the
+// 2-D transform
+static Subbands2 reference_dwt2(const std::vector<double> &image, size_t rows,
+                                size_t cols, const std::string &name) {
+  std::vector<std::vector<double>> low(rows), high(rows);
+  for (size_t r = 0; r < rows; ++r) {
+    std::vector<double> row(image.begin() + r * cols,
+                            image.begin() + (r + 1) * cols);
+    std::tie(low[r], high[r]) = dwt(row, name, "sym");
+  }
+  Subbands2 out;
+  out.cols = low[0].size();
+  for (size_t c = 0; c < out.cols; ++c) {
+    std::vector<double> lowColumn(rows), highColumn(rows);
+    for (size_t r = 0; r < rows; ++r) {
+      lowColumn[r] = low[r][c];
+      highColumn[r] = high[r][c];
+    }
+    auto fromLow = dwt(lowColumn, name, "sym");
+    auto fromHigh = dwt(highColumn, name, "sym");
+    out.rows = fromLow.first.size();
+    out.LL.resize(out.rows * out.cols);
+    out.LH.resize(out.LL.size());
+    out.HL.resize(out.LL.size());
+    out.HH.resize(out.LL.size());
+    for (size_t r = 0; r < out.rows; ++r) {
+      out.LL[r * out.cols + c] = fromLow.first[r];
+      out.LH[r * out.cols + c] = fromLow.second[r];
+      out.HL[r * out.cols + c] = fromHigh.first[r];
+      out.HH[r * out.cols + c] = fromHigh.second[r];
+    }
+  }
+  return out;
+}
+
+TEST_CASE("test dwt2 func", "[dwt2]") {
+  std::mt19937 gen(47);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches dwt along rows and columns") {
+    const std::vector<std::pair<size_t, size_t>> shapes = {
+        {40, 41}, {64, 700}, {33, 1500}};
+    for (const char *name : {"haar", "db4", "sym7", "coif3", "bior3.5"}) {
+      for (const auto &shape : shapes) {
+        const size_t rows = shape.first;
+        const size_t cols = shape.second;
+        std::vector<double> image(rows * cols);
+        for (double &x : image) {
+          x = dist(gen);
+        }
+        INFO(name << " " << rows << " x " << cols);
+        Subbands2 out = dwt2(image, rows, cols, name, "sym");
+        Subbands2 expected = reference_dwt2(image, rows, cols, name);
+        REQUIRE(out.rows == expected.rows);
+        REQUIRE(out.cols == expected.cols);
+        require_close(out.LL, expected.LL);
+        require_close(out.LH, expected.LH);
+        require_close(out.HL, expected.HL);
+        require_close(out.HH, expected.HH);
+      }
+    }
+  }
+
+  SECTION("spans several column strips") {
+    // 10003 output columns, three strips of at most 4096 for db4
+    const size_t rows = 10;
+    const size_t cols = 19999;
+    std::vector<double> image(rows * cols);
+    for (double &x : image) {
+      x = dist(gen);
+    }
+    Subbands2 out = dwt2(image, rows, cols, "db4", "sym");
+    Subbands2 expected = reference_dwt2(image, rows, cols, "db4");
+    REQUIRE(out.cols == expected.cols);
+    require_close(out.LL, expected.LL);
+    require_close(out.LH, expected.LH);
+    require_close(out.HL, expected.HL);
+    require_close(out.HH, expected.HH);
+  }
+
+  SECTION("errors") {
+    std::vector<double> image(100);
+    REQUIRE_THROWS_WITH(dwt2(image, 10, 11, "db2", "sym"),
+                        "Image size does not match rows and cols!");
+    REQUIRE_THROWS_WITH(dwt2(image, 10, 10, "db2", "zpd"), "Mode error!");
+    REQUIRE_THROWS_WITH(dwt2(image, 50, 2, "db2", "sym"),
+                        "input size is less than extendLen!");
+  }
+}
+
+TEST_CASE("test wavedec2 func", "[dwt2]") {
+  std::mt19937 gen(53);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("repeats dwt2 on LL") {
+    const size_t rows = 90;
+    const size_t cols = 131;
+    std::vector<double> image(rows * cols);
+    for (double &x : image) {
+      x = dist(gen);
+    }
+    for (size_t level : {0, 1, 3}) {
+      auto result = wavedec2(image, rows, cols, level, "db3");
+      const Wavelet &w = wavelet("db3");
+      REQUIRE(result.first.size() ==
+              wavedec2_output_size(rows, cols, level, w));
+      REQUIRE(result.second.size() == 2 * level);
+
+      // the details from level 1 are at the end
+      std::vector<double> LL = image;
+      size_t r = rows;
+      size_t c = cols;
+      size_t offset = result.first.size();
+      for (size_t i = 0; i < level; ++i) {
+        Subbands2 out = dwt2(LL, r, c, "db3", "sym");
+        REQUIRE(result.second[2 * i] == out.rows);
+        REQUIRE(result.second[2 * i + 1] == out.cols);
+        const size_t size = out.rows * out.cols;
+        offset -= 3 * size;
+        const double *details = result.first.data() + offset;
+        REQUIRE(std::vector<double>(details, details + size) == out.LH);
+        REQUIRE(std::vector<double>(details + size, details + 2 * size) ==
+                out.HL);
+        REQUIRE(std::vector<double>(details + 2 * size,
+                                    details + 3 * size) == out.HH);
+        LL = out.LL;
+        r = out.rows;
+        c = out.cols;
+      }
+      REQUIRE(offset == LL.size());
+      REQUIRE(std::vector<double>(result.first.begin(),
+                                  result.first.begin() + offset) == LL);
+    }
+  }
+
+  SECTION("errors") {
+    std::vector<double> image(64);
+    REQUIRE_THROWS_WITH(wavedec2(image, 8, 7, 1, "haar"),
+                        "Image size does not match rows and cols!");
+    REQUIRE_THROWS_WITH(wavedec2(image, 8, 8, 1, "db5"),
+                        "input size is less than extendLen!");
+  }
+}
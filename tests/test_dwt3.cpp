@@ -0,0 +1,177 @@
+#include <array>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../dwt.h"
+#include "../dwt3.h"
+#include "../threadpool.h"
+#include <catch.hpp>
+#include "test_helpers.h"
+
+// dwt() of every line of a volume along one axis, giving the low and high
+// halves with that extent replaced by the output size
+static std::pair<std::vector<double>, std::vector<double>>
+dwt_axis(const std::vector<double> &volume, std::array<size_t, 3> &shape,
+         size_t axis, const std::string &name) {
+  const size_t strides[3] = {shape[1] * shape[2], shape[2], 1};
+  std::array<size_t, 3> outShape = shape;
+  outShape[axis] = dwt_output_size(shape[axis], wavelet(name));
+  const size_t outStrides[3] = {outShape[1] * outShape[2], outShape[2], 1};
+  std::vector<double> low(outShape[0] * outShape[1] * outShape[2]);
+  std::vector<double> high(low.size());
+  for (size_t i = 0; i < volume.size(); ++i) {
+    // start of a line: index 0 along the axis
+    if (i / strides[axis] % shape[axis] != 0) {
+      continue;
+    }
+    std::vector<double> line(shape[axis]);
+    for (size_t j = 0; j < line.size(); ++j) {
+      line[j] = volume[i + j * strides[axis]];
+    }
+    auto out = dwt(line, name, "sym");
+    size_t o = 0;
+    size_t rest = i;
+    for (size_t a = 0; a < 3; ++a) {
+      o += rest / strides[a] * outStrides[a];
+      rest %= strides[a];
+    }
+    for (size_t k = 0; k < out.first.size(); ++k) {
+      low[o + k * outStrides[axis]] = out.first[k];
+      high[o + k * outStrides[axis]] = out.second[k];
+    }
+  }
+  shape = outShape;
+  return std::make_pair(std::move(low), std::move(high));
+}
+
+// dwt() along each axis in turn, the direct definition of the 3-D transform,
+// with the subbands in the order of dwt3()
+static std::vector<double> reference_dwt3(const std::vector<double> &volume,
+                                          size_t n0, size_t n1, size_t n2,
+                                          const std::string &name) {
+  std::vector<std::vector<double>> bands = {volume};
+  std::array<size_t, 3> shape = {n0, n1, n2};
+  for (size_t axis = 0; axis < 3; ++axis) {
+    std::vector<std::vector<double>> next;
+    std::array<size_t, 3> outShape = shape;
+    for (const auto &band : bands) {
+      outShape = shape;
+      auto out = dwt_axis(band, outShape, axis, name);
+      next.push_back(std::move(out.first));
+      next.push_back(std::move(out.second));
+    }
+    bands = std::move(next);
+    shape = outShape;
+  }
+  std::vector<double> coeffs;
+  for (const auto &band : bands) {
+    coeffs.insert(coeffs.end(), band.begin(), band.end());
+  }
+  return coeffs;
+}
+
+TEST_CASE("test dwt3 func", "[dwt3]") {
+  std::mt19937 gen(59);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches dwt along every axis") {
+    // enough planes for several passes, and planes for several tiles
+    const std::vector<std::array<size_t, 3>> shapes = {
+        {7, 9, 8}, {45, 12, 17}, {19, 60, 100}};
+    ThreadPool pool(3);
+    for (const char *name : {"haar", "db4", "sym7", "bior3.5"}) {
+      const Wavelet &w = wavelet(name);
+      for (const auto &shape : shapes) {
+        if (shape[0] < w.filterSize - 1 || shape[1] < w.filterSize - 1 ||
+            shape[2] < w.filterSize - 1) {
+          continue;
+        }
+        std::vector<double> volume(shape[0] * shape[1] * shape[2]);
+        for (double &x : volume) {
+          x = dist(gen);
+        }
+        INFO(name << " " << shape[0] << " x " << shape[1] << " x "
+                  << shape[2]);
+        std::vector<double> expected =
+            reference_dwt3(volume, shape[0], shape[1], shape[2], name);
+        std::vector<double> coeffs =
+            dwt3(volume, shape[0], shape[1], shape[2], name, "sym");
+        REQUIRE(coeffs.size() ==
+                8 * dwt3_output_size(shape[0], shape[1], shape[2], w));
+        require_close(coeffs, expected);
+
+        // the same on any number of threads
+        std::vector<double> threaded(coeffs.size());
+        dwt3(volume.data(), shape[0], shape[1], shape[2], w, "sym",
+             threaded.data(), pool);
+        REQUIRE(threaded == coeffs);
+      }
+    }
+  }
+
+  SECTION("errors") {
+    std::vector<double> volume(64);
+    REQUIRE_THROWS_WITH(dwt3(volume, 4, 4, 5, "db2", "sym"),
+                        "Volume size does not match n0, n1 and n2!");
+    REQUIRE_THROWS_WITH(dwt3(volume, 4, 4, 4, "db2", "zpd"), "Mode error!");
+    REQUIRE_THROWS_WITH(dwt3(volume, 16, 2, 2, "db2", "sym"),
+                        "input size is less than extendLen!");
+  }
+}
+
+TEST_CASE("test wavedec3 func", "[dwt3]") {
+  std::mt19937 gen(61);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("repeats dwt3 on aaa") {
+    const size_t n0 = 30;
+    const size_t n1 = 21;
+    const size_t n2 = 26;
+    std::vector<double> volume(n0 * n1 * n2);
+    for (double &x : volume) {
+      x = dist(gen);
+    }
+    const Wavelet &w = wavelet("db2");
+    for (size_t level : {0, 1, 3}) {
+      auto result = wavedec3(volume, n0, n1, n2, level, "db2");
+      REQUIRE(result.first.size() ==
+              wavedec3_output_size(n0, n1, n2, level, w));
+      REQUIRE(result.second.size() == 3 * level);
+
+      // the details from level 1 are at the end
+      std::vector<double> aaa = volume;
+      size_t m0 = n0;
+      size_t m1 = n1;
+      size_t m2 = n2;
+      size_t offset = result.first.size();
+      for (size_t i = 0; i < level; ++i) {
+        std::vector<double> out = dwt3(aaa, m0, m1, m2, "db2", "sym");
+        m0 = dwt_output_size(m0, w);
+        m1 = dwt_output_size(m1, w);
+        m2 = dwt_output_size(m2, w);
+        REQUIRE(result.second[3 * i] == m0);
+        REQUIRE(result.second[3 * i + 1] == m1);
+        REQUIRE(result.second[3 * i + 2] == m2);
+        const size_t size = m0 * m1 * m2;
+        offset -= 7 * size;
+        REQUIRE(std::vector<double>(result.first.begin() + offset,
+                                    result.first.begin() + offset +
+                                        7 * size) ==
+                std::vector<double>(out.begin() + size, out.end()));
+        aaa.assign(out.begin(), out.begin() + size);
+      }
+      REQUIRE(offset == aaa.size());
+      REQUIRE(std::vector<double>(result.first.begin(),
+                                  result.first.begin() + offset) == aaa);
+    }
+  }
+
+  SECTION("errors") {
+    std::vector<double> volume(64);
+    REQUIRE_THROWS_WITH(wavedec3(volume, 4, 4, 3, 1, "haar"),
+                        "Volume size does not match n0, n1 and n2!");
+    REQUIRE_THROWS_WITH(wavedec3(volume, 4, 4, 4, 1, "db5"),
+                        "input size is less than extendLen!");
+  }
+}
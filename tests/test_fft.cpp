@@ -0,0 +1,102 @@
+#include <complex>
+#include <vector>
+#include "../fft.h"
+#include "../kernels.h"
+#include <catch.hpp>
+#include <math.h>
+#include <random>
+
+static std::vector<std::complex<double>>
+naive_dft(const std::vector<std::complex<double>> &input, double sign) {
+  const size_t n = input.size();
+  std::vector<std::complex<double>> output(n);
+  for (size_t k = 0; k < n; ++k) {
+    std::complex<double> acc = 0.0;
+    for (size_t j = 0; j < n; ++j) {
+      const double angle = sign * 2.0 * M_PI * double((j * k) % n) / n;
+      acc += input[j] * std::complex<double>(cos(angle), sin(angle));
+    }
+    output[k] = acc;
+  }
+  return output;
+}
+
+TEST_CASE("test FftPlan", "[fft]") {
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  std::vector<size_t> sizes;
+  for (size_t n = 1; n <= 64; ++n) {
+    sizes.push_back(n);
+  }
+  for (size_t n : {97, 120, 125, 1000, 1024}) {
+    sizes.push_back(n);
+  }
+
+  for (size_t n : sizes) {
+    INFO("size : " << n);
+    std::vector<std::complex<double>> input(n);
+    for (auto &x : input) {
+      x = std::complex<double>(dist(gen), dist(gen));
+    }
+    FftPlan plan(n);
+    REQUIRE(plan.size() == n);
+
+    SECTION("forward against naive dft") {
+      std::vector<std::complex<double>> output(n);
+      plan.forward(input.data(), output.data());
+      const auto expected = naive_dft(input, -1.0);
+      for (size_t k = 0; k < n; ++k) {
+        REQUIRE(output[k].real() == Approx(expected[k].real()).margin(1e-9));
+        REQUIRE(output[k].imag() == Approx(expected[k].imag()).margin(1e-9));
+      }
+    }
+
+    SECTION("inverse round trip") {
+      std::vector<std::complex<double>> spectrum(n), output(n);
+      plan.forward(input.data(), spectrum.data());
+      plan.inverse(spectrum.data(), output.data());
+      for (size_t k = 0; k < n; ++k) {
+        REQUIRE(output[k].real() == Approx(input[k].real()).margin(1e-12));
+        REQUIRE(output[k].imag() == Approx(input[k].imag()).margin(1e-12));
+      }
+    }
+  }
+
+  SECTION("size zero") {
+    REQUIRE_THROWS_AS(FftPlan(0), const std::runtime_error &);
+  }
+}
+
+TEST_CASE("test next_fast_fft_size", "[fft]") {
+  REQUIRE(next_fast_fft_size(1) == 1);
+  REQUIRE(next_fast_fft_size(7) == 8);
+  REQUIRE(next_fast_fft_size(11) == 12);
+  REQUIRE(next_fast_fft_size(97) == 100);
+  REQUIRE(next_fast_fft_size(1000) == 1000);
+  REQUIRE(next_fast_fft_size(1025) == 1080);
+}
+
+TEST_CASE("test fft_conv_full", "[fft]") {
+  std::mt19937 gen(6);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  for (size_t n : {1, 30, 500, 5000}) {
+    for (size_t m : {1, 7, 300, 700}) {
+      INFO("n : " << n << ", m : " << m);
+      std::vector<double> input(n), filter(m);
+      for (auto &x : input) {
+        x = dist(gen);
+      }
+      for (auto &x : filter) {
+        x = dist(gen);
+      }
+      std::vector<double> expected(n + m - 1), output(n + m - 1);
+      conv_full(input.data(), n, filter.data(), m, expected.data());
+      fft_conv_full(input.data(), n, filter.data(), m, output.data());
+      for (size_t i = 0; i < output.size(); ++i) {
+        REQUIRE(output[i] == Approx(expected[i]).margin(1e-10));
+      }
+    }
+  }
+}
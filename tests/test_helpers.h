@@ -0,0 +1,18 @@
+#ifndef test_helpers_h
+#define test_helpers_h
+
+#include <cstddef>
+#include <vector>
+#include <catch.hpp>
+
+// a and b have the same size and agree element by element within margin
+inline void require_close(const std::vector<double> &a,
+                          const std::vector<double> &b,
+                          double margin = 1e-12) {
+  REQUIRE(a.size() == b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    REQUIRE(a[i] == Approx(b[i]).margin(margin));
+  }
+}
+
+#endif /* test_helpers_h */
@@ -0,0 +1,335 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include "../kernels.h"
+#include <catch.hpp>
+#include <random>
+
+TEST_CASE("test kernel dispatch", "[kernels]") {
+  SECTION("active isa is supported") {
+    const KernelTable &table = active_kernels();
+    REQUIRE(kernel_isa_supported(table.isa));
+    REQUIRE(std::string(active_kernel_isa()) == table.name);
+  }
+
+  SECTION("scalar is always available") {
+    REQUIRE(kernel_isa_supported(KernelIsa::Scalar));
+    REQUIRE(kernel_table(KernelIsa::Scalar).isa == KernelIsa::Scalar);
+  }
+
+  SECTION("unsupported isa throws") {
+    for (KernelIsa isa :
+         {KernelIsa::SSE2, KernelIsa::AVX2, KernelIsa::AVX512}) {
+      if (!kernel_isa_supported(isa)) {
+        REQUIRE_THROWS_AS(kernel_table(isa), const std::runtime_error &);
+      }
+    }
+  }
+}
+
+TEST_CASE("test kernel variants", "[kernels]") {
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  const KernelTable &scalar = kernel_table(KernelIsa::Scalar);
+
+  for (KernelIsa isa : {KernelIsa::SSE2, KernelIsa::AVX2, KernelIsa::AVX512}) {
+    if (!kernel_isa_supported(isa)) {
+      continue;
+    }
+    const KernelTable &table = kernel_table(isa);
+    INFO("isa : " << table.name);
+
+    SECTION(std::string("conv_valid ") + table.name) {
+      for (size_t n : {1, 9, 40, 100, 333}) {
+        for (size_t m : {1, 4, 10, 17}) {
+          if (n < m) {
+            continue;
+          }
+          std::vector<double> input(n), filter(m);
+          for (auto &x : input) {
+            x = dist(gen);
+          }
+          for (auto &x : filter) {
+            x = dist(gen);
+          }
+          std::vector<double> expected(n - m + 1), output(n - m + 1);
+          scalar.conv_valid(input.data(), expected.size(), filter.data(), m,
+                            expected.data());
+          table.conv_valid(input.data(), output.size(), filter.data(), m,
+                           output.data());
+          for (size_t i = 0; i < output.size(); ++i) {
+            REQUIRE(output[i] == Approx(expected[i]).margin(1e-12));
+          }
+        }
+      }
+    }
+
+    SECTION(std::string("dwt_analysis ") + table.name) {
+      for (size_t n : {9, 10, 31, 64, 600, 1001}) {
+        for (size_t L : {2, 4, 10, 20}) {
+          if (n < L - 1) {
+            continue;
+          }
+          std::vector<double> signal(n), lo(L), hi(L);
+          for (auto &x : signal) {
+            x = dist(gen);
+          }
+          for (size_t j = 0; j < L; ++j) {
+            lo[j] = dist(gen);
+            hi[j] = dist(gen);
+          }
+          const size_t outputSize = (n + L - 1) / 2;
+          std::vector<double> cA(outputSize), cD(outputSize);
+          std::vector<double> expected_cA(outputSize), expected_cD(outputSize);
+          scalar.dwt_analysis(signal.data(), n, lo.data(), hi.data(), L,
+                              expected_cA.data(), expected_cD.data(), 0,
+                              outputSize);
+          table.dwt_analysis(signal.data(), n, lo.data(), hi.data(), L,
+                             cA.data(), cD.data(), 0, outputSize);
+          for (size_t k = 0; k < outputSize; ++k) {
+            REQUIRE(cA[k] == Approx(expected_cA[k]).margin(1e-12));
+            REQUIRE(cD[k] == Approx(expected_cD[k]).margin(1e-12));
+          }
+
+          // computing the outputs in arbitrary chunks gives the same bits
+          std::vector<double> chunked_cA(outputSize), chunked_cD(outputSize);
+          for (size_t first = 0; first < outputSize; first += 7) {
+            const size_t last =
+                first + 7 < outputSize ? first + 7 : outputSize;
+            table.dwt_analysis(signal.data(), n, lo.data(), hi.data(), L,
+                               chunked_cA.data(), chunked_cD.data(), first,
+                               last);
+          }
+          REQUIRE(chunked_cA == cA);
+          REQUIRE(chunked_cD == cD);
+        }
+      }
+    }
+
+    SECTION(std::string("dwt_analysis_f32 ") + table.name) {
+      for (size_t m : {2, 4, 12, 20, 70}) {
+        for (size_t n : {m, m + 1, size_t(100), size_t(1001)}) {
+          std::vector<float> signal(n), lo(m), hi(m);
+          for (auto &x : signal) {
+            x = static_cast<float>(dist(gen));
+          }
+          for (size_t j = 0; j < m; ++j) {
+            lo[j] = static_cast<float>(dist(gen));
+            hi[j] = static_cast<float>(dist(gen));
+          }
+          const size_t outputSize = (n + m - 1) / 2;
+          std::vector<float> expectedA(outputSize), expectedD(outputSize);
+          std::vector<float> cA(outputSize), cD(outputSize);
+          scalar.dwt_analysis_f32(signal.data(), n, lo.data(), hi.data(), m,
+                                  expectedA.data(), expectedD.data(), 0,
+                                  outputSize);
+          table.dwt_analysis_f32(signal.data(), n, lo.data(), hi.data(), m,
+                                 cA.data(), cD.data(), 0, outputSize);
+          for (size_t k = 0; k < outputSize; ++k) {
+            REQUIRE(cA[k] == Approx(expectedA[k]).margin(1e-4));
+            REQUIRE(cD[k] == Approx(expectedD[k]).margin(1e-4));
+          }
+        }
+      }
+    }
+
+    SECTION(std::string("dwt_analysis_interleaved ") + table.name) {
+      for (size_t channels : {1, 2, 3, 5, 8, 13, 16, 37}) {
+        for (size_t m : {2, 6, 16}) {
+          const size_t n = 3 * m + 1;
+          std::vector<double> signal(n * channels), lo(m), hi(m);
+          for (auto &x : signal) {
+            x = dist(gen);
+          }
+          for (size_t j = 0; j < m; ++j) {
+            lo[j] = dist(gen);
+            hi[j] = dist(gen);
+          }
+          const size_t outputSize = (n + m - 1) / 2;
+          std::vector<double> expectedA(outputSize * channels);
+          std::vector<double> expectedD(expectedA.size());
+          std::vector<double> cA(expectedA.size()), cD(expectedA.size());
+          scalar.dwt_analysis_interleaved(signal.data(), n, channels,
+                                          channels, lo.data(), hi.data(), m,
+                                          expectedA.data(), expectedD.data(),
+                                          0, outputSize);
+          table.dwt_analysis_interleaved(signal.data(), n, channels, channels,
+                                         lo.data(), hi.data(), m, cA.data(),
+                                         cD.data(), 0, outputSize);
+          for (size_t k = 0; k < cA.size(); ++k) {
+            REQUIRE(cA[k] == Approx(expectedA[k]).margin(1e-12));
+            REQUIRE(cD[k] == Approx(expectedD[k]).margin(1e-12));
+          }
+
+          // a strip of the channels, leaving the others alone
+          const size_t c0 = channels / 3;
+          const size_t strip = channels - c0 - channels / 4;
+          std::vector<double> stripA(cA.size(), 7.0), stripD(cA.size(), 7.0);
+          table.dwt_analysis_interleaved(signal.data() + c0, n, strip,
+                                         channels, lo.data(), hi.data(), m,
+                                         stripA.data() + c0,
+                                         stripD.data() + c0, 0, outputSize);
+          for (size_t k = 0; k < outputSize; ++k) {
+            for (size_t c = 0; c < channels; ++c) {
+              const bool inside = c >= c0 && c < c0 + strip;
+              const size_t i = k * channels + c;
+              REQUIRE(stripA[i] == (inside ? cA[i] : 7.0));
+              REQUIRE(stripD[i] == (inside ? cD[i] : 7.0));
+            }
+          }
+        }
+      }
+    }
+
+    SECTION(std::string("lifting_step ") + table.name) {
+      for (size_t n : {1, 3, 8, 17, 64, 1001}) {
+        std::vector<double> source(n), target(n);
+        for (size_t i = 0; i < n; ++i) {
+          source[i] = dist(gen);
+          target[i] = dist(gen);
+        }
+        const double coeff = dist(gen);
+        std::vector<double> expected = target;
+        scalar.lifting_step(expected.data(), source.data(), coeff, n);
+        table.lifting_step(target.data(), source.data(), coeff, n);
+        for (size_t i = 0; i < n; ++i) {
+          REQUIRE(target[i] == Approx(expected[i]).margin(1e-15));
+        }
+      }
+    }
+
+    SECTION(std::string("threshold ") + table.name) {
+      for (ThresholdKind kind : {ThresholdKind::Hard, ThresholdKind::Soft,
+                                 ThresholdKind::Garrote, ThresholdKind::Firm}) {
+        for (size_t n : {1, 3, 8, 17, 64, 1001}) {
+          std::vector<double> x(n);
+          for (size_t i = 0; i < n; ++i) {
+            x[i] = dist(gen);
+          }
+          x[0] = 0.0;
+          std::vector<double> expected = x;
+          scalar.threshold(expected.data(), n, kind, 0.3, 0.7);
+          table.threshold(x.data(), n, kind, 0.3, 0.7);
+          // the same expressions lane by lane, so bit-identical
+          for (size_t i = 0; i < n; ++i) {
+            REQUIRE(x[i] == expected[i]);
+            REQUIRE(std::signbit(x[i]) == std::signbit(expected[i]));
+          }
+        }
+      }
+    }
+
+    SECTION(std::string("threshold special values ") + table.name) {
+      const double nan = std::nan("");
+      const double inf = HUGE_VAL;
+      const std::vector<double> values = {nan, -nan, 0.0, -0.0, 0.3, -0.3,
+                                          0.7, -0.7, inf, -inf, 1e-300,
+                                          -2.0, nan, 0.0, -0.0, 5.0, -nan};
+      for (ThresholdKind kind : {ThresholdKind::Hard, ThresholdKind::Soft,
+                                 ThresholdKind::Garrote, ThresholdKind::Firm}) {
+        std::vector<double> x = values;
+        std::vector<double> expected = values;
+        scalar.threshold(expected.data(), x.size(), kind, 0.3, 0.7);
+        table.threshold(x.data(), x.size(), kind, 0.3, 0.7);
+        for (size_t i = 0; i < x.size(); ++i) {
+          INFO("kind " << int(kind) << " value " << values[i]);
+          REQUIRE(std::isnan(x[i]) == std::isnan(expected[i]));
+          if (!std::isnan(x[i])) {
+            REQUIRE(x[i] == expected[i]);
+            REQUIRE(std::signbit(x[i]) == std::signbit(expected[i]));
+          }
+          // at most the threshold, and NaN, give +0
+          if (!(std::abs(values[i]) > 0.3)) {
+            REQUIRE(x[i] == 0.0);
+            REQUIRE(!std::signbit(x[i]));
+          }
+        }
+      }
+    }
+
+    SECTION(std::string("swt_analysis ") + table.name) {
+      for (size_t m : {2, 4, 10, 18}) {
+        for (size_t step : {1, 2, 8}) {
+          for (size_t n : {1, 7, 33, 100}) {
+            std::vector<double> signal(n + (m - 1) * step), lo(m), hi(m);
+            for (auto &x : signal) {
+              x = dist(gen);
+            }
+            for (size_t j = 0; j < m; ++j) {
+              lo[j] = dist(gen);
+              hi[j] = dist(gen);
+            }
+            std::vector<double> expectedA(n), expectedD(n), cA(n), cD(n);
+            scalar.swt_analysis(signal.data(), n, step, lo.data(), hi.data(),
+                                m, expectedA.data(), expectedD.data());
+            table.swt_analysis(signal.data(), n, step, lo.data(), hi.data(),
+                               m, cA.data(), cD.data());
+            for (size_t i = 0; i < n; ++i) {
+              REQUIRE(cA[i] == Approx(expectedA[i]).margin(1e-12));
+              REQUIRE(cD[i] == Approx(expectedD[i]).margin(1e-12));
+            }
+          }
+        }
+      }
+    }
+
+    SECTION(std::string("swt_synthesis ") + table.name) {
+      for (size_t m : {2, 4, 10, 18}) {
+        for (size_t step : {1, 2, 8}) {
+          for (size_t n : {1, 7, 33, 100}) {
+            const size_t size = n + (m - 1) * step;
+            std::vector<double> cA(size), cD(size), lo(m), hi(m);
+            for (size_t i = 0; i < size; ++i) {
+              cA[i] = dist(gen);
+              cD[i] = dist(gen);
+            }
+            for (size_t j = 0; j < m; ++j) {
+              lo[j] = dist(gen);
+              hi[j] = dist(gen);
+            }
+            std::vector<double> expected(n), output(n);
+            scalar.swt_synthesis(cA.data(), cD.data(), n, step, lo.data(),
+                                 hi.data(), m, expected.data());
+            table.swt_synthesis(cA.data(), cD.data(), n, step, lo.data(),
+                                hi.data(), m, output.data());
+            for (size_t i = 0; i < n; ++i) {
+              REQUIRE(output[i] == Approx(expected[i]).margin(1e-12));
+            }
+          }
+        }
+      }
+    }
+
+    SECTION(std::string("idwt_synthesis ") + table.name) {
+      for (size_t m : {2, 4, 10, 18}) {
+        for (size_t n : {1, 7, 33, 100}) {
+          const size_t coeffsSize = n + m / 2 - 1;
+          std::vector<double> cA(coeffsSize), cD(coeffsSize), lo(m), hi(m);
+          for (size_t i = 0; i < coeffsSize; ++i) {
+            cA[i] = dist(gen);
+            cD[i] = dist(gen);
+          }
+          for (size_t j = 0; j < m; ++j) {
+            lo[j] = dist(gen);
+            hi[j] = dist(gen);
+          }
+          // odd first samples and ragged ends go through the tails
+          for (size_t first : {size_t(0), size_t(1), size_t(5)}) {
+            const size_t last = 2 * n;
+            if (first > last) {
+              continue;
+            }
+            std::vector<double> expected(last), output(last);
+            scalar.idwt_synthesis(cA.data(), cD.data(), lo.data(), hi.data(),
+                                  m, expected.data(), first, last);
+            table.idwt_synthesis(cA.data(), cD.data(), lo.data(), hi.data(),
+                                 m, output.data(), first, last);
+            for (size_t i = first; i < last; ++i) {
+              REQUIRE(output[i] == Approx(expected[i]).margin(1e-12));
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,153 @@
+#include <string>
+#include <vector>
+#include "../dwt.h"
+#include "../kernels.h"
+#include "../lifting.h"
+#include <catch.hpp>
+#include <cmath>
+#include <random>
+
+// Daubechies scaling filters (reconstruction lowpass), the analysis filters
+// follow as Lo_D = wrev(Lo_R) and Ho_D[k] = (-1)^k Lo_R[k]
+static const std::vector<double> kDb2 = {
+    0.48296291314453416, 0.83651630373780794, 0.22414386804201339,
+    -0.12940952255126037};
+
+static const std::vector<double> kDb10 = {
+    0.026670057900555554, 0.1881768000776915, 0.52720118893172563,
+    0.68845903945360354, 0.28117234366057747, -0.24984642432731538,
+    -0.19594627437737705, 0.12736934033579325, 0.093057364603572348,
+    -0.071394147166397082, -0.029457536821875813, 0.033212674059341002,
+    0.0036065535669561697, -0.010733175483330575, 0.0013953517470529011,
+    0.0019924052951850561, -0.00068585669495971162, -0.00011646685512928545,
+    9.3588670320069592e-05, -1.3264202894521244e-05};
+
+static void analysis_filters(const std::vector<double> &Lo_R,
+                             std::vector<double> &Lo_D,
+                             std::vector<double> &Ho_D) {
+  Lo_D.assign(Lo_R.rbegin(), Lo_R.rend());
+  Ho_D.resize(Lo_R.size());
+  for (size_t k = 0; k < Lo_R.size(); ++k) {
+    Ho_D[k] = k % 2 ? -Lo_R[k] : Lo_R[k];
+  }
+}
+
+TEST_CASE("test LiftingScheme", "[lifting]") {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("haar is one predict and one update step") {
+    std::vector<double> Lo_D, Ho_D;
+    analysis_filters({M_SQRT1_2, M_SQRT1_2}, Lo_D, Ho_D);
+    LiftingScheme scheme(Lo_D, Ho_D);
+    REQUIRE(scheme.filter_size() == 2);
+    REQUIRE(scheme.steps().size() == 2);
+  }
+
+  SECTION("matches the filter bank") {
+    for (const std::vector<double> &Lo_R :
+         {std::vector<double>{M_SQRT1_2, M_SQRT1_2}, kDb2, kDb10}) {
+      std::vector<double> Lo_D, Ho_D;
+      analysis_filters(Lo_R, Lo_D, Ho_D);
+      const size_t L = Lo_D.size();
+      LiftingScheme scheme(Lo_D, Ho_D);
+      REQUIRE(scheme.steps().size() == L);
+
+      for (size_t n : {L - 1, L, L + 1, size_t(50), size_t(1001),
+                       size_t(5000)}) {
+        if (n == 0) {
+          continue;
+        }
+        INFO("L : " << L << ", n : " << n);
+        std::vector<double> signal(n);
+        for (auto &x : signal) {
+          x = dist(gen);
+        }
+        const size_t outputSize = (n + L - 1) / 2;
+        std::vector<double> cA(outputSize), cD(outputSize);
+        std::vector<double> expected_cA(outputSize), expected_cD(outputSize);
+        kernel_table(KernelIsa::Scalar)
+            .dwt_analysis(signal.data(), n, Lo_D.data(), Ho_D.data(), L,
+                          expected_cA.data(), expected_cD.data(), 0,
+                          outputSize);
+        scheme.analysis(signal.data(), n, cA.data(), cD.data(), outputSize);
+        for (size_t k = 0; k < outputSize; ++k) {
+          REQUIRE(cA[k] == Approx(expected_cA[k]).margin(1e-12));
+          REQUIRE(cD[k] == Approx(expected_cD[k]).margin(1e-12));
+        }
+      }
+    }
+  }
+
+  SECTION("filters of different or odd length") {
+    REQUIRE_THROWS_AS(LiftingScheme({1.0, 1.0}, {1.0, -1.0, 0.0, 0.0}),
+                      const std::runtime_error &);
+    REQUIRE_THROWS_AS(LiftingScheme({1.0, 1.0, 1.0}, {1.0, -1.0, 1.0}),
+                      const std::runtime_error &);
+  }
+
+  SECTION("filters that are not orthogonal") {
+    REQUIRE_THROWS_AS(LiftingScheme({0.5, 1.0}, {1.0, -0.5}),
+                      const std::runtime_error &);
+  }
+}
+
+TEST_CASE("test dwt lifting strategy", "[lifting]") {
+  std::mt19937 gen(8);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("dwt matches the filter bank") {
+    for (size_t n : {9, 10, 33, 512, 1025, 4096}) {
+      INFO("n : " << n);
+      std::vector<double> signal(n);
+      for (auto &x : signal) {
+        x = dist(gen);
+      }
+      const auto expected = dwt(signal, "db5", "sym");
+      const auto result = dwt(signal, "db5", "sym", DwtStrategy::Lifting);
+      REQUIRE(result.first.size() == expected.first.size());
+      REQUIRE(result.second.size() == expected.second.size());
+      for (size_t k = 0; k < expected.first.size(); ++k) {
+        REQUIRE(result.first[k] == Approx(expected.first[k]).margin(1e-12));
+        REQUIRE(result.second[k] == Approx(expected.second[k]).margin(1e-12));
+      }
+    }
+  }
+
+  SECTION("every orthogonal wavelet of the registry") {
+    std::vector<double> signal(777);
+    for (auto &x : signal) {
+      x = dist(gen);
+    }
+    for (size_t id = 0; id < wavelet_count(); ++id) {
+      const Wavelet &w = wavelet_at(id);
+      INFO("wavelet : " << w.name);
+      if (!w.orthogonal) {
+        REQUIRE_THROWS_AS(dwt(signal, w, "sym", DwtStrategy::Lifting),
+                          const std::runtime_error &);
+        continue;
+      }
+      const auto expected = dwt(signal, w, "sym");
+      const auto result = dwt(signal, w, "sym", DwtStrategy::Lifting);
+      for (size_t k = 0; k < expected.first.size(); ++k) {
+        REQUIRE(result.first[k] == Approx(expected.first[k]).margin(1e-12));
+        REQUIRE(result.second[k] == Approx(expected.second[k]).margin(1e-12));
+      }
+    }
+  }
+
+  SECTION("wavelet_decomposition matches the filter bank") {
+    std::vector<double> signal(3000);
+    for (auto &x : signal) {
+      x = dist(gen);
+    }
+    const auto expected = wavelet_decomposition(signal, 4, "db5");
+    const auto result =
+        wavelet_decomposition(signal, 4, "db5", DwtStrategy::Lifting);
+    REQUIRE(result.second == expected.second);
+    REQUIRE(result.first.size() == expected.first.size());
+    for (size_t k = 0; k < expected.first.size(); ++k) {
+      REQUIRE(result.first[k] == Approx(expected.first[k]).margin(1e-11));
+    }
+  }
+}
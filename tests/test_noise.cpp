@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "../dwt.h"
+#include "../noise.h"
+#include <catch.hpp>
+
+static double sorted_median(std::vector<double> x) {
+  for (double &v : x) {
+    v = std::abs(v);
+  }
+  std::sort(x.begin(), x.end());
+  const size_t n = x.size();
+  return n % 2 == 1 ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2.0;
+}
+
+TEST_CASE("test noise_sigma func", "[noise]") {
+  std::mt19937 gen(97);
+  std::normal_distribution<double> noise(0.0, 0.5);
+
+  SECTION("select is the exact median") {
+    for (size_t n : {1, 2, 7, 100, 1001}) {
+      std::vector<double> cD(n);
+      for (double &x : cD) {
+        x = noise(gen);
+      }
+      const std::vector<double> copy = cD;
+      REQUIRE(noise_sigma(cD) == sorted_median(cD) / 0.6745);
+      // the details are left as they were
+      REQUIRE(cD == copy);
+    }
+  }
+
+  SECTION("histogram is within a bin") {
+    for (size_t n : {1, 2, 50, 10000}) {
+      std::vector<double> cD(n);
+      for (double &x : cD) {
+        x = noise(gen);
+      }
+      // an outlier widens the bins
+      cD[0] = 40.0;
+      const double bin = 40.0 / 4096;
+      REQUIRE(std::abs(noise_sigma(cD, "histogram") * 0.6745 -
+                       sorted_median(cD)) <= bin);
+    }
+    REQUIRE(noise_sigma(std::vector<double>(10), "histogram") == 0.0);
+  }
+
+  SECTION("finds the noise of a noisy signal") {
+    std::vector<double> signal(1 << 14);
+    for (size_t i = 0; i < signal.size(); ++i) {
+      signal[i] = std::sin(0.003 * i) + noise(gen);
+    }
+    auto cD = dwt(signal, "db4", "sym").second;
+    REQUIRE(noise_sigma(cD) == Approx(0.5).epsilon(0.05));
+    REQUIRE(noise_sigma(cD, "histogram") == Approx(0.5).epsilon(0.05));
+  }
+
+  SECTION("errors") {
+    REQUIRE_THROWS_WITH(noise_sigma(std::vector<double>(4), "sort"),
+                        "Noise method error!");
+    REQUIRE_THROWS_WITH(noise_sigma(std::vector<double>()),
+                        "Details are empty!");
+  }
+}
+
+TEST_CASE("test P2Quantile class", "[noise]") {
+  std::mt19937 gen(101);
+
+  SECTION("few samples give the nearest rank") {
+    P2Quantile median;
+    REQUIRE(median.value() == 0.0);
+    for (double x : {5.0, 1.0, 3.0}) {
+      median.push(x);
+    }
+    REQUIRE(median.count() == 3);
+    REQUIRE(median.value() == 3.0);
+  }
+
+  SECTION("tracks quantiles of long sequences") {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (double p : {0.1, 0.5, 0.9}) {
+      P2Quantile quantile(p);
+      for (size_t i = 0; i < 100000; ++i) {
+        quantile.push(uniform(gen));
+      }
+      REQUIRE(quantile.value() == Approx(p).margin(0.01));
+    }
+  }
+
+  SECTION("reset and errors") {
+    P2Quantile median;
+    for (size_t i = 0; i < 10; ++i) {
+      median.push(double(i));
+    }
+    median.reset();
+    REQUIRE(median.count() == 0);
+    median.push(2.0);
+    REQUIRE(median.value() == 2.0);
+    REQUIRE_THROWS_WITH(P2Quantile(1.5), "Quantile must be in [0, 1]!");
+  }
+}
+
+TEST_CASE("test StreamingNoise class", "[noise]") {
+  std::mt19937 gen(103);
+  std::normal_distribution<double> noise(0.0, 2.0);
+
+  std::vector<double> cD(50000);
+  for (double &x : cD) {
+    x = noise(gen);
+  }
+  StreamingNoise whole;
+  whole.push(cD.data(), cD.size());
+  StreamingNoise blocks;
+  for (size_t i = 0; i < cD.size(); i += 333) {
+    blocks.push(cD.data() + i, std::min<size_t>(333, cD.size() - i));
+  }
+  REQUIRE(blocks.count() == cD.size());
+  REQUIRE(blocks.sigma() == whole.sigma());
+  REQUIRE(whole.sigma() == Approx(noise_sigma(cD)).epsilon(0.02));
+  REQUIRE(whole.sigma() == Approx(2.0).epsilon(0.03));
+  whole.reset();
+  REQUIRE(whole.sigma() == 0.0);
+}
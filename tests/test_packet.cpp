@@ -0,0 +1,137 @@
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../dwt.h"
+#include "../packet.h"
+#include "../threadpool.h"
+#include <catch.hpp>
+
+static double shannon(const std::vector<double> &x) {
+  double cost = 0.0;
+  for (double v : x) {
+    if (v != 0.0) {
+      cost -= v * v * std::log(v * v);
+    }
+  }
+  return cost;
+}
+
+// the lowest cost of any basis below node (d, p), by trying them all
+static double lowest_cost(const WaveletPacket &packet, size_t d, size_t p) {
+  if (d == packet.level) {
+    return packet.cost(d, p);
+  }
+  const double children = lowest_cost(packet, d + 1, 2 * p) +
+                          lowest_cost(packet, d + 1, 2 * p + 1);
+  return std::min(packet.cost(d, p), children);
+}
+
+TEST_CASE("test wpdec func", "[packet]") {
+  std::mt19937 gen(71);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("nodes are the dwt of their parents") {
+    std::vector<double> signal(1000);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    for (const char *name : {"haar", "db4", "bior2.2"}) {
+      INFO(name);
+      WaveletPacket packet = wpdec(signal, 4, name);
+      const Wavelet &w = wavelet(name);
+      REQUIRE(packet.coeffs.size() == wpdec_output_size(1000, 4, w));
+      REQUIRE(packet.costs.size() == 31);
+      for (size_t d = 0; d < 4; ++d) {
+        for (size_t p = 0; p < (size_t(1) << d); ++p) {
+          const double *node = packet.node(d, p);
+          std::vector<double> parent(node, node + packet.lengths[d]);
+          auto children = dwt(parent, name, "sym");
+          REQUIRE(children.first.size() == packet.lengths[d + 1]);
+          const double *cA = packet.node(d + 1, 2 * p);
+          const double *cD = packet.node(d + 1, 2 * p + 1);
+          REQUIRE(std::vector<double>(cA, cA + packet.lengths[d + 1]) ==
+                  children.first);
+          REQUIRE(std::vector<double>(cD, cD + packet.lengths[d + 1]) ==
+                  children.second);
+          REQUIRE(packet.cost(d, p) == Approx(shannon(parent)));
+        }
+      }
+    }
+  }
+
+  SECTION("log energy cost") {
+    std::vector<double> signal(300);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    signal[7] = 0.0;
+    WaveletPacket packet = wpdec(signal, 2, "db2", "log energy");
+    double cost = 0.0;
+    for (double v : signal) {
+      if (v != 0.0) {
+        cost += std::log(v * v);
+      }
+    }
+    REQUIRE(packet.cost(0, 0) == Approx(cost));
+  }
+
+  SECTION("thread pool gives the same tree") {
+    // the first depths run in chunks, the rest as subtree tasks
+    std::vector<double> signal(200000);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    ThreadPool pool(3);
+    WaveletPacket serial = wpdec(signal, 6, "sym4");
+    WaveletPacket threaded = wpdec(signal, 6, "sym4", "shannon", pool);
+    REQUIRE(threaded.coeffs == serial.coeffs);
+    REQUIRE(threaded.costs == serial.costs);
+  }
+
+  SECTION("errors") {
+    std::vector<double> signal(16);
+    REQUIRE_THROWS_WITH(wpdec(signal, 2, "db2", "norm"), "Entropy error!");
+    REQUIRE_THROWS_WITH(wpdec(std::vector<double>(5), 1, "db4"),
+                        "input size is less than extendLen!");
+  }
+}
+
+TEST_CASE("test best_basis func", "[packet]") {
+  std::mt19937 gen(73);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("has the lowest cost and tiles the tree") {
+    for (size_t level : {0, 1, 3, 5}) {
+      std::vector<double> signal(512);
+      for (size_t i = 0; i < signal.size(); ++i) {
+        // a chirp and noise, so that the basis mixes depths
+        signal[i] = std::sin(0.0005 * i * i) + 0.2 * dist(gen);
+      }
+      WaveletPacket packet = wpdec(signal, level, "db3");
+      auto basis = best_basis(packet);
+      double cost = 0.0;
+      double width = 0.0;
+      size_t next = 0;
+      for (const auto &node : basis) {
+        cost += packet.cost(node.first, node.second);
+        width += std::ldexp(1.0, -int(node.first));
+        // contiguous from the left, in units of the deepest nodes
+        REQUIRE(node.second << (level - node.first) == next);
+        next += size_t(1) << (level - node.first);
+      }
+      REQUIRE(width == 1.0);
+      REQUIRE(cost == Approx(lowest_cost(packet, 0, 0)));
+    }
+  }
+
+  SECTION("keeps the signal when it is already sparse") {
+    std::vector<double> signal(256);
+    signal[100] = 1.0;
+    WaveletPacket packet = wpdec(signal, 3, "db2");
+    auto basis = best_basis(packet);
+    REQUIRE(basis.size() == 1);
+    REQUIRE(basis[0] == std::make_pair(size_t(0), size_t(0)));
+  }
+}
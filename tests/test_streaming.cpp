@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../dwt.h"
+#include "../streaming.h"
+#include <catch.hpp>
+
+// pushes signal in blocks of blockSize and flushes, collecting everything
+// the stream emits
+static std::pair<std::vector<double>, std::vector<double>>
+stream_dwt(StreamingDwt &stream, const std::vector<double> &signal,
+           size_t blockSize) {
+  std::vector<double> cA, cD;
+  for (size_t i = 0; i < signal.size(); i += blockSize) {
+    std::vector<double> block(
+        signal.begin() + i,
+        signal.begin() + std::min(i + blockSize, signal.size()));
+    const size_t expected = stream.push_output_size(block.size());
+    auto out = stream.push(block);
+    REQUIRE(out.first.size() == expected);
+    cA.insert(cA.end(), out.first.begin(), out.first.end());
+    cD.insert(cD.end(), out.second.begin(), out.second.end());
+  }
+  const size_t expected = stream.flush_output_size();
+  auto out = stream.flush();
+  REQUIRE(out.first.size() == expected);
+  cA.insert(cA.end(), out.first.begin(), out.first.end());
+  cD.insert(cD.end(), out.second.begin(), out.second.end());
+  return std::make_pair(cA, cD);
+}
+
+TEST_CASE("test StreamingDwt", "[streaming]") {
+  std::mt19937 gen(37);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches dwt for any block size") {
+    for (const char *name : {"haar", "db2", "db7", "sym10", "coif5",
+                             "bior3.9", "db20"}) {
+      StreamingDwt stream(name);
+      const size_t L = wavelet(name).filterSize;
+      for (size_t n : {L - 1, L, L + 1, size_t(100), size_t(2501)}) {
+        std::vector<double> signal(n);
+        for (double &x : signal) {
+          x = dist(gen);
+        }
+        auto expected = dwt(signal, name, "sym");
+        for (size_t blockSize : {1, 2, 3, 7, 64, 1000, 3000}) {
+          INFO(name << " n = " << n << " block = " << blockSize);
+          auto streamed = stream_dwt(stream, signal, blockSize);
+          REQUIRE(streamed.first == expected.first);
+          REQUIRE(streamed.second == expected.second);
+        }
+      }
+    }
+  }
+
+  SECTION("emits coefficients as soon as they are determined") {
+    StreamingDwt stream("db4");
+    std::vector<double> cA(8), cD(8);
+    std::vector<double> signal(20, 1.0);
+    // nothing until the 7 samples of the reflection at the start are in
+    REQUIRE(stream.push(signal.data(), 6, cA.data(), cD.data()) == 0);
+    REQUIRE(stream.push(signal.data(), 1, cA.data(), cD.data()) == 3);
+    REQUIRE(stream.push(signal.data(), 1, cA.data(), cD.data()) == 1);
+    REQUIRE(stream.push(signal.data(), 1, cA.data(), cD.data()) == 0);
+    REQUIRE(stream.samples() == 9);
+    // 9 samples give 8 coefficients, 4 of them emitted
+    REQUIRE(stream.flush_output_size() == 4);
+    REQUIRE(stream.flush(cA.data(), cD.data()) == 4);
+    REQUIRE(stream.samples() == 0);
+  }
+
+  SECTION("reset drops the signal") {
+    StreamingDwt stream("sym4");
+    std::vector<double> signal(50);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    stream.push(std::vector<double>(30, 5.0));
+    stream.reset();
+    auto streamed = stream_dwt(stream, signal, 9);
+    REQUIRE(streamed.first == dwt(signal, "sym4", "sym").first);
+  }
+
+  SECTION("errors") {
+    REQUIRE_THROWS_WITH(StreamingDwt("db2", "zpd"), "Mode error!");
+    StreamingDwt stream("db4");
+    REQUIRE_THROWS_WITH(stream.flush(), "input or wfilters is empty!");
+    stream.push(std::vector<double>(6, 1.0));
+    REQUIRE_THROWS_WITH(stream.flush(), "input size is less than extendLen!");
+    // the samples are kept, so the signal can go on
+    stream.push(std::vector<double>(1, 1.0));
+    REQUIRE(stream.flush().first.size() == 4);
+  }
+}
+
+TEST_CASE("test StreamingDecomposition", "[streaming]") {
+  std::mt19937 gen(41);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches wavelet_decomposition for any block size") {
+    for (const char *name : {"haar", "db3", "sym8", "coif4", "bior2.6"}) {
+      for (size_t level : {0, 1, 3, 6}) {
+        StreamingDecomposition stream(level, name);
+        REQUIRE(stream.level() == level);
+        for (size_t n : {size_t(700), size_t(4099)}) {
+          std::vector<double> signal(n);
+          for (double &x : signal) {
+            x = dist(gen);
+          }
+          auto expected = wavelet_decomposition(signal, level, name);
+          for (size_t blockSize : {1, 5, 512, 3000}) {
+            INFO(name << " level = " << level << " n = " << n
+                      << " block = " << blockSize);
+            // the coefficients of every call, reusing one output
+            std::vector<std::vector<double>> cD(level);
+            std::vector<double> cA;
+            StreamingCoefficients out;
+            for (size_t i = 0; i < n; i += blockSize) {
+              stream.push(signal.data() + i, std::min(blockSize, n - i), out);
+              REQUIRE(out.cD.size() == level);
+              for (size_t j = 0; j < level; ++j) {
+                cD[j].insert(cD[j].end(), out.cD[j].begin(), out.cD[j].end());
+              }
+              cA.insert(cA.end(), out.cA.begin(), out.cA.end());
+            }
+            REQUIRE(stream.samples() == n);
+            stream.flush(out);
+            REQUIRE(stream.samples() == 0);
+            for (size_t j = 0; j < level; ++j) {
+              cD[j].insert(cD[j].end(), out.cD[j].begin(), out.cD[j].end());
+            }
+            cA.insert(cA.end(), out.cA.begin(), out.cA.end());
+
+            // cA_level, cD_level .. cD_1
+            std::vector<double> coeffs = cA;
+            for (size_t j = level; j-- > 0;) {
+              REQUIRE(cD[j].size() == size_t(expected.second[j]));
+              coeffs.insert(coeffs.end(), cD[j].begin(), cD[j].end());
+            }
+            REQUIRE(coeffs == expected.first);
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("details come out while the signal runs") {
+    StreamingDecomposition stream(6, "db2");
+    std::vector<double> block(4096, 1.0);
+    stream.push(block);
+    auto out = stream.push(block);
+    // level j emits one detail per 2^j samples
+    for (size_t j = 0; j < 6; ++j) {
+      REQUIRE(out.cD[j].size() == (4096 >> (j + 1)));
+    }
+    REQUIRE(out.cA.size() == 4096 / 64);
+  }
+
+  SECTION("errors") {
+    REQUIRE_THROWS_WITH(StreamingDecomposition(2, "db2", "per"),
+                        "Mode error!");
+    StreamingDecomposition stream(3, "db4");
+    stream.push(std::vector<double>(6, 1.0));
+    REQUIRE_THROWS_WITH(stream.flush(), "input size is less than extendLen!");
+    // the samples are kept, so the signal can go on
+    REQUIRE(stream.samples() == 6);
+    stream.push(std::vector<double>(1, 1.0));
+    auto out = stream.flush();
+    REQUIRE(out.cA.size() == 7);
+  }
+}
+
+TEST_CASE("test SampleDwt", "[streaming]") {
+  std::mt19937 gen(43);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("levels are the dwt of the stream above them") {
+    for (const char *name : {"haar", "db4", "sym6", "bior4.4"}) {
+      const size_t L = wavelet(name).filterSize;
+      SampleDwt stream(3, name);
+      REQUIRE(stream.level() == 3);
+      const size_t n = 1000;
+      std::vector<double> signal(n);
+      for (double &x : signal) {
+        x = dist(gen);
+      }
+      // everything each level emits, and the input it was fed
+      std::vector<std::vector<double>> cD(3), inputs(4);
+      inputs[0] = signal;
+      std::vector<double> cA;
+      std::vector<double> details(3);
+      for (size_t i = 0; i < n; ++i) {
+        double a;
+        const size_t levels = stream.push(signal[i], details.data(), a);
+        // level 1 emits on every second sample once its ring is full
+        REQUIRE((levels > 0) == (i + 1 >= L && (i + 1 - L) % 2 == 0));
+        for (size_t j = 0; j < levels; ++j) {
+          cD[j].push_back(details[j]);
+        }
+        if (levels == 3) {
+          cA.push_back(a);
+        }
+      }
+      INFO(name);
+      for (size_t j = 0; j < 3; ++j) {
+        // the cA level j emits is what level j + 1 was fed
+        auto expected = dwt(inputs[j], name, "sym");
+        const size_t skip = L / 2 - 1;
+        REQUIRE(cD[j].size() == (inputs[j].size() - L) / 2 + 1);
+        for (size_t k = 0; k < cD[j].size(); ++k) {
+          REQUIRE(cD[j][k] == expected.second[skip + k]);
+        }
+        inputs[j + 1].assign(expected.first.begin() + skip,
+                             expected.first.begin() + skip + cD[j].size());
+      }
+      REQUIRE(cA == inputs[3]);
+    }
+  }
+
+  SECTION("delays") {
+    for (const char *name : {"db3", "sym5", "bior2.2"}) {
+      INFO(name);
+      const Wavelet &w = wavelet(name);
+      double gain = 0;
+      for (size_t m = 0; m < w.filterSize; ++m) {
+        gain += w.Lo_D[m];
+      }
+      // a ramp comes out scaled by the gain of each level, shifted by the
+      // approximation delay
+      SampleDwt stream(4, w);
+      std::vector<double> details(4);
+      for (size_t t = 0; t < 400; ++t) {
+        double a;
+        if (stream.push(static_cast<double>(t), details.data(), a) == 4) {
+          REQUIRE(a / std::pow(gain, 4) ==
+                  Approx(t - stream.approximation_delay(4)).margin(1e-9));
+        }
+      }
+      // an alternating ramp goes through the highpass filter of level 1
+      double highGain = 0;
+      for (size_t m = 0; m < w.filterSize; ++m) {
+        highGain += (m % 2 == 0 ? 1.0 : -1.0) * w.Ho_D[m];
+      }
+      stream.reset();
+      for (size_t t = 0; t < 100; ++t) {
+        const double sign = t % 2 == 0 ? 1.0 : -1.0;
+        double a;
+        if (stream.push(sign * t, details.data(), a) > 0) {
+          REQUIRE(sign * details[0] / highGain ==
+                  Approx(t - stream.detail_delay(1)).margin(1e-9));
+        }
+      }
+    }
+    // the symmetric filters of bior2.2, zero padded to 6 taps, are centred
+    // on taps 3 and 2
+    SampleDwt stream(2, "bior2.2");
+    REQUIRE(stream.approximation_delay(1) == Approx(3.0));
+    REQUIRE(stream.detail_delay(1) == Approx(2.0));
+    REQUIRE(stream.approximation_delay(2) == Approx(9.0));
+    REQUIRE(stream.detail_delay(2) == Approx(7.0));
+    REQUIRE_THROWS_WITH(stream.detail_delay(3), "Level out of range!");
+    REQUIRE_THROWS_WITH(stream.detail_delay(0), "Level out of range!");
+  }
+}
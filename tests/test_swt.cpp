@@ -0,0 +1,136 @@
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../swt.h"
+#include "../threadpool.h"
+#include <catch.hpp>
+#include "test_helpers.h"
+
+// swt with the filters upsampled by inserting zeros, the definition of pywt:
+// level j convolves periodically with the filters of length filterSize *
+// 2^(j - 1)
+static std::pair<std::vector<double>, std::vector<double>>
+reference_swt(const std::vector<double> &signal, size_t level,
+              const std::string &name) {
+  const Wavelet &w = wavelet(name);
+  const size_t n = signal.size();
+  std::vector<double> swa, swd;
+  std::vector<double> x = signal;
+  for (size_t j = 1; j <= level; ++j) {
+    const size_t step = size_t(1) << (j - 1);
+    std::vector<double> lo(w.filterSize * step), hi(w.filterSize * step);
+    for (size_t m = 0; m < w.filterSize; ++m) {
+      lo[m * step] = w.Lo_D[m];
+      hi[m * step] = w.Ho_D[m];
+    }
+    std::vector<double> a(n), d(n);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t k = 0; k < lo.size(); ++k) {
+        // (i + F / 2 - k) mod n
+        const size_t index = (i + lo.size() / 2 + n * lo.size() - k) % n;
+        a[i] += lo[k] * x[index];
+        d[i] += hi[k] * x[index];
+      }
+    }
+    swa.insert(swa.end(), a.begin(), a.end());
+    swd.insert(swd.end(), d.begin(), d.end());
+    x = a;
+  }
+  return std::make_pair(swa, swd);
+}
+
+TEST_CASE("test swt func", "[swt]") {
+  std::mt19937 gen(67);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  const char *names[] = {"haar", "db4", "sym7", "coif3", "bior3.5",
+                         "rbio2.8"};
+
+  SECTION("matches the zero inserted filters") {
+    for (const char *name : names) {
+      // the filters of the last levels are longer than the signal
+      for (size_t n : {16, 96}) {
+        for (size_t level : {1, 2, 4}) {
+          std::vector<double> signal(n);
+          for (double &x : signal) {
+            x = dist(gen);
+          }
+          INFO(name << " n = " << n << " level = " << level);
+          auto out = swt(signal, level, name);
+          auto expected = reference_swt(signal, level, name);
+          require_close(out.first, expected.first, 1e-12);
+          require_close(out.second, expected.second, 1e-12);
+        }
+      }
+    }
+  }
+
+  SECTION("is shift invariant") {
+    std::vector<double> signal(64);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    std::vector<double> shifted(signal.size());
+    for (size_t i = 0; i < signal.size(); ++i) {
+      shifted[(i + 3) % signal.size()] = signal[i];
+    }
+    auto out = swt(signal, 3, "db3");
+    auto outShifted = swt(shifted, 3, "db3");
+    for (size_t j = 0; j < 3; ++j) {
+      for (size_t i = 0; i < signal.size(); ++i) {
+        const size_t k = j * signal.size();
+        REQUIRE(outShifted.first[k + (i + 3) % signal.size()] ==
+                Approx(out.first[k + i]).margin(1e-12));
+        REQUIRE(outShifted.second[k + (i + 3) % signal.size()] ==
+                Approx(out.second[k + i]).margin(1e-12));
+      }
+    }
+  }
+
+  SECTION("iswt reconstructs") {
+    for (const char *name : names) {
+      for (size_t level : {1, 3, 5}) {
+        std::vector<double> signal(96);
+        for (double &x : signal) {
+          x = dist(gen);
+        }
+        INFO(name << " level = " << level);
+        auto out = swt(signal, level, name);
+        std::vector<double> cA(out.first.end() - signal.size(),
+                               out.first.end());
+        require_close(iswt(cA, out.second, name), signal, 1e-10);
+      }
+    }
+  }
+
+  SECTION("thread pool gives the same coefficients") {
+    // several chunks per level
+    std::vector<double> signal(1 << 17);
+    for (double &x : signal) {
+      x = dist(gen);
+    }
+    ThreadPool pool(3);
+    auto serial = swt(signal, 4, "sym5");
+    auto threaded = swt(signal, 4, "sym5", pool);
+    REQUIRE(threaded.first == serial.first);
+    REQUIRE(threaded.second == serial.second);
+
+    const Wavelet &w = wavelet("sym5");
+    const double *cA = serial.first.data() + 3 * signal.size();
+    std::vector<double> a(signal.size()), b(signal.size());
+    iswt(cA, serial.second.data(), signal.size(), 4, w, a.data());
+    iswt(cA, serial.second.data(), signal.size(), 4, w, b.data(), pool);
+    REQUIRE(a == b);
+    require_close(a, signal, 1e-10);
+  }
+
+  SECTION("errors") {
+    std::vector<double> signal(24);
+    REQUIRE_THROWS_WITH(swt(signal, 4, "db2"),
+                        "Signal length must be a multiple of 2^level!");
+    REQUIRE_THROWS_WITH(swt(std::vector<double>(), 1, "db2"),
+                        "input or wfilters is empty!");
+    REQUIRE_THROWS_WITH(iswt(signal, std::vector<double>(30), "db2"),
+                        "Detail size is not a multiple of cA size!");
+  }
+}
@@ -0,0 +1,74 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../threadpool.h"
+#include <catch.hpp>
+
+TEST_CASE("test ThreadPool", "[threadpool]") {
+  SECTION("runs every task once") {
+    for (size_t threads : {1, 2, 3, 8}) {
+      ThreadPool pool(threads);
+      REQUIRE(pool.size() == threads);
+      for (size_t count : {0, 1, 7, 1000}) {
+        INFO("threads = " << threads << " tasks = " << count);
+        std::vector<std::atomic<int>> runs(count);
+        for (std::atomic<int> &r : runs) {
+          r = 0;
+        }
+        std::vector<size_t> tasks(count);
+        for (size_t i = 0; i < count; ++i) {
+          tasks[i] = count - 1 - i;
+        }
+        pool.run(tasks, [&](size_t i) { ++runs[i]; });
+        for (size_t i = 0; i < count; ++i) {
+          REQUIRE(runs[i] == 1);
+        }
+      }
+    }
+  }
+
+  SECTION("idle threads steal uneven work") {
+    ThreadPool pool(4);
+    // every long task is dealt to the caller's queue
+    std::vector<size_t> tasks;
+    for (size_t i = 0; i < 64; ++i) {
+      tasks.push_back(i);
+    }
+    std::vector<std::thread::id> ran(tasks.size());
+    pool.run(tasks, [&](size_t i) {
+      if (i % 4 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+      ran[i] = std::this_thread::get_id();
+    });
+    for (const std::thread::id &id : ran) {
+      REQUIRE(id != std::thread::id());
+    }
+  }
+
+  SECTION("exceptions reach the caller") {
+    ThreadPool pool(3);
+    std::vector<size_t> tasks = {0, 1, 2, 3, 4, 5};
+    std::atomic<int> runs(0);
+    REQUIRE_THROWS_WITH(pool.run(tasks,
+                                 [&](size_t i) {
+                                   ++runs;
+                                   if (i == 4) {
+                                     throw std::runtime_error("Task failed!");
+                                   }
+                                 }),
+                        "Task failed!");
+    // the other tasks still run, and the pool stays usable
+    REQUIRE(runs == 6);
+    runs = 0;
+    pool.run(tasks, [&](size_t) { ++runs; });
+    REQUIRE(runs == 6);
+  }
+
+  SECTION("default pool") {
+    REQUIRE(default_thread_pool().size() >= 1);
+    REQUIRE(&default_thread_pool() == &default_thread_pool());
+  }
+}
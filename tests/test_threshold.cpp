@@ -0,0 +1,102 @@
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "../dwt.h"
+#include "../threshold.h"
+#include <catch.hpp>
+
+// the shrinkages by their textbook definitions
+static double shrink(double x, const std::string &shrinkage, double t,
+                     double high) {
+  const double a = std::abs(x);
+  if (a <= t) {
+    return 0.0;
+  }
+  if (shrinkage == "hard") {
+    return x;
+  }
+  if (shrinkage == "soft") {
+    return x > 0.0 ? x - t : x + t;
+  }
+  if (shrinkage == "garrote") {
+    return x - t * t / x;
+  }
+  if (a > high) {
+    return x;
+  }
+  return (x > 0.0 ? 1.0 : -1.0) * high * (a - t) / (high - t);
+}
+
+TEST_CASE("test wthresh func", "[threshold]") {
+  std::mt19937 gen(89);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  SECTION("matches the definitions") {
+    for (const char *shrinkage : {"hard", "soft", "garrote", "firm"}) {
+      INFO(shrinkage);
+      std::vector<double> x(1003);
+      for (double &v : x) {
+        v = dist(gen);
+      }
+      x[5] = 0.0;
+      x[6] = 0.4;
+      x[7] = -0.8;
+      std::vector<double> y = x;
+      wthresh(y.data(), y.size(), shrinkage, 0.4, 0.8);
+      for (size_t i = 0; i < x.size(); ++i) {
+        REQUIRE(y[i] == Approx(shrink(x[i], shrinkage, 0.4, 0.8)));
+      }
+    }
+  }
+
+  SECTION("per level over a decomposition") {
+    std::vector<double> signal(999);
+    for (double &v : signal) {
+      v = dist(gen);
+    }
+    auto decomposition = wavelet_decomposition(signal, 3, "db3");
+    std::vector<double> coeffs = decomposition.first;
+    const std::vector<double> &lengths = decomposition.second;
+    const std::vector<double> thresholds = {0.1, 0.2, 0.3};
+    const std::vector<double> highs = {0.5, 0.6, 0.7};
+    wthresh(coeffs, lengths, "firm", thresholds, highs);
+
+    const std::vector<double> &original = decomposition.first;
+    // the final cA is kept, then cD_3, cD_2 and cD_1
+    size_t offset = size_t(lengths.back());
+    for (size_t i = 0; i < offset; ++i) {
+      REQUIRE(coeffs[i] == original[i]);
+    }
+    for (size_t j = 3; j > 0; --j) {
+      for (size_t i = 0; i < size_t(lengths[j - 1]); ++i, ++offset) {
+        REQUIRE(coeffs[offset] == Approx(shrink(original[offset], "firm",
+                                                thresholds[j - 1],
+                                                highs[j - 1])));
+      }
+    }
+    REQUIRE(offset == coeffs.size());
+  }
+
+  SECTION("errors") {
+    std::vector<double> x(8);
+    REQUIRE_THROWS_WITH(wthresh(x.data(), 8, "median", 0.1),
+                        "Shrinkage error!");
+    REQUIRE_THROWS_WITH(wthresh(x.data(), 8, "soft", -0.1),
+                        "Threshold must not be negative!");
+    REQUIRE_THROWS_WITH(wthresh(x.data(), 8, "firm", 0.5, 0.5),
+                        "Firm threshold high must exceed the low one!");
+    auto decomposition = wavelet_decomposition(std::vector<double>(64), 2,
+                                               "db2");
+    REQUIRE_THROWS_WITH(
+        wthresh(decomposition.first, decomposition.second, "soft", {0.1}),
+        "Thresholds do not match the lengths!");
+    REQUIRE_THROWS_WITH(wthresh(decomposition.first, decomposition.second,
+                                "firm", {0.1, 0.1}),
+                        "Thresholds do not match the lengths!");
+    decomposition.first.pop_back();
+    REQUIRE_THROWS_WITH(wthresh(decomposition.first, decomposition.second,
+                                "soft", {0.1, 0.1}),
+                        "Coefficients do not match the lengths!");
+  }
+}
@@ -0,0 +1,166 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../wavelets.h"
+#include <catch.hpp>
+#include <cmath>
+
+TEST_CASE("test wavelet registry", "[wavelets]") {
+  SECTION("lookup by name and id") {
+    REQUIRE(wavelet_count() == 63);
+    for (size_t id = 0; id < wavelet_count(); ++id) {
+      const Wavelet &w = wavelet_at(id);
+      INFO("wavelet : " << w.name);
+      REQUIRE(w.id == id);
+      REQUIRE(&wavelet(w.name) == &w);
+      if (id > 0) {
+        REQUIRE(std::strcmp(wavelet_at(id - 1).name, w.name) < 0);
+      }
+    }
+  }
+
+  SECTION("unknown names and ids") {
+    REQUIRE_THROWS_AS(wavelet("db21"), const std::runtime_error &);
+    REQUIRE_THROWS_AS(wavelet("db"), const std::runtime_error &);
+    REQUIRE_THROWS_AS(wavelet(""), const std::runtime_error &);
+    REQUIRE_THROWS_AS(wavelet_at(wavelet_count()),
+                      const std::runtime_error &);
+  }
+
+  SECTION("families") {
+    REQUIRE(wavelet("haar").family == WaveletFamily::Haar);
+    REQUIRE(wavelet("db20").filterSize == 40);
+    REQUIRE(wavelet("sym10").family == WaveletFamily::Symlets);
+    REQUIRE(wavelet("coif5").filterSize == 30);
+    REQUIRE(!wavelet("bior4.4").orthogonal);
+    REQUIRE(wavelet("rbio6.8").family == WaveletFamily::ReverseBiorthogonal);
+  }
+
+  SECTION("filters are aligned") {
+    for (size_t id = 0; id < wavelet_count(); ++id) {
+      const Wavelet &w = wavelet_at(id);
+      for (const double *filter : {w.Lo_D, w.Ho_D, w.Lo_R, w.Ho_R}) {
+        REQUIRE(reinterpret_cast<uintptr_t>(filter) % 64 == 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("test wavelet filters", "[wavelets]") {
+  SECTION("perfect reconstruction") {
+    // Lo_R * Lo_D + Ho_R * Ho_D is a delay by 2, and the aliased terms cancel
+    for (size_t id = 0; id < wavelet_count(); ++id) {
+      const Wavelet &w = wavelet_at(id);
+      INFO("wavelet : " << w.name);
+      const size_t L = w.filterSize;
+      for (size_t n = 0; n < 2 * L - 1; ++n) {
+        double sum = 0.0, alias = 0.0;
+        for (size_t k = 0; k < L; ++k) {
+          if (n < k || n - k >= L) {
+            continue;
+          }
+          const double term = w.Lo_R[k] * w.Lo_D[n - k] +
+                              w.Ho_R[k] * w.Ho_D[n - k];
+          sum += term;
+          alias += (n - k) % 2 ? -term : term;
+        }
+        REQUIRE(sum == Approx(n == L - 1 ? 2.0 : 0.0).margin(1e-14));
+        REQUIRE(alias == Approx(0.0).margin(1e-14));
+      }
+    }
+  }
+
+  SECTION("orthogonal wavelets") {
+    for (size_t id = 0; id < wavelet_count(); ++id) {
+      const Wavelet &w = wavelet_at(id);
+      if (!w.orthogonal) {
+        continue;
+      }
+      INFO("wavelet : " << w.name);
+      const size_t L = w.filterSize;
+      for (size_t m = 0; 2 * m < L; ++m) {
+        double dot = 0.0;
+        for (size_t k = 0; k + 2 * m < L; ++k) {
+          dot += w.Lo_R[k] * w.Lo_R[k + 2 * m];
+        }
+        REQUIRE(dot == Approx(m == 0 ? 1.0 : 0.0).margin(1e-14));
+      }
+      for (size_t k = 0; k < L; ++k) {
+        REQUIRE(w.Lo_D[k] == w.Lo_R[L - 1 - k]);
+      }
+    }
+  }
+
+  SECTION("vanishing moments") {
+    // dbN and symN have N vanishing wavelet moments, coifN 2N, and the
+    // scaling function of coifN N - 1 more around its center
+    for (size_t id = 0; id < wavelet_count(); ++id) {
+      const Wavelet &w = wavelet_at(id);
+      if (w.family != WaveletFamily::Daubechies &&
+          w.family != WaveletFamily::Symlets &&
+          w.family != WaveletFamily::Coiflets) {
+        continue;
+      }
+      INFO("wavelet : " << w.name);
+      const size_t L = w.filterSize;
+      const size_t moments = w.family == WaveletFamily::Coiflets ? L / 3 : L / 2;
+      for (size_t j = 0; j < moments; ++j) {
+        double sum = 0.0, scale = 0.0;
+        for (size_t k = 0; k < L; ++k) {
+          const double term = std::pow(double(k) / L, double(j)) * w.Ho_D[k];
+          sum += term;
+          scale += std::fabs(term);
+        }
+        REQUIRE(sum == Approx(0.0).margin(1e-12 * scale));
+      }
+    }
+  }
+
+  SECTION("closed forms") {
+    const double s3 = std::sqrt(3.0), s7 = std::sqrt(7.0), s2 = std::sqrt(2.0);
+    const std::vector<double> db2 = {(1 + s3) / (4 * s2), (3 + s3) / (4 * s2),
+                                     (3 - s3) / (4 * s2), (1 - s3) / (4 * s2)};
+    const std::vector<double> coif1 = {
+        (1 - s7) / (16 * s2),      (5 + s7) / (16 * s2),
+        (14 + 2 * s7) / (16 * s2), (14 - 2 * s7) / (16 * s2),
+        (1 - s7) / (16 * s2),      (s7 - 3) / (16 * s2)};
+    for (size_t k = 0; k < 4; ++k) {
+      REQUIRE(wavelet("db2").Lo_R[k] == Approx(db2[k]).margin(1e-15));
+      REQUIRE(wavelet("sym2").Lo_R[k] == Approx(db2[k]).margin(1e-15));
+    }
+    for (size_t k = 0; k < 6; ++k) {
+      REQUIRE(wavelet("coif1").Lo_R[k] == Approx(coif1[k]).margin(1e-15));
+    }
+
+    const std::vector<double> bior22_Lo_D = {0.0,      -s2 / 8, s2 / 4,
+                                             3 * s2 / 4, s2 / 4,  -s2 / 8};
+    const std::vector<double> bior22_Lo_R = {0.0, s2 / 4, s2 / 2,
+                                             s2 / 4, 0.0, 0.0};
+    for (size_t k = 0; k < 6; ++k) {
+      REQUIRE(wavelet("bior2.2").Lo_D[k] == Approx(bior22_Lo_D[k]));
+      REQUIRE(wavelet("bior2.2").Lo_R[k] == Approx(bior22_Lo_R[k]));
+      REQUIRE(wavelet("rbio2.2").Lo_D[k] == Approx(bior22_Lo_R[5 - k]));
+      REQUIRE(wavelet("rbio2.2").Lo_R[k] == Approx(bior22_Lo_D[5 - k]));
+    }
+  }
+
+  SECTION("published values") {
+    // wfilters('sym4') and wfilters('bior4.4') as published, rounded to 13
+    // decimals; the MATLAB tables themselves are accurate to about 1e-12
+    const std::vector<double> sym4_Lo_D = {
+        -0.0757657147893, -0.0296355276460, 0.4976186676320, 0.8037387518059,
+        0.2978577956053,  -0.0992195435768, -0.0126039672620, 0.0322231006040};
+    const std::vector<double> bior44_Lo_D = {
+        0.0,  0.0378284555073, -0.0238494650196, -0.1106244044184,
+        0.3774028556128, 0.8526986790089, 0.3774028556128, -0.1106244044184,
+        -0.0238494650196, 0.0378284555073};
+    for (size_t k = 0; k < sym4_Lo_D.size(); ++k) {
+      REQUIRE(wavelet("sym4").Lo_D[k] == Approx(sym4_Lo_D[k]).margin(2e-12));
+    }
+    for (size_t k = 0; k < bior44_Lo_D.size(); ++k) {
+      REQUIRE(wavelet("bior4.4").Lo_D[k] ==
+              Approx(bior44_Lo_D[k]).margin(2e-12));
+    }
+  }
+}
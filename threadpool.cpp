@@ -0,0 +1,176 @@
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "threadpool.h"
+
+/**
+ * Starts the worker threads.
+ *
+ * @param threads The number of threads running tasks, the caller of run()
+ * included, or 0 for one per hardware thread.
+ */
+ThreadPool::ThreadPool(size_t threads)
+    : task_(nullptr), generation_(0), busy_(0), stop_(false) {
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  if (threads == 0) {
+    threads = 1;
+  }
+  for (size_t i = 0; i < threads; ++i) {
+    queues_.emplace_back(new Queue);
+  }
+  // queue 0 belongs to the caller of run()
+  for (size_t i = 1; i < threads; ++i) {
+    threads_.emplace_back(&ThreadPool::worker, this, i);
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Stops and joins the worker threads.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Runs a batch of tasks on the pool and the calling thread.
+ *
+ * @param tasks The task arguments, the most expensive first.
+ * @param task The task, called once for every element of tasks.
+ */
+void ThreadPool::run(const std::vector<size_t> &tasks,
+                     const std::function<void(size_t)> &task) {
+  std::lock_guard<std::mutex> runLock(runMutex_);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    Queue &queue = *queues_[i % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(tasks[i]);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    error_ = nullptr;
+    busy_ = threads_.size();
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  work(0);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+    error = error_;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Waits for batches and works on them until the pool is destroyed.
+ *
+ * @param index The queue of the thread.
+ */
+void ThreadPool::worker(size_t index) {
+  size_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+    }
+
+    work(index);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busy_ == 0) {
+      done_.notify_one();
+    }
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Runs tasks until there are none left in any queue, recording the first
+ * exception.
+ *
+ * @param index The queue of the thread.
+ */
+void ThreadPool::work(size_t index) {
+  size_t task;
+  while (next_task(index, task)) {
+    try {
+      (*task_)(task);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Takes the next task of a thread: the front of its own queue, or else the
+ * back of the next non-empty queue.
+ *
+ * @param index The queue of the thread.
+ * @param task Set to the task argument.
+ * @return False when all queues are empty.
+ */
+bool ThreadPool::next_task(size_t index, size_t &task) {
+  {
+    Queue &own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = own.tasks.front();
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    Queue &victim = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.back();
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+//-------------------------------------------------------------
+/**
+ * The pool with one thread per hardware thread.
+ *
+ * @return The pool, created on first use.
+ */
+ThreadPool &default_thread_pool() {
+  static ThreadPool pool;
+  return pool;
+}
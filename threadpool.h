@@ -0,0 +1,69 @@
+#ifndef threadpool_h
+#define threadpool_h
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run batches of independent tasks. The
+// tasks of a batch are dealt round robin into one deque per thread, in the
+// order given, so that passing the most expensive tasks first spreads them
+// evenly. A thread takes tasks from the front of its own deque and, once that
+// is empty, steals from the back of the others. The calling thread works
+// alongside the pool, and run() returns when every task has finished.
+class ThreadPool {
+public:
+  // threads = 0 uses one thread per hardware thread
+  explicit ThreadPool(size_t threads = 0);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // number of threads running tasks, the caller included
+  size_t size() const { return queues_.size(); }
+
+  // Runs task(i) for every i of tasks and rethrows the first exception a task
+  // threw. Tasks must not call run() on the same pool.
+  void run(const std::vector<size_t> &tasks,
+           const std::function<void(size_t)> &task);
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  void worker(size_t index);
+
+  void work(size_t index);
+
+  bool next_task(size_t index, size_t &task);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+  // one batch at a time
+  std::mutex runMutex_;
+  // guards the batch state below
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(size_t)> *task_;
+  size_t generation_;
+  // workers that have not finished the current batch
+  size_t busy_;
+  bool stop_;
+  std::exception_ptr error_;
+};
+
+// Pool with one thread per hardware thread, created on first use.
+ThreadPool &default_thread_pool();
+
+#endif /* threadpool_h */
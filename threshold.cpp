@@ -0,0 +1,109 @@
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "kernels.h"
+#include "threshold.h"
+
+/**
+ * Parses the name of a shrinkage.
+ *
+ * @param shrinkage "hard", "soft", "garrote" or "firm".
+ * @return The shrinkage.
+ */
+ThresholdKind threshold_kind(const std::string &shrinkage) {
+  if (shrinkage == "hard") {
+    return ThresholdKind::Hard;
+  }
+  if (shrinkage == "soft") {
+    return ThresholdKind::Soft;
+  }
+  if (shrinkage == "garrote") {
+    return ThresholdKind::Garrote;
+  }
+  if (shrinkage == "firm") {
+    return ThresholdKind::Firm;
+  }
+  throw std::runtime_error("Shrinkage error!");
+}
+
+//-------------------------------------------------------------
+/**
+ * Checks the thresholds of one shrinkage.
+ *
+ * @param kind The shrinkage.
+ * @param threshold The threshold, the lower one of the firm shrinkage.
+ * @param high The upper threshold of the firm shrinkage.
+ */
+static void check_thresholds(ThresholdKind kind, double threshold,
+                             double high) {
+  if (!(threshold >= 0.0)) {
+    throw std::runtime_error("Threshold must not be negative!");
+  }
+  if (kind == ThresholdKind::Firm && !(high > threshold)) {
+    throw std::runtime_error("Firm threshold high must exceed the low one!");
+  }
+}
+
+//-------------------------------------------------------------
+/**
+ * Thresholds coefficients in place.
+ *
+ * @param x The coefficients.
+ * @param count The number of coefficients.
+ * @param shrinkage "hard", "soft", "garrote" or "firm".
+ * @param threshold The threshold, the lower one of the firm shrinkage.
+ * @param high The upper threshold of the firm shrinkage.
+ */
+void wthresh(double *x, size_t count, const std::string &shrinkage,
+             double threshold, double high) {
+  const ThresholdKind kind = threshold_kind(shrinkage);
+  check_thresholds(kind, threshold, high);
+  active_kernels().threshold(x, count, kind, threshold, high);
+}
+
+//-------------------------------------------------------------
+/**
+ * Thresholds the details of a multilevel decomposition in place, one kernel
+ * call per level.
+ *
+ * @param coeffs The coefficients cA_level, cD_level .. cD_1.
+ * @param lengths The lengths of cD_1 .. cD_level.
+ * @param shrinkage "hard", "soft", "garrote" or "firm".
+ * @param thresholds The thresholds of cD_1 .. cD_level.
+ * @param highs The upper thresholds of the firm shrinkage, per level.
+ */
+void wthresh(std::vector<double> &coeffs, const std::vector<double> &lengths,
+             const std::string &shrinkage,
+             const std::vector<double> &thresholds,
+             const std::vector<double> &highs) {
+  const ThresholdKind kind = threshold_kind(shrinkage);
+  const size_t level = lengths.size();
+  if (thresholds.size() != level ||
+      (kind == ThresholdKind::Firm && highs.size() != level)) {
+    throw std::runtime_error("Thresholds do not match the lengths!");
+  }
+  // the final cA has the length of cD_level
+  size_t total = level > 0 ? static_cast<size_t>(lengths.back()) : 0;
+  for (double length : lengths) {
+    total += static_cast<size_t>(length);
+  }
+  if (level > 0 && total != coeffs.size()) {
+    throw std::runtime_error("Coefficients do not match the lengths!");
+  }
+  for (size_t j = 0; j < level; ++j) {
+    check_thresholds(kind, thresholds[j],
+                     kind == ThresholdKind::Firm ? highs[j] : 0.0);
+  }
+
+  const KernelTable &kernels = active_kernels();
+  size_t offset = total;
+  for (size_t j = 0; j < level; ++j) {
+    // cD_1 comes last
+    const size_t size = static_cast<size_t>(lengths[j]);
+    offset -= size;
+    kernels.threshold(coeffs.data() + offset, size, kind, thresholds[j],
+                      kind == ThresholdKind::Firm ? highs[j] : 0.0);
+  }
+}
@@ -0,0 +1,28 @@
+#ifndef threshold_h
+#define threshold_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "kernels.h"
+
+// Parses a shrinkage name, "hard", "soft", "garrote" or "firm".
+ThresholdKind threshold_kind(const std::string &shrinkage);
+
+// Thresholds count coefficients in place with the vectorized kernel of the
+// active instruction set. threshold must not be negative; the firm shrinkage
+// also needs high > threshold, which the others ignore.
+void wthresh(double *x, size_t count, const std::string &shrinkage,
+             double threshold, double high = 0.0);
+
+// Thresholds the details of a wavelet_decomposition() in place, level by
+// level from the cD lengths returned with the coefficients: thresholds[j - 1]
+// (and highs[j - 1] for the firm shrinkage) applies to cD_j, and the final
+// approximation is kept.
+void wthresh(std::vector<double> &coeffs, const std::vector<double> &lengths,
+             const std::string &shrinkage,
+             const std::vector<double> &thresholds,
+             const std::vector<double> &highs = std::vector<double>());
+
+#endif /* threshold_h */
@@ -0,0 +1,715 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "wavelets.h"
+
+// Filter coefficients follow the MATLAB wfilters conventions. Orthogonal
+// wavelets are stored by their scaling filter Lo_R and biorthogonal ones by
+// their two low pass filters, the remaining filters are derived at compile
+// time, see orthogonal_bank() and biorthogonal_bank().
+//
+// Daubechies filters are the minimum phase spectral factors of the Daubechies
+// polynomial, symlets the factors with the most nearly linear phase, coiflets
+// the solutions of Daubechies' moment conditions with the most concentrated
+// filter. All of them are computed in extended precision and rounded once.
+
+//-------------------------------------------------------------
+// All four filters of a wavelet, each aligned for the SIMD kernels.
+template <size_t N> struct FilterBank {
+  alignas(64) double Lo_D[N];
+  alignas(64) double Ho_D[N];
+  alignas(64) double Lo_R[N];
+  alignas(64) double Ho_R[N];
+  alignas(64) float Lo_D_f32[N];
+  alignas(64) float Ho_D_f32[N];
+  alignas(64) float Lo_R_f32[N];
+  alignas(64) float Ho_R_f32[N];
+};
+
+// Fills in the float copies of the double filters.
+template <size_t N>
+constexpr FilterBank<N> with_float_filters(FilterBank<N> bank) {
+  for (size_t k = 0; k < N; ++k) {
+    bank.Lo_D_f32[k] = static_cast<float>(bank.Lo_D[k]);
+    bank.Ho_D_f32[k] = static_cast<float>(bank.Ho_D[k]);
+    bank.Lo_R_f32[k] = static_cast<float>(bank.Lo_R[k]);
+    bank.Ho_R_f32[k] = static_cast<float>(bank.Ho_R[k]);
+  }
+  return bank;
+}
+
+// Ho_D[k] = (-1)^(k+1) Lo_R[k] and Ho_R[k] = (-1)^k Lo_D[k].
+template <size_t N>
+constexpr FilterBank<N> biorthogonal_bank(const double (&Lo_D)[N],
+                                          const double (&Lo_R)[N]) {
+  FilterBank<N> bank{};
+  for (size_t k = 0; k < N; ++k) {
+    bank.Lo_D[k] = Lo_D[k];
+    bank.Lo_R[k] = Lo_R[k];
+    bank.Ho_D[k] = k % 2 ? Lo_R[k] : -Lo_R[k];
+    bank.Ho_R[k] = k % 2 ? -Lo_D[k] : Lo_D[k];
+  }
+  return with_float_filters(bank);
+}
+
+// Orthogonal wavelets analyse with the time reversed synthesis filters.
+template <size_t N>
+constexpr FilterBank<N> orthogonal_bank(const double (&Lo_R)[N]) {
+  double Lo_D[N] = {};
+  for (size_t k = 0; k < N; ++k) {
+    Lo_D[k] = Lo_R[N - 1 - k];
+  }
+  return biorthogonal_bank(Lo_D, Lo_R);
+}
+
+// The reverse biorthogonal wavelet rbioX.Y swaps the analysis and synthesis
+// filters of biorX.Y, time reversed.
+template <size_t N>
+constexpr FilterBank<N> reverse_bank(const FilterBank<N> &bank) {
+  FilterBank<N> reversed{};
+  for (size_t k = 0; k < N; ++k) {
+    reversed.Lo_D[k] = bank.Lo_R[N - 1 - k];
+    reversed.Ho_D[k] = bank.Ho_R[N - 1 - k];
+    reversed.Lo_R[k] = bank.Lo_D[N - 1 - k];
+    reversed.Ho_R[k] = bank.Ho_D[N - 1 - k];
+  }
+  return with_float_filters(reversed);
+}
+
+template <size_t N>
+constexpr Wavelet wavelet_entry(const char *name, size_t id,
+                                WaveletFamily family, bool orthogonal,
+                                const FilterBank<N> &bank) {
+  return Wavelet{name,      id,        family,        orthogonal,
+                 N,         bank.Lo_D, bank.Ho_D,     bank.Lo_R,
+                 bank.Ho_R, bank.Lo_D_f32, bank.Ho_D_f32, bank.Lo_R_f32,
+                 bank.Ho_R_f32};
+}
+
+//-------------------------------------------------------------
+// Daubechies, scaling filters (Lo_R)
+
+static constexpr double kDb1[] = {
+    0.7071067811865476, 0.7071067811865476};
+
+static constexpr double kDb2[] = {
+    0.48296291314453416, 0.8365163037378079, 0.2241438680420134,
+    -0.12940952255126037};
+
+static constexpr double kDb3[] = {
+    0.33267055295008263, 0.8068915093110925, 0.45987750211849154,
+    -0.13501102001025458, -0.08544127388202666, 0.03522629188570953};
+
+static constexpr double kDb4[] = {
+    0.2303778133088965, 0.7148465705529157, 0.6308807679298589,
+    -0.027983769416859854, -0.18703481171909309, 0.030841381835560764,
+    0.0328830116668852, -0.010597401785069032};
+
+static constexpr double kDb5[] = {
+    0.16010239797419293, 0.6038292697971896, 0.7243085284377729,
+    0.13842814590132074, -0.24229488706638203, -0.032244869584638375,
+    0.07757149384004572, -0.006241490212798274, -0.012580751999081999,
+    0.0033357252854737712};
+
+static constexpr double kDb6[] = {
+    0.11154074335010947, 0.49462389039845306, 0.7511339080210954,
+    0.31525035170919763, -0.22626469396543983, -0.12976686756726194,
+    0.09750160558732304, 0.027522865530305727, -0.03158203931748603,
+    0.0005538422011614961, 0.004777257510945511, -0.0010773010853084796};
+
+static constexpr double kDb7[] = {
+    0.07785205408500918, 0.3965393194819173, 0.7291320908462351,
+    0.4697822874051931, -0.14390600392856498, -0.22403618499387498,
+    0.07130921926683026, 0.08061260915108308, -0.03802993693501441,
+    -0.01657454163066688, 0.01255099855609984, 0.0004295779729213665,
+    -0.0018016407040474908, 0.00035371379997452024};
+
+static constexpr double kDb8[] = {
+    0.05441584224310401, 0.31287159091429995, 0.6756307362972898,
+    0.5853546836542067, -0.015829105256349306, -0.2840155429615469,
+    0.0004724845739132828, 0.12874742662047847, -0.017369301001807547,
+    -0.044088253930794755, 0.013981027917398282, 0.008746094047405777,
+    -0.004870352993451574, -0.00039174037337694705, 0.0006754494064505693,
+    -0.00011747678412476953};
+
+static constexpr double kDb9[] = {
+    0.038077947363878345, 0.24383467461259034, 0.6048231236901112,
+    0.6572880780513005, 0.13319738582500756, -0.2932737832791749,
+    -0.09684078322297646, 0.14854074933810638, 0.03072568147933338,
+    -0.06763282906132997, 0.00025094711483145197, 0.022361662123679096,
+    -0.004723204757751397, -0.00428150368246343, 0.0018476468830562265,
+    0.00023038576352319597, -0.0002519631889427101, 3.93473203162716e-05};
+
+static constexpr double kDb10[] = {
+    0.026670057900555554, 0.1881768000776915, 0.5272011889317256,
+    0.6884590394536035, 0.2811723436605775, -0.24984642432731538,
+    -0.19594627437737705, 0.12736934033579325, 0.09305736460357235,
+    -0.07139414716639708, -0.029457536821875813, 0.033212674059341,
+    0.0036065535669561697, -0.010733175483330575, 0.001395351747052901,
+    0.001992405295185056, -0.0006858566949597116, -0.00011646685512928545,
+    9.358867032006959e-05, -1.3264202894521244e-05};
+
+static constexpr double kDb11[] = {
+    0.018694297761471083, 0.1440670211506245, 0.44989976435604534,
+    0.6856867749162006, 0.41196436894790744, -0.16227524502749036,
+    -0.27423084681794696, 0.0660435881966832, 0.14981201246637849,
+    -0.046479955116684187, -0.0664387856950252, 0.031335090219046076,
+    0.020840904360181062, -0.0153648209062016, -0.0033408588730144454,
+    0.004928417656059041, -0.0003085928588151432, -0.0008930232506662646,
+    0.0002491525235528235, 5.4439074699368475e-05, -3.4634984186984996e-05,
+    4.49427427723651e-06};
+
+static constexpr double kDb12[] = {
+    0.013112257957229518, 0.10956627282118515, 0.37735513521421266,
+    0.6571987225793071, 0.5158864784278157, -0.04476388565377463,
+    -0.3161784537527855, -0.023779257256069726, 0.18247860592757967,
+    0.00535956967435215, -0.09643212009650708, 0.010849130255822185,
+    0.04154627749508444, -0.01221864906974828, -0.012840825198300683,
+    0.00671149900879551, 0.0022486072409952378, -0.0021795036186277603,
+    6.545128212509596e-06, 0.00038865306282093143, -8.850410920820432e-05,
+    -2.4241545757030785e-05, 1.2776952219379767e-05, -1.529071758068511e-06};
+
+static constexpr double kDb13[] = {
+    0.009202133538962367, 0.08286124387290278, 0.31199632216043804,
+    0.6110558511587877, 0.5888895704312189, 0.08698572617964724,
+    -0.31497290771138864, -0.12457673075081525, 0.17947607942933985,
+    0.07294893365677717, -0.10580761818793433, -0.026488406475343694,
+    0.05613947710028343, 0.0023799722540590786, -0.02383142071032365,
+    0.003923941448797416, 0.007255589401617566, -0.0027619112346568622,
+    -0.001315673911892299, 0.0009323261308672633, 4.9251525126289464e-05,
+    -0.0001651289885565055, 3.0678537579325496e-05, 1.0441930571408138e-05,
+    -4.700416479360868e-06, 5.220035098454864e-07};
+
+static constexpr double kDb14[] = {
+    0.006461153460087948, 0.0623647588493989, 0.2548502677926214,
+    0.5543056179408938, 0.6311878491048568, 0.21867068775890652,
+    -0.27168855227874805, -0.21803352999327605, 0.1383952138648066,
+    0.1399890165844607, -0.08674841156816969, -0.07154895550404614,
+    0.05523712625921604, 0.026981408307912916, -0.030185351540390634,
+    -0.005615049530356959, 0.01278949326633341, -0.000746218989268385,
+    -0.0038496388680221874, 0.001061691085606762, 0.0007080211542355279,
+    -0.0003868319473129545, -4.1777245770372596e-05, 6.87550425269751e-05,
+    -1.0337209184570774e-05, -4.389704901781394e-06, 1.7249946753678127e-06,
+    -1.7871399683113592e-07};
+
+static constexpr double kDb15[] = {
+    0.004538537361578899, 0.04674339489276627, 0.20602386398699574,
+    0.4926317717081396, 0.6458131403574243, 0.3390025354547315,
+    -0.19320413960914543, -0.28888259656696563, 0.06528295284877282,
+    0.190146714007123, -0.039666176555790945, -0.1111209360372317,
+    0.033877143923507685, 0.05478055058450761, -0.025767007328439964,
+    -0.020810050169693083, 0.015083918027835902, 0.005101000360407543,
+    -0.006487734560315745, -0.00024175649076162427, 0.0019433239803822114,
+    -0.000373482354137617, -0.0003595652443624688, 0.00015589648992059973,
+    2.5792699155318936e-05, -2.8133296266047814e-05, 3.36298718173758e-06,
+    1.8112704079405772e-06, -6.316882325881664e-07, 6.133359913305752e-08};
+
+static constexpr double kDb16[] = {
+    0.003189220925347738, 0.034907714323673344, 0.16506428348885313,
+    0.4303127228460038, 0.637356332083789, 0.4402902568863569,
+    -0.08975108940248964, -0.3270633105279177, -0.027918208133028276,
+    0.2111906939471043, 0.027340263752716042, -0.1323883055638104,
+    -0.006239722752474872, 0.07592423604427631, -0.007588974368857738,
+    -0.03688839769173014, 0.01029765964095597, 0.013993768859828731,
+    -0.006990014563413916, -0.00364427962149839, 0.003128023381206269,
+    0.00040789698084971285, -0.0009410217493595676, 0.00011424152003872239,
+    0.00017478724522533817, -6.103596621410936e-05, -1.3945668988208893e-05,
+    1.1336608661276258e-05, -1.0435713423116066e-06, -7.363656785451205e-07,
+    2.3087840868575457e-07, -2.109339630100743e-08};
+
+static constexpr double kDb17[] = {
+    0.0022418070010373128, 0.025985393703606044, 0.1312149033078244,
+    0.37035072415264114, 0.6109966156846228, 0.5183157640569378,
+    0.027314970403293636, -0.32832074836396175, -0.1265997522158827,
+    0.197310589565011, 0.10113548917747027, -0.1268156917782863,
+    -0.05709141963167693, 0.08110598665416088, 0.022312336178103798,
+    -0.04692243838926974, -0.0032709555358192938, 0.02273367658394627,
+    -0.003042989981354637, -0.008602921520322855, 0.0029679966915260947,
+    0.0023012052421535457, -0.0014368453048029762, -0.00032813251940983797,
+    0.0004394654277686437, -2.5610109566548458e-05, -8.204803202453391e-05,
+    2.3186813798745952e-05, 6.9906009850767515e-06, -4.505942477222988e-06,
+    3.0165496099945573e-07, 2.957700933316857e-07, -8.42394844600268e-08,
+    7.2674929685616085e-09};
+
+static constexpr double kDb18[] = {
+    0.0015763102184407605, 0.019288531724146376, 0.10358846582242359,
+    0.3146789413370317, 0.5718268077666072, 0.5718016548886513,
+    0.14722311196992816, -0.29365404073655876, -0.21648093400514298,
+    0.14953397556537779, 0.1670813127632574, -0.09233188415084628,
+    -0.10675224665982849, 0.06488721621190545, 0.057051247738536884,
+    -0.044526141902982326, -0.023733210395860002, 0.02667070592647059,
+    0.006262167954305707, -0.013051480946612001, 0.00011863003385811746,
+    0.004943343605466738, -0.0011187326669924971, -0.0013405962983361066,
+    0.0006284656829651457, 0.0002135815619103407, -0.00019864855231174796,
+    -1.5359171235347246e-07, 3.7412378807400385e-05, -8.520602537446696e-06,
+    -3.332634478885822e-06, 1.7687129836276155e-06, -7.691632689885177e-08,
+    -1.1760987670282317e-07, 3.068835863045175e-08, -2.5079344549485983e-09};
+
+static constexpr double kDb19[] = {
+    0.0011086697631817106, 0.014281098450764397, 0.08127811326545956,
+    0.26438843174089677, 0.5244363774646549, 0.6017045491275379,
+    0.26089495265103885, -0.22809139421548263, -0.28583863175582624,
+    0.07465226970810326, 0.21234974330627848, -0.03351854190230288,
+    -0.1427856950387366, 0.027584350625628667, 0.08690675555581223,
+    -0.02650123625012304, -0.04567422627723091, 0.02162376740958505,
+    0.019375549889176127, -0.013988388678535142, -0.005866922281012175,
+    0.007040747367105243, 0.0007689543592575484, -0.002687551800701582,
+    0.00034180865345859575, 0.0007358025205054352, -0.000260676135678628,
+    -0.00012460079173415878, 8.711270467219923e-05, 5.105950487073886e-06,
+    -1.6640176297154945e-05, 3.0109643162965265e-06, 1.531931476691193e-06,
+    -6.862755657769143e-07, 1.4470882987978445e-08, 4.6369377757826045e-08,
+    -1.1164020670358259e-08, 8.666848838997619e-10};
+
+static constexpr double kDb20[] = {
+    0.0007799536136668463, 0.010549394624950399, 0.06342378045908152,
+    0.21994211355139703, 0.4726961853109017, 0.6104932389385939,
+    0.36150229873933104, -0.13921208801148388, -0.32678680043403496,
+    -0.016727088309077008, 0.22829105081991632, 0.0398502464577712,
+    -0.15545875070726795, -0.024716827338613585, 0.10229171917444256,
+    0.005632246857307436, -0.06172289962468046, 0.005874681811811827,
+    0.03229429953076958, -0.00878932492390156, -0.01381052613715192,
+    0.006721627302259457, 0.004420542387045791, -0.0035814942596096226,
+    -0.0008315621728225569, 0.0013925596193231364, -5.349759843997695e-05,
+    -0.00038510474869921763, 0.00010153288973670291, 6.77428082837773e-05,
+    -3.710586183394713e-05, -4.376143862183997e-06, 7.2412482876736205e-06,
+    -1.0119940100188862e-06, -6.847079597000557e-07, 2.6339242262700013e-07,
+    2.0143220235505126e-10, -1.814843248299696e-08, 4.056127055551833e-09,
+    -2.9988364896193194e-10};
+
+//-------------------------------------------------------------
+// Symlets, scaling filters (Lo_R)
+
+static constexpr double kSym2[] = {
+    0.48296291314453416, 0.8365163037378079, 0.2241438680420134,
+    -0.12940952255126037};
+
+static constexpr double kSym3[] = {
+    0.33267055295008263, 0.8068915093110925, 0.45987750211849154,
+    -0.13501102001025458, -0.08544127388202666, 0.03522629188570953};
+
+static constexpr double kSym4[] = {
+    0.032223100604051466, -0.012603967262031304, -0.09921954357663353,
+    0.29785779560530606, 0.8037387518051321, 0.497618667632775,
+    -0.029635527646002493, -0.07576571478950221};
+
+static constexpr double kSym5[] = {
+    0.019538882735249827, -0.021101834024689042, -0.17532808990805623,
+    0.01660210576451085, 0.633978963456792, 0.7234076904040407,
+    0.19939753397685558, -0.039134249302313844, 0.02951949092570626,
+    0.027333068344998768};
+
+static constexpr double kSym6[] = {
+    -0.00780070832503238, 0.0017677118642540077, 0.04472490177078139,
+    -0.02106029251237085, -0.07263752278637658, 0.3379294217281658,
+    0.787641141028651, 0.49105594192797375, -0.04831174258569806,
+    -0.11799011114852002, 0.0034907120842221626, 0.015404109327044824};
+
+static constexpr double kSym7[] = {
+    0.002681814568260147, -0.001047384888679738, -0.012636303403240567,
+    0.030515513165877885, 0.06789269350122057, -0.04955283493704283,
+    0.017441255086835708, 0.5361019170905692, 0.7677643170048829,
+    0.2886296317506479, -0.14004724044293365, -0.10780823770328972,
+    0.0040102448715223955, 0.010268176708464817};
+
+static constexpr double kSym8[] = {
+    0.001889950332767689, -0.0003029205147241331, -0.014952258337062199,
+    0.0038087520138944896, 0.04913717967373029, -0.027219029917103486,
+    -0.0519458381078818, 0.36444189483617895, 0.777185751699628,
+    0.4813596512590534, -0.061273359067811076, -0.14329423835127267,
+    0.007607487324976609, 0.03169508781152599, -0.0005421323318000107,
+    -0.0033824159510050028};
+
+static constexpr double kSym9[] = {
+    0.001069490032908612, -0.00047315449868004354, -0.010264064027633121,
+    0.008859267493400267, 0.062077789302885746, -0.018233770779395506,
+    -0.19155083129728434, 0.03527248803527104, 0.6173384491409342,
+    0.7178970827644124, 0.23876091460730517, -0.05456895843083335,
+    0.0005834627461249819, 0.030224878858275187, -0.011528210207679187,
+    -0.013271967781817134, 0.0006197808889855071, 0.0014009155259146562};
+
+static constexpr double kSym10[] = {
+    -0.00045932942100465206, 5.703608361849501e-05, 0.004593173585311792,
+    -0.0008043589320164513, -0.02035493981231111, 0.00576491203358115,
+    0.049994972077375154, -0.03199005688242811, -0.035536740473819585,
+    0.3838267610670763, 0.7695100370210979, 0.4716906669384429,
+    -0.07088053578323157, -0.1594942788849106, 0.011609893903711319,
+    0.04592723923109151, -0.0014653825813046104, -0.00864129927702215,
+    9.563267072285273e-05, 0.0007701598091144599};
+
+//-------------------------------------------------------------
+// Coiflets, scaling filters (Lo_R)
+
+static constexpr double kCoif1[] = {
+    -0.07273261951252645, 0.33789766245748176, 0.8525720202116004,
+    0.3848648468648577, -0.07273261951252645, -0.015655728135791993};
+
+static constexpr double kCoif2[] = {
+    0.01638733646320364, -0.04146493678687178, -0.0673725547237256,
+    0.38611006682276283, 0.8127236354494135, 0.41700518442323903,
+    -0.07648859907828076, -0.059434418646431085, 0.02368017194684777,
+    0.005611434819368834, -0.001823208870911032, -0.000720549445520347};
+
+static constexpr double kCoif3[] = {
+    -0.0037935128643808015, 0.0077825964256727454, 0.023452696142077165,
+    -0.06577191128146936, -0.06112339000297254, 0.4051769024091182,
+    0.7937772226260872, 0.42848347637737, -0.07179982161915484,
+    -0.08230192710629981, 0.03455502757329773, 0.015880544863669452,
+    -0.009007976136730624, -0.002574517688136797, 0.0011175187708306303,
+    0.0004662169598204029, -7.0983302506379e-05, -3.4599773197272774e-05};
+
+static constexpr double kCoif4[] = {
+    0.000892313902537003, -0.0016294924252267858, -0.00734616793626805,
+    0.016068947131575025, 0.026682304669604834, -0.08126671024919373,
+    -0.05607731960356926, 0.41530842700068227, 0.7822389344242826,
+    0.43438603311435653, -0.06662747236681715, -0.09622042453595264,
+    0.03933442260558915, 0.025082253337949608, -0.015211728187697211,
+    -0.0056582838001308835, 0.003751434697146086, 0.0012665610789256603,
+    -0.0005890202246332164, -0.0002599743371222568, 6.233885431278718e-05,
+    3.1229861599195265e-05, -3.2596479400307506e-06, -1.7849909144933466e-06};
+
+static constexpr double kCoif5[] = {
+    -0.000212081862067494, 0.0003585777411617577, 0.0021782943778456947,
+    -0.004159312627578639, -0.010131584846900275, 0.023408322118927783,
+    0.028169744270532353, -0.09192158806008609, -0.05204667025355476,
+    0.42157126673075435, 0.7742936228603274, 0.4379823066591633,
+    -0.06203775157498195, -0.10556315130733723, 0.041287530472117834,
+    0.03267479946705735, -0.019758391600965465, -0.009159507338676163,
+    0.006761520220620417, 0.0024315754425382886, -0.0016616273039298788,
+    -0.0006375589261258812, 0.00030185794166824473, 0.00014035632812373243,
+    -4.12198619242655e-05, -2.1270221672515614e-05, 3.7007277113394796e-06,
+    2.0612203985788783e-06, -1.6237995172048335e-07, -9.604010112767892e-08};
+
+//-------------------------------------------------------------
+// Biorthogonal splines and CDF, decomposition and reconstruction low pass
+// filters (Lo_D, Lo_R), zero padded to a common even length
+
+static constexpr double kBior11Lo_D[] = {
+    0.7071067811865476, 0.7071067811865476};
+static constexpr double kBior11Lo_R[] = {
+    0.7071067811865476, 0.7071067811865476};
+
+static constexpr double kBior13Lo_D[] = {
+    -0.08838834764831845, 0.08838834764831845, 0.7071067811865476,
+    0.7071067811865476, 0.08838834764831845, -0.08838834764831845};
+static constexpr double kBior13Lo_R[] = {
+    0.0, 0.0, 0.7071067811865476, 0.7071067811865476, 0.0, 0.0};
+
+static constexpr double kBior15Lo_D[] = {
+    0.016572815184059706, -0.016572815184059706, -0.12153397801643785,
+    0.12153397801643785, 0.7071067811865476, 0.7071067811865476,
+    0.12153397801643785, -0.12153397801643785, -0.016572815184059706,
+    0.016572815184059706};
+static constexpr double kBior15Lo_R[] = {
+    0.0, 0.0, 0.0, 0.0, 0.7071067811865476, 0.7071067811865476, 0.0, 0.0, 0.0,
+    0.0};
+
+static constexpr double kBior22Lo_D[] = {
+    0.0, -0.1767766952966369, 0.3535533905932738, 1.0606601717798212,
+    0.3535533905932738, -0.1767766952966369};
+static constexpr double kBior22Lo_R[] = {
+    0.0, 0.3535533905932738, 0.7071067811865476, 0.3535533905932738, 0.0, 0.0};
+
+static constexpr double kBior24Lo_D[] = {
+    0.0, 0.03314563036811941, -0.06629126073623882, -0.1767766952966369,
+    0.4198446513295126, 0.9943689110435825, 0.4198446513295126,
+    -0.1767766952966369, -0.06629126073623882, 0.03314563036811941};
+static constexpr double kBior24Lo_R[] = {
+    0.0, 0.0, 0.0, 0.3535533905932738, 0.7071067811865476, 0.3535533905932738,
+    0.0, 0.0, 0.0, 0.0};
+
+static constexpr double kBior26Lo_D[] = {
+    0.0, -0.006905339660024878, 0.013810679320049757, 0.04695630968816917,
+    -0.1077232986963881, -0.16987135563661201, 0.4474660099696121,
+    0.966747552403483, 0.4474660099696121, -0.16987135563661201,
+    -0.1077232986963881, 0.04695630968816917, 0.013810679320049757,
+    -0.006905339660024878};
+static constexpr double kBior26Lo_R[] = {
+    0.0, 0.0, 0.0, 0.0, 0.0, 0.3535533905932738, 0.7071067811865476,
+    0.3535533905932738, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+static constexpr double kBior28Lo_D[] = {
+    0.0, 0.0015105430506304422, -0.0030210861012608843, -0.012947511862546647,
+    0.02891610982635418, 0.05299848189069094, -0.13491307360773605,
+    -0.16382918343409023, 0.46257144047591653, 0.9516421218971786,
+    0.46257144047591653, -0.16382918343409023, -0.13491307360773605,
+    0.05299848189069094, 0.02891610982635418, -0.012947511862546647,
+    -0.0030210861012608843, 0.0015105430506304422};
+static constexpr double kBior28Lo_R[] = {
+    0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.3535533905932738, 0.7071067811865476,
+    0.3535533905932738, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+static constexpr double kBior31Lo_D[] = {
+    -0.3535533905932738, 1.0606601717798212, 1.0606601717798212,
+    -0.3535533905932738};
+static constexpr double kBior31Lo_R[] = {
+    0.1767766952966369, 0.5303300858899106, 0.5303300858899106,
+    0.1767766952966369};
+
+static constexpr double kBior33Lo_D[] = {
+    0.06629126073623882, -0.1988737822087165, -0.15467960838455727,
+    0.9943689110435825, 0.9943689110435825, -0.15467960838455727,
+    -0.1988737822087165, 0.06629126073623882};
+static constexpr double kBior33Lo_R[] = {
+    0.0, 0.0, 0.1767766952966369, 0.5303300858899106, 0.5303300858899106,
+    0.1767766952966369, 0.0, 0.0};
+
+static constexpr double kBior35Lo_D[] = {
+    -0.013810679320049757, 0.04143203796014927, 0.052480581416189075,
+    -0.26792717880896527, -0.07181553246425873, 0.966747552403483,
+    0.966747552403483, -0.07181553246425873, -0.26792717880896527,
+    0.052480581416189075, 0.04143203796014927, -0.013810679320049757};
+static constexpr double kBior35Lo_R[] = {
+    0.0, 0.0, 0.0, 0.0, 0.1767766952966369, 0.5303300858899106,
+    0.5303300858899106, 0.1767766952966369, 0.0, 0.0, 0.0, 0.0};
+
+static constexpr double kBior37Lo_D[] = {
+    0.0030210861012608843, -0.009063258303782653, -0.01683176542131064,
+    0.074663985074019, 0.03133297870736289, -0.301159125922835,
+    -0.02649924094534547, 0.9516421218971786, 0.9516421218971786,
+    -0.02649924094534547, -0.301159125922835, 0.03133297870736289,
+    0.074663985074019, -0.01683176542131064, -0.009063258303782653,
+    0.0030210861012608843};
+static constexpr double kBior37Lo_R[] = {
+    0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.1767766952966369, 0.5303300858899106,
+    0.5303300858899106, 0.1767766952966369, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+static constexpr double kBior39Lo_D[] = {
+    -0.0006797443727836989, 0.002039233118351097, 0.005060319219611981,
+    -0.020618912641105536, -0.014112787930175844, 0.09913478249423216,
+    0.012300136269419315, -0.32019196836077857, 0.0020500227115698858,
+    0.9421257006782068, 0.9421257006782068, 0.0020500227115698858,
+    -0.32019196836077857, 0.012300136269419315, 0.09913478249423216,
+    -0.014112787930175844, -0.020618912641105536, 0.005060319219611981,
+    0.002039233118351097, -0.0006797443727836989};
+static constexpr double kBior39Lo_R[] = {
+    0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.1767766952966369,
+    0.5303300858899106, 0.5303300858899106, 0.1767766952966369, 0.0, 0.0, 0.0,
+    0.0, 0.0, 0.0, 0.0, 0.0};
+
+static constexpr double kBior44Lo_D[] = {
+    0.0, 0.03782845550699546, -0.02384946501938, -0.1106244044184234,
+    0.37740285561265374, 0.8526986790094034, 0.37740285561265374,
+    -0.1106244044184234, -0.02384946501938, 0.03782845550699546};
+static constexpr double kBior44Lo_R[] = {
+    0.0, -0.06453888262893843, -0.04068941760955844, 0.4180922732222122,
+    0.7884856164056644, 0.4180922732222122, -0.04068941760955844,
+    -0.06453888262893843, 0.0, 0.0};
+
+static constexpr double kBior68Lo_D[] = {
+    0.0, 0.0019088317364850261, -0.0019142861290808862, -0.0169906398676071,
+    0.01193456527972673, 0.049732903490937654, -0.07726317316721135,
+    -0.09405920349576163, 0.42079628460983926, 0.8259229974584397,
+    0.42079628460983926, -0.09405920349576163, -0.07726317316721135,
+    0.049732903490937654, 0.01193456527972673, -0.0169906398676071,
+    -0.0019142861290808862, 0.0019088317364850261};
+static constexpr double kBior68Lo_R[] = {
+    0.0, 0.0, 0.0, 0.014426282505622248, 0.014467504896774099,
+    -0.07872200106266872, -0.040367979030381904, 0.41784910915032025,
+    0.7589077294537632, 0.41784910915032025, -0.040367979030381904,
+    -0.07872200106266872, 0.014467504896774099, 0.014426282505622248, 0.0, 0.0,
+    0.0, 0.0};
+
+//-------------------------------------------------------------
+static constexpr auto kBior11Bank = biorthogonal_bank(kBior11Lo_D, kBior11Lo_R);
+static constexpr auto kBior11ReverseBank = reverse_bank(kBior11Bank);
+static constexpr auto kBior13Bank = biorthogonal_bank(kBior13Lo_D, kBior13Lo_R);
+static constexpr auto kBior13ReverseBank = reverse_bank(kBior13Bank);
+static constexpr auto kBior15Bank = biorthogonal_bank(kBior15Lo_D, kBior15Lo_R);
+static constexpr auto kBior15ReverseBank = reverse_bank(kBior15Bank);
+static constexpr auto kBior22Bank = biorthogonal_bank(kBior22Lo_D, kBior22Lo_R);
+static constexpr auto kBior22ReverseBank = reverse_bank(kBior22Bank);
+static constexpr auto kBior24Bank = biorthogonal_bank(kBior24Lo_D, kBior24Lo_R);
+static constexpr auto kBior24ReverseBank = reverse_bank(kBior24Bank);
+static constexpr auto kBior26Bank = biorthogonal_bank(kBior26Lo_D, kBior26Lo_R);
+static constexpr auto kBior26ReverseBank = reverse_bank(kBior26Bank);
+static constexpr auto kBior28Bank = biorthogonal_bank(kBior28Lo_D, kBior28Lo_R);
+static constexpr auto kBior28ReverseBank = reverse_bank(kBior28Bank);
+static constexpr auto kBior31Bank = biorthogonal_bank(kBior31Lo_D, kBior31Lo_R);
+static constexpr auto kBior31ReverseBank = reverse_bank(kBior31Bank);
+static constexpr auto kBior33Bank = biorthogonal_bank(kBior33Lo_D, kBior33Lo_R);
+static constexpr auto kBior33ReverseBank = reverse_bank(kBior33Bank);
+static constexpr auto kBior35Bank = biorthogonal_bank(kBior35Lo_D, kBior35Lo_R);
+static constexpr auto kBior35ReverseBank = reverse_bank(kBior35Bank);
+static constexpr auto kBior37Bank = biorthogonal_bank(kBior37Lo_D, kBior37Lo_R);
+static constexpr auto kBior37ReverseBank = reverse_bank(kBior37Bank);
+static constexpr auto kBior39Bank = biorthogonal_bank(kBior39Lo_D, kBior39Lo_R);
+static constexpr auto kBior39ReverseBank = reverse_bank(kBior39Bank);
+static constexpr auto kBior44Bank = biorthogonal_bank(kBior44Lo_D, kBior44Lo_R);
+static constexpr auto kBior44ReverseBank = reverse_bank(kBior44Bank);
+static constexpr auto kBior68Bank = biorthogonal_bank(kBior68Lo_D, kBior68Lo_R);
+static constexpr auto kBior68ReverseBank = reverse_bank(kBior68Bank);
+static constexpr auto kCoif1Bank = orthogonal_bank(kCoif1);
+static constexpr auto kCoif2Bank = orthogonal_bank(kCoif2);
+static constexpr auto kCoif3Bank = orthogonal_bank(kCoif3);
+static constexpr auto kCoif4Bank = orthogonal_bank(kCoif4);
+static constexpr auto kCoif5Bank = orthogonal_bank(kCoif5);
+static constexpr auto kDb1Bank = orthogonal_bank(kDb1);
+static constexpr auto kDb2Bank = orthogonal_bank(kDb2);
+static constexpr auto kDb3Bank = orthogonal_bank(kDb3);
+static constexpr auto kDb4Bank = orthogonal_bank(kDb4);
+static constexpr auto kDb5Bank = orthogonal_bank(kDb5);
+static constexpr auto kDb6Bank = orthogonal_bank(kDb6);
+static constexpr auto kDb7Bank = orthogonal_bank(kDb7);
+static constexpr auto kDb8Bank = orthogonal_bank(kDb8);
+static constexpr auto kDb9Bank = orthogonal_bank(kDb9);
+static constexpr auto kDb10Bank = orthogonal_bank(kDb10);
+static constexpr auto kDb11Bank = orthogonal_bank(kDb11);
+static constexpr auto kDb12Bank = orthogonal_bank(kDb12);
+static constexpr auto kDb13Bank = orthogonal_bank(kDb13);
+static constexpr auto kDb14Bank = orthogonal_bank(kDb14);
+static constexpr auto kDb15Bank = orthogonal_bank(kDb15);
+static constexpr auto kDb16Bank = orthogonal_bank(kDb16);
+static constexpr auto kDb17Bank = orthogonal_bank(kDb17);
+static constexpr auto kDb18Bank = orthogonal_bank(kDb18);
+static constexpr auto kDb19Bank = orthogonal_bank(kDb19);
+static constexpr auto kDb20Bank = orthogonal_bank(kDb20);
+static constexpr auto kSym2Bank = orthogonal_bank(kSym2);
+static constexpr auto kSym3Bank = orthogonal_bank(kSym3);
+static constexpr auto kSym4Bank = orthogonal_bank(kSym4);
+static constexpr auto kSym5Bank = orthogonal_bank(kSym5);
+static constexpr auto kSym6Bank = orthogonal_bank(kSym6);
+static constexpr auto kSym7Bank = orthogonal_bank(kSym7);
+static constexpr auto kSym8Bank = orthogonal_bank(kSym8);
+static constexpr auto kSym9Bank = orthogonal_bank(kSym9);
+static constexpr auto kSym10Bank = orthogonal_bank(kSym10);
+
+//-------------------------------------------------------------
+// sorted by name for the lookup in wavelet()
+static constexpr Wavelet kWavelets[] = {
+    wavelet_entry("bior1.1", 0, WaveletFamily::Biorthogonal, false,
+                  kBior11Bank),
+    wavelet_entry("bior1.3", 1, WaveletFamily::Biorthogonal, false,
+                  kBior13Bank),
+    wavelet_entry("bior1.5", 2, WaveletFamily::Biorthogonal, false,
+                  kBior15Bank),
+    wavelet_entry("bior2.2", 3, WaveletFamily::Biorthogonal, false,
+                  kBior22Bank),
+    wavelet_entry("bior2.4", 4, WaveletFamily::Biorthogonal, false,
+                  kBior24Bank),
+    wavelet_entry("bior2.6", 5, WaveletFamily::Biorthogonal, false,
+                  kBior26Bank),
+    wavelet_entry("bior2.8", 6, WaveletFamily::Biorthogonal, false,
+                  kBior28Bank),
+    wavelet_entry("bior3.1", 7, WaveletFamily::Biorthogonal, false,
+                  kBior31Bank),
+    wavelet_entry("bior3.3", 8, WaveletFamily::Biorthogonal, false,
+                  kBior33Bank),
+    wavelet_entry("bior3.5", 9, WaveletFamily::Biorthogonal, false,
+                  kBior35Bank),
+    wavelet_entry("bior3.7", 10, WaveletFamily::Biorthogonal, false,
+                  kBior37Bank),
+    wavelet_entry("bior3.9", 11, WaveletFamily::Biorthogonal, false,
+                  kBior39Bank),
+    wavelet_entry("bior4.4", 12, WaveletFamily::Biorthogonal, false,
+                  kBior44Bank),
+    wavelet_entry("bior6.8", 13, WaveletFamily::Biorthogonal, false,
+                  kBior68Bank),
+    wavelet_entry("coif1", 14, WaveletFamily::Coiflets, true, kCoif1Bank),
+    wavelet_entry("coif2", 15, WaveletFamily::Coiflets, true, kCoif2Bank),
+    wavelet_entry("coif3", 16, WaveletFamily::Coiflets, true, kCoif3Bank),
+    wavelet_entry("coif4", 17, WaveletFamily::Coiflets, true, kCoif4Bank),
+    wavelet_entry("coif5", 18, WaveletFamily::Coiflets, true, kCoif5Bank),
+    wavelet_entry("db1", 19, WaveletFamily::Daubechies, true, kDb1Bank),
+    wavelet_entry("db10", 20, WaveletFamily::Daubechies, true, kDb10Bank),
+    wavelet_entry("db11", 21, WaveletFamily::Daubechies, true, kDb11Bank),
+    wavelet_entry("db12", 22, WaveletFamily::Daubechies, true, kDb12Bank),
+    wavelet_entry("db13", 23, WaveletFamily::Daubechies, true, kDb13Bank),
+    wavelet_entry("db14", 24, WaveletFamily::Daubechies, true, kDb14Bank),
+    wavelet_entry("db15", 25, WaveletFamily::Daubechies, true, kDb15Bank),
+    wavelet_entry("db16", 26, WaveletFamily::Daubechies, true, kDb16Bank),
+    wavelet_entry("db17", 27, WaveletFamily::Daubechies, true, kDb17Bank),
+    wavelet_entry("db18", 28, WaveletFamily::Daubechies, true, kDb18Bank),
+    wavelet_entry("db19", 29, WaveletFamily::Daubechies, true, kDb19Bank),
+    wavelet_entry("db2", 30, WaveletFamily::Daubechies, true, kDb2Bank),
+    wavelet_entry("db20", 31, WaveletFamily::Daubechies, true, kDb20Bank),
+    wavelet_entry("db3", 32, WaveletFamily::Daubechies, true, kDb3Bank),
+    wavelet_entry("db4", 33, WaveletFamily::Daubechies, true, kDb4Bank),
+    wavelet_entry("db5", 34, WaveletFamily::Daubechies, true, kDb5Bank),
+    wavelet_entry("db6", 35, WaveletFamily::Daubechies, true, kDb6Bank),
+    wavelet_entry("db7", 36, WaveletFamily::Daubechies, true, kDb7Bank),
+    wavelet_entry("db8", 37, WaveletFamily::Daubechies, true, kDb8Bank),
+    wavelet_entry("db9", 38, WaveletFamily::Daubechies, true, kDb9Bank),
+    wavelet_entry("haar", 39, WaveletFamily::Haar, true, kDb1Bank),
+    wavelet_entry("rbio1.1", 40, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior11ReverseBank),
+    wavelet_entry("rbio1.3", 41, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior13ReverseBank),
+    wavelet_entry("rbio1.5", 42, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior15ReverseBank),
+    wavelet_entry("rbio2.2", 43, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior22ReverseBank),
+    wavelet_entry("rbio2.4", 44, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior24ReverseBank),
+    wavelet_entry("rbio2.6", 45, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior26ReverseBank),
+    wavelet_entry("rbio2.8", 46, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior28ReverseBank),
+    wavelet_entry("rbio3.1", 47, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior31ReverseBank),
+    wavelet_entry("rbio3.3", 48, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior33ReverseBank),
+    wavelet_entry("rbio3.5", 49, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior35ReverseBank),
+    wavelet_entry("rbio3.7", 50, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior37ReverseBank),
+    wavelet_entry("rbio3.9", 51, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior39ReverseBank),
+    wavelet_entry("rbio4.4", 52, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior44ReverseBank),
+    wavelet_entry("rbio6.8", 53, WaveletFamily::ReverseBiorthogonal, false,
+                  kBior68ReverseBank),
+    wavelet_entry("sym10", 54, WaveletFamily::Symlets, true, kSym10Bank),
+    wavelet_entry("sym2", 55, WaveletFamily::Symlets, true, kSym2Bank),
+    wavelet_entry("sym3", 56, WaveletFamily::Symlets, true, kSym3Bank),
+    wavelet_entry("sym4", 57, WaveletFamily::Symlets, true, kSym4Bank),
+    wavelet_entry("sym5", 58, WaveletFamily::Symlets, true, kSym5Bank),
+    wavelet_entry("sym6", 59, WaveletFamily::Symlets, true, kSym6Bank),
+    wavelet_entry("sym7", 60, WaveletFamily::Symlets, true, kSym7Bank),
+    wavelet_entry("sym8", 61, WaveletFamily::Symlets, true, kSym8Bank),
+    wavelet_entry("sym9", 62, WaveletFamily::Symlets, true, kSym9Bank),
+};
+
+/**
+ * Looks up a wavelet of the registry by name.
+ *
+ * @param name The wavelet name, e.g. "haar", "db5", "sym8", "coif3",
+ * "bior4.4" or "rbio2.2".
+ * @return The wavelet, valid for the lifetime of the program.
+ */
+const Wavelet &wavelet(const std::string &name) {
+  const Wavelet *found =
+      std::lower_bound(std::begin(kWavelets), std::end(kWavelets), name,
+                       [](const Wavelet &entry, const std::string &key) {
+                         return std::strcmp(entry.name, key.c_str()) < 0;
+                       });
+  if (found == std::end(kWavelets) || name != found->name) {
+    throw std::runtime_error("Unknown wavelet name!");
+  }
+  return *found;
+}
+
+//-------------------------------------------------------------
+/**
+ * The number of wavelets in the registry.
+ *
+ * @return The number of wavelets.
+ */
+size_t wavelet_count() { return std::size(kWavelets); }
+
+//-------------------------------------------------------------
+/**
+ * Accesses a wavelet of the registry by its id.
+ *
+ * @param id The wavelet id, less than wavelet_count().
+ * @return The wavelet with that id.
+ */
+const Wavelet &wavelet_at(size_t id) {
+  if (id >= std::size(kWavelets)) {
+    throw std::runtime_error("Wavelet id out of range!");
+  }
+  return kWavelets[id];
+}
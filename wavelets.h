@@ -0,0 +1,46 @@
+#ifndef wavelets_h
+#define wavelets_h
+
+#include <cstddef>
+#include <string>
+
+enum class WaveletFamily {
+  Haar,
+  Daubechies,
+  Symlets,
+  Coiflets,
+  Biorthogonal,
+  ReverseBiorthogonal
+};
+
+// A wavelet of the static registry in wavelets.cpp: "haar", "db1" to "db20",
+// "sym2" to "sym10", "coif1" to "coif5", and "biorX.Y" / "rbioX.Y" for
+// X.Y = 1.1, 1.3, 1.5, 2.2, 2.4, 2.6, 2.8, 3.1, 3.3, 3.5, 3.7, 3.9, 4.4, 6.8.
+// The four filters have filterSize taps and are 64 byte aligned. Entries live
+// for the whole program, so a reference is a handle that can be resolved once
+// and passed instead of the name.
+struct Wavelet {
+  const char *name;
+  // position in the registry, 0 .. wavelet_count() - 1
+  size_t id;
+  WaveletFamily family;
+  bool orthogonal;
+  size_t filterSize;
+  const double *Lo_D;
+  const double *Ho_D;
+  const double *Lo_R;
+  const double *Ho_R;
+  // the same filters rounded to float, for float transforms
+  const float *Lo_D_f32;
+  const float *Ho_D_f32;
+  const float *Lo_R_f32;
+  const float *Ho_R_f32;
+};
+
+const Wavelet &wavelet(const std::string &name);
+
+size_t wavelet_count();
+
+const Wavelet &wavelet_at(size_t id);
+
+#endif /* wavelets_h */